@@ -13,6 +13,7 @@
           pkg-config
           glfw
           glew
+          libGL
           glslang
           freetype
         ];
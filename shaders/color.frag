@@ -1,7 +1,8 @@
 #version 330 core
 
 in vec4 out_color;
+flat in vec4 out_tint;
 
 void main() {
-    gl_FragColor = out_color;
+    gl_FragColor = out_color * out_tint;
 }
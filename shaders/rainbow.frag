@@ -5,19 +5,20 @@
 uniform vec2 resolution;
 uniform float time;
 
+//this is the number of cells (has to match RAINBOW_CELLS_COUNT in src/renderer.h)
+#define CELLS_COUNT 100
 
-#define PI 3.1415926535897932384626433832795
+//positions of the cells, they only depend on time so they are computed once per frame on the CPU
+uniform vec2 cells[CELLS_COUNT];
 
-//this is a basic Pseudo Random Number Generator
-float hash(in float n)
-{
-    return fract(sin(n)*43758.5453123);
-}
+flat in vec4 out_tint;
+// x: zoom out factor of the cells, 0 keeps the original size
+flat in vec4 out_params;
 
 void main() {
 
     //"squarified" coordinates
-    vec2 xy = ( 2.* gl_FragCoord.xy - resolution.xy ) / resolution.y ;
+    vec2 xy = ( 2.* gl_FragCoord.xy - resolution.xy ) / resolution.y * ( 1. + out_params.x );
 
     //rotating light
     vec3 center = vec3( sin( time ), 1., cos( time * .5 ) );
@@ -25,48 +26,38 @@ void main() {
     //temporary vector
     vec3 pp = vec3(0.);
 
-    //maximum distance of the surface to the center (try a value of 0.1 for example)
-    float length = 4.;
+    //index of the closest cell so far, starting with the first one so every fragment gets
+    //its nearest cell however far away it is
+    int closest = 0;
 
-    //this is the number of cells
-    const float count = 100.;
+    //squared distance to the closest cell so far
+    vec2 d0 = xy - cells[ 0 ];
+    float length = dot( d0, d0 );
 
-    for( float i = 0.; i < count; i+=1. )
+    for( int i = 1; i < CELLS_COUNT; ++i )
     {
-        //random cell: create a point around the center
-
-        //gets a 'random' angle around the center
-        float an = sin( time * PI * .00001 ) - hash( i ) * PI * 2.;
-
-        //gets a 'random' radius ( the 'spacing' between cells )
-        float ra = sqrt( hash( an ) ) * .5;
-
-        //creates a temporary 2d vector
-    	vec2 p = vec2( center.x + cos( an ) * ra, center.z + sin( an ) * ra );
-
         //finds the closest cell from the fragment's XY coords
+        vec2 d = xy - cells[ i ];
+        float di = dot( d, d );
 
-        //compute the distance from this cell to the fragment's coordinates
-        float di = distance( xy, p );
-
-        //and check if this length is inferior to the minimum length
-        length = min( length, di );
-
-        //if this cell was the closest
-        if( length == di )
+        //if this cell is the closest
+        if( di < length )
         {
-            //stores the XY values of the cell and compute a 'Z' according to them
-            pp.xy = p;
-            pp.z = i / count * xy.x * xy.y;
+            length = di;
+            closest = i;
         }
     }
 
+    //stores the XY values of the cell and compute a 'Z' according to them
+    pp.xy = cells[ closest ];
+    pp.z = float( closest ) / float( CELLS_COUNT ) * xy.x * xy.y;
+
     //shimmy shake:
     //uses the temp vector's coordinates and uses the angle and the temp vector
     //to create light & shadow (quick & dirty)
     vec3 shade = vec3( 1. ) * ( 1. - max( 0.0, dot( pp, center ) ) );
 
     //final color
-    gl_FragColor = vec4( pp + shade, 1. );
+    gl_FragColor = vec4( pp + shade, 1. ) * out_tint;
 
 }
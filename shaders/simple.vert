@@ -3,12 +3,28 @@
 uniform vec2 resolution;
 uniform float time;
 
-layout (location = 0) in vec2 position;
-layout (location = 1) in vec4 color;
-layout (location = 2) in vec2 uv;
+// Locations are bound from the vertex_attrib_defs table in src/renderer.c
+in vec2 position;
+in vec4 color;
+in vec2 uv;
+in uint mode;
+in uint material;
+
+// Has to match Material and MATERIALS_CAP in src/renderer.h
+struct Material {
+    vec4 tint;
+    vec4 params;
+};
+
+layout (std140) uniform Materials {
+    Material materials[256];
+};
 
 out vec4 out_color;
 out vec2 out_uv;
+flat out uint out_mode;
+flat out vec4 out_tint;
+flat out vec4 out_params;
 
 vec2 convert_screen_2_ndc(vec2 p) {
     float x = (2 * p.x / resolution.x) - 1;
@@ -20,4 +36,7 @@ void main() {
     gl_Position = vec4(convert_screen_2_ndc(position), 0.0, 1.0);
     out_color = color;
     out_uv = uv;
+    out_mode = mode;
+    out_tint = materials[material].tint;
+    out_params = materials[material].params;
 }
@@ -4,10 +4,15 @@ uniform sampler2D image;
 
 in vec4 out_color;
 in vec2 out_uv;
+flat in vec4 out_tint;
+// x: offset of the glyph edge, negative values make the text bolder
+// y: additional softness of the edge in multiples of the anti aliasing width
+flat in vec4 out_params;
 
 void main() {
     float d = texture(image, out_uv).r;
-    float aaf = fwidth(d);
-    float alpha = smoothstep(0.5 - aaf, 0.5 + aaf, d);
-    gl_FragColor = vec4(out_color.rgb, alpha);
+    float aaf = fwidth(d) * (1.0 + out_params.y);
+    float edge = 0.5 + out_params.x;
+    float alpha = smoothstep(edge - aaf, edge + aaf, d);
+    gl_FragColor = vec4(out_color.rgb, alpha) * out_tint;
 }
@@ -0,0 +1,65 @@
+#version 330 core
+
+// Combination of color.frag, text.frag and rainbow.frag.
+// The mode values have to match the Shader enum in src/renderer.h
+#define MODE_COLOR   0u
+#define MODE_TEXT    1u
+#define MODE_RAINBOW 2u
+
+uniform vec2 resolution;
+uniform float time;
+uniform sampler2D image;
+
+#define CELLS_COUNT 100
+uniform vec2 cells[CELLS_COUNT];
+
+in vec4 out_color;
+in vec2 out_uv;
+flat in uint out_mode;
+flat in vec4 out_tint;
+flat in vec4 out_params;
+
+vec4 text() {
+    float d = texture(image, out_uv).r;
+    float aaf = fwidth(d) * (1.0 + out_params.y);
+    float edge = 0.5 + out_params.x;
+    float alpha = smoothstep(edge - aaf, edge + aaf, d);
+    return vec4(out_color.rgb, alpha);
+}
+
+// See rainbow.frag for the commented version
+vec4 rainbow() {
+    vec2 xy = ( 2.* gl_FragCoord.xy - resolution.xy ) / resolution.y * ( 1. + out_params.x );
+    vec3 center = vec3( sin( time ), 1., cos( time * .5 ) );
+    vec3 pp = vec3(0.);
+    int closest = 0;
+    vec2 d0 = xy - cells[ 0 ];
+    float length = dot( d0, d0 );
+    for( int i = 1; i < CELLS_COUNT; ++i )
+    {
+        vec2 d = xy - cells[ i ];
+        float di = dot( d, d );
+        if( di < length )
+        {
+            length = di;
+            closest = i;
+        }
+    }
+    pp.xy = cells[ closest ];
+    pp.z = float( closest ) / float( CELLS_COUNT ) * xy.x * xy.y;
+    vec3 shade = vec3( 1. ) * ( 1. - max( 0.0, dot( pp, center ) ) );
+    return vec4( pp + shade, 1. );
+}
+
+void main() {
+    // fwidth() has to be evaluated in uniform control flow, so the text path is not
+    // hidden behind the branch
+    vec4 text_color = text();
+    if (out_mode == MODE_TEXT) {
+        gl_FragColor = text_color * out_tint;
+    } else if (out_mode == MODE_RAINBOW) {
+        gl_FragColor = rainbow() * out_tint;
+    } else {
+        gl_FragColor = out_color * out_tint;
+    }
+}
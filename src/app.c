@@ -0,0 +1,118 @@
+#include <stdio.h>
+
+#include "common.h"
+#include "app.h"
+#include "profiler.h"
+
+bool app_load_face(const char *font_file_path, FT_UInt pixel_size, FT_Face *face)
+{
+    FT_Library library = {0};
+
+    FT_Error error = FT_Init_FreeType(&library);
+    if (error) {
+        fprintf(stderr, "ERROR: Could not initialize FreeType2 library\n");
+        return false;
+    }
+
+    error = FT_New_Face(library, font_file_path, 0, face);
+    if (error == FT_Err_Unknown_File_Format) {
+        fprintf(stderr, "ERROR: %s has an unkown format\n", font_file_path);
+        return false;
+    } else if (error) {
+        fprintf(stderr, "ERROR: Could not load file %s\n", font_file_path);
+        return false;
+    }
+
+    error = FT_Set_Pixel_Sizes(*face, 0, pixel_size);
+    if (error) {
+        fprintf(stderr, "ERROR: Could not set pixel size to %u\n", pixel_size);
+        return false;
+    }
+
+    return true;
+}
+
+void app_init(App *app)
+{
+    app->size       = v2f(SCREEN_WIDTH, SCREEN_HEIGHT);
+    app->scale      = 1;
+    app->rect_pos   = v2f(SCREEN_WIDTH/2, SCREEN_HEIGHT/2);
+    app->rect_vel   = v2f(1, 1);
+    app->rect_size  = v2f(100, 100);
+    app->rect_speed = 1;
+    app->rect_prev_pos = app->rect_pos;
+}
+
+void app_resize(App *app, int width, int height, float scale)
+{
+    // A minimized window has no framebuffer, the scene keeps its last size
+    if (width <= 0 || height <= 0 || scale <= 0) return;
+    app->scale = scale;
+    app->size = v2f(width/scale, height/scale);
+    // Back inside after the window shrank, or the rect would flip its velocity every step.
+    // The previous position too, or the next frame interpolates from outside the window.
+    V2f half = v2f(app->rect_size.x/2, app->rect_size.y/2);
+    V2f max = v2f_max(half, v2f_sub(app->size, half));
+    app->rect_pos = v2f_clamp(app->rect_pos, half, max);
+    app->rect_prev_pos = v2f_clamp(app->rect_prev_pos, half, max);
+}
+
+void app_update(App *app)
+{
+    app->rect_prev_pos = app->rect_pos;
+    if (app->paused) return;
+    app->rect_pos = v2f_sum(app->rect_pos, v2f(app->rect_speed * app->rect_vel.x, app->rect_speed * app->rect_vel.y));
+    if (app->rect_pos.x + app->rect_size.x/2 >= app->size.x) app->rect_vel = v2f_mul(app->rect_vel, v2f(-1, 1));
+    if (app->rect_pos.y + app->rect_size.y/2 >= app->size.y) app->rect_vel = v2f_mul(app->rect_vel, v2f(1, -1));
+    if (app->rect_pos.x - app->rect_size.x/2 <= 0) app->rect_vel = v2f_mul(app->rect_vel, v2f(-1, 1));
+    if (app->rect_pos.y - app->rect_size.y/2 <= 0) app->rect_vel = v2f_mul(app->rect_vel, v2f(1, -1));
+}
+
+static uint64_t app_hash_bytes(uint64_t hash, const void *data, size_t size)
+{
+    const unsigned char *bytes = data;
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= bytes[i];
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
+
+#define APP_HASH_FIELD(hash, field) app_hash_bytes((hash), &(field), sizeof(field))
+
+uint64_t app_hash(const App *app)
+{
+    uint64_t hash = 0xcbf29ce484222325ull;
+    hash = APP_HASH_FIELD(hash, app->size.x);
+    hash = APP_HASH_FIELD(hash, app->size.y);
+    hash = APP_HASH_FIELD(hash, app->scale);
+    hash = APP_HASH_FIELD(hash, app->rect_prev_pos.x);
+    hash = APP_HASH_FIELD(hash, app->rect_prev_pos.y);
+    hash = APP_HASH_FIELD(hash, app->rect_pos.x);
+    hash = APP_HASH_FIELD(hash, app->rect_pos.y);
+    hash = APP_HASH_FIELD(hash, app->rect_vel.x);
+    hash = APP_HASH_FIELD(hash, app->rect_vel.y);
+    hash = APP_HASH_FIELD(hash, app->rect_size.x);
+    hash = APP_HASH_FIELD(hash, app->rect_size.y);
+    hash = APP_HASH_FIELD(hash, app->rect_speed);
+    uint8_t paused = app->paused;
+    hash = APP_HASH_FIELD(hash, paused);
+    return hash;
+}
+
+void app_render(App *app, Renderer *r, Free_Glyph_Atlas *atlas, float alpha)
+{
+    PROFILER_BEGIN(PROFILER_SCOPE_TEXT);
+    renderer_set_shader(r, SHADER_TEXT);
+    V2f text_pos = v2f_mul(v2f(0, app->size.y - FREE_GLYPH_FONT_SIZE), v2ff(app->scale));
+    // Until a rebuilt atlas arrives the one of the previous scale is stretched to the size
+    float text_scale = FREE_GLYPH_FONT_SIZE*app->scale/atlas->pixel_size;
+    free_glyph_atlas_render_line_scaled(atlas, r, APP_TITLE, APP_TITLE_LEN, &text_pos, v4f(1, 1, 1, 1), text_scale);
+    PROFILER_END(PROFILER_SCOPE_TEXT);
+
+    renderer_set_shader(r, SHADER_RAINBOW);
+    V2f pos = v2f_lerp(app->rect_prev_pos, app->rect_pos, v2ff(alpha));
+    renderer_rect_center(r, v2f_mul(pos, v2ff(app->scale)), v4f(0, 0, 0, 1), v2f_mul(app->rect_size, v2ff(app->scale)));
+
+    renderer_flush(r);
+}
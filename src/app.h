@@ -0,0 +1,36 @@
+#ifndef APP_H_
+#define APP_H_
+
+#include <stdint.h>
+
+#include "renderer.h"
+#include "glyph.h"
+
+#define APP_FONT_FILE_PATH "./assets/Poly-Regular.ttf"
+
+// State of the demo scene. Shared between the windowed and the headless entry points so
+// both render exactly the same frames. The scene is laid out in logical units, which
+// app_render multiplies by the content scale to get framebuffer pixels.
+typedef struct {
+    V2f size;    // Of the framebuffer in logical units, the walls the rect bounces off
+    float scale; // Framebuffer pixels per logical unit
+    V2f rect_prev_pos; // Before the last step, rendering interpolates from here
+    V2f rect_pos;
+    V2f rect_vel;
+    V2f rect_size;
+    float rect_speed; // Pixels per simulation step
+    bool paused;      // Steps keep the scene as it is, so nothing has to be redrawn
+} App;
+
+bool app_load_face(const char *font_file_path, FT_UInt pixel_size, FT_Face *face);
+void app_init(App *app);
+// Framebuffer size in pixels and the content scale of the window, before every frame
+void app_resize(App *app, int width, int height, float scale);
+// One fixed simulation step
+void app_update(App *app);
+// alpha from timestep_alpha() blends the state of the last two steps
+void app_render(App *app, Renderer *r, Free_Glyph_Atlas *atlas, float alpha);
+// FNV-1a over the fields one by one, so neither padding nor their order in App changes it
+uint64_t app_hash(const App *app);
+
+#endif  // APP_H_
@@ -0,0 +1,118 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "atlas_builder.h"
+#include "trace.h"
+
+static void *atlas_builder_main(void *arg)
+{
+    Atlas_Builder *b = arg;
+    pthread_mutex_lock(&b->mutex);
+    for (;;) {
+        // A finished atlas is only replaced once it was claimed
+        while (!b->quit && (b->requested == 0 || b->ready)) {
+            pthread_cond_wait(&b->cond, &b->mutex);
+        }
+        if (b->quit) break;
+        FT_UInt pixel_size = b->requested;
+        b->requested = 0;
+        b->building = pixel_size;
+        pthread_mutex_unlock(&b->mutex);
+
+        Free_Glyph_Atlas atlas = {0};
+        bool ok = FT_Set_Pixel_Sizes(b->face, 0, pixel_size) == 0;
+        if (ok) {
+            TRACE_BEGIN("atlas build");
+            free_glyph_atlas_build(&atlas, b->face);
+            TRACE_END("atlas build");
+        } else {
+            fprintf(stderr, "WARNING: Could not set pixel size to %u, keeping the current glyph atlas\n", pixel_size);
+        }
+
+        pthread_mutex_lock(&b->mutex);
+        b->building = 0;
+        if (ok) {
+            b->built = atlas;
+            b->ready = true;
+        }
+    }
+    pthread_mutex_unlock(&b->mutex);
+    return NULL;
+}
+
+bool atlas_builder_start(Atlas_Builder *b, FT_Face face)
+{
+    memset(b, 0, sizeof(*b));
+    b->face = face;
+    pthread_mutex_init(&b->mutex, NULL);
+    pthread_cond_init(&b->cond, NULL);
+    if (pthread_create(&b->thread, NULL, atlas_builder_main, b) != 0) {
+        fprintf(stderr, "ERROR: Could not start the glyph atlas builder thread\n");
+        pthread_cond_destroy(&b->cond);
+        pthread_mutex_destroy(&b->mutex);
+        return false;
+    }
+    b->started = true;
+    return true;
+}
+
+void atlas_builder_stop(Atlas_Builder *b)
+{
+    if (!b->started) return;
+    pthread_mutex_lock(&b->mutex);
+    b->quit = true;
+    pthread_cond_signal(&b->cond);
+    pthread_mutex_unlock(&b->mutex);
+    pthread_join(b->thread, NULL);
+
+    pthread_cond_destroy(&b->cond);
+    pthread_mutex_destroy(&b->mutex);
+    if (b->ready) free(b->built.pixels);
+    b->started = false;
+}
+
+void atlas_builder_request(Atlas_Builder *b, FT_UInt pixel_size, const Free_Glyph_Atlas *current)
+{
+    if (!b->started) return;
+    pthread_mutex_lock(&b->mutex);
+    // The newest of the pending request, the build in progress, the finished build and the
+    // atlas in use
+    FT_UInt latest = b->requested ? b->requested
+                   : b->building  ? b->building
+                   : b->ready     ? b->built.pixel_size
+                   : current->pixel_size;
+    if (pixel_size != latest) {
+        b->requested = pixel_size;
+        pthread_cond_signal(&b->cond);
+    }
+    pthread_mutex_unlock(&b->mutex);
+}
+
+bool atlas_builder_busy(Atlas_Builder *b)
+{
+    if (!b->started) return false;
+    pthread_mutex_lock(&b->mutex);
+    bool busy = b->requested || b->building || b->ready;
+    pthread_mutex_unlock(&b->mutex);
+    return busy;
+}
+
+bool atlas_builder_poll(Atlas_Builder *b, Free_Glyph_Atlas *atlas)
+{
+    if (!b->started) return false;
+    pthread_mutex_lock(&b->mutex);
+    bool ready = b->ready;
+    if (ready) {
+        GLuint texture = atlas->glyphs_texture;
+        free(atlas->pixels);
+        *atlas = b->built;
+        atlas->glyphs_texture = texture;
+        memset(&b->built, 0, sizeof(b->built));
+        b->ready = false;
+        // A request that arrived meanwhile can start now
+        pthread_cond_signal(&b->cond);
+    }
+    pthread_mutex_unlock(&b->mutex);
+    return ready;
+}
@@ -0,0 +1,43 @@
+#ifndef ATLAS_BUILDER_H_
+#define ATLAS_BUILDER_H_
+
+#include <pthread.h>
+#include <stdbool.h>
+
+#include "glyph.h"
+
+// Rasterizes the glyph atlas at another pixel size on a worker thread when the content
+// scale of the window changes. Building the signed distance fields takes about a second,
+// so the frames keep rendering with the current atlas (stretched to the new size) until
+// atlas_builder_poll swaps the result in. Only the CPU side is built on the worker, the
+// texture is replaced by whichever thread owns the OpenGL context.
+
+#define ATLAS_BUILDER_POLL_PERIOD 0.1 // Seconds between two redraws of a still window while building
+
+typedef struct {
+    FT_Face face; // Only used by the worker once started
+
+    pthread_t thread;
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    FT_UInt requested; // Pixel size of the next build, 0 when none is pending
+    FT_UInt building;  // Pixel size of the build in progress, 0 when idle
+    Free_Glyph_Atlas built;
+    bool ready;        // built holds a finished atlas
+    bool started;
+    bool quit;
+} Atlas_Builder;
+
+bool atlas_builder_start(Atlas_Builder *b, FT_Face face);
+// Waits for the build in progress and frees the unclaimed results
+void atlas_builder_stop(Atlas_Builder *b);
+// Rebuilds at pixel_size unless that is already the latest size built or requested.
+// A newer request replaces a pending one that has not started yet.
+void atlas_builder_request(Atlas_Builder *b, FT_UInt pixel_size, const Free_Glyph_Atlas *current);
+// A build is pending, in progress or waiting to be claimed
+bool atlas_builder_busy(Atlas_Builder *b);
+// Moves a finished build into atlas, which keeps its texture. Returns true when it did,
+// the caller has to replace the texture contents (see free_glyph_atlas_update).
+bool atlas_builder_poll(Atlas_Builder *b, Free_Glyph_Atlas *atlas);
+
+#endif  // ATLAS_BUILDER_H_
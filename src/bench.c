@@ -0,0 +1,968 @@
+#define _POSIX_C_SOURCE 200809L
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "gl.h"
+
+#include "common.h"
+#include "renderer.h"
+#include "glyph.h"
+#include "app.h"
+#include "entities.h"
+#include "framebuffer.h"
+#include "gpu_memory.h"
+#include "la_bench.h"
+#include "softrast.h"
+#ifndef GL_NULL
+#include "egl_context.h"
+#endif
+
+// Headless renderer and text benchmarks. Every scenario renders a number of frames into an
+// offscreen framebuffer and the results are printed as JSON, so runs can be compared
+// between commits.
+//
+// Built with GL_NULL (make bench-null) no driver is involved at all and the scenarios
+// measure only the CPU cost of the batching layer. The report then additionally contains
+// the exact OpenGL calls every scenario would have made, and the scenarios listed in
+// gl_null_expectations fail when they differ from the expected calls.
+//
+// With --software the same scenarios are rasterized by softrast.c, which makes it possible
+// to compare the CPU backend against llvmpipe on identical scenes.
+//
+// The "la" section runs the vector operations of la.h through the SIMD backend and the
+// scalar reference, and the span and batched transform kernels against loops over the single
+// value functions. It reports the time per operation of both and fails on any difference.
+
+#define BENCH_DEFAULT_FRAMES 100
+#define BENCH_DEFAULT_COUNT  10000
+#define BENCH_FRAMES_CAP     10000
+
+static Free_Glyph_Atlas atlas = {0};
+static Renderer renderer = {0};
+static FT_Face face;
+static App app = {0};
+static Softrast softrast = {0};
+static Entities entities = {0};
+static bool software = false;
+static size_t threads = 0; // Of the software rasterizer and the entity update, 0 for one per CPU
+
+static double now_secs(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double) ts.tv_sec + (double) ts.tv_nsec * 1e-9;
+}
+
+// Everything a scenario produced during one frame
+typedef struct {
+    size_t vertices;
+    size_t glyphs;
+} Frame_Work;
+
+typedef void (*Scenario_Frame)(size_t count, size_t frame, Frame_Work *work);
+
+typedef struct {
+    const char *name;
+    const char *description;
+    Scenario_Frame frame;
+    bool uber;
+    size_t frames_cap; // Limits the timed frames of slow scenarios, 0 means no limit
+} Scenario;
+
+static void scenario_rects(size_t count, size_t frame, Frame_Work *work)
+{
+    renderer_set_shader(&renderer, SHADER_COLOR);
+    for (size_t i = 0; i < count; ++i) {
+        float x = (float) ((i*37 + frame) % SCREEN_WIDTH);
+        float y = (float) ((i*91) % SCREEN_HEIGHT);
+        renderer_rect(&renderer, v2f(x, y), v4f(1, 0.5f, 0.25f, 1), v2f(8, 8));
+    }
+    renderer_flush(&renderer);
+    work->vertices += count*6;
+}
+
+// Every rect rotated around its center, one transform push and pop per rect
+static void scenario_rotated_rects(size_t count, size_t frame, Frame_Work *work)
+{
+    renderer_set_shader(&renderer, SHADER_COLOR);
+    for (size_t i = 0; i < count; ++i) {
+        float x = (float) ((i*37 + frame) % SCREEN_WIDTH);
+        float y = (float) ((i*91) % SCREEN_HEIGHT);
+        renderer_push_transform(&renderer, m3f_mul(m3f_translate(v2f(x, y)), m3f_rotate((float) (i + frame)*0.01f)));
+        renderer_rect_center(&renderer, v2f(0, 0), v4f(1, 0.5f, 0.25f, 1), v2f(8, 8));
+        renderer_pop_transform(&renderer);
+    }
+    renderer_flush(&renderer);
+    work->vertices += count*6;
+}
+
+static const char bench_text[] = "The quick brown fox jumps over the lazy dog 0123456789";
+#define BENCH_TEXT_LEN (sizeof(bench_text) - 1)
+
+static void scenario_glyphs(size_t count, size_t frame, Frame_Work *work)
+{
+    (void) frame;
+    renderer_set_shader(&renderer, SHADER_TEXT);
+    size_t glyphs = 0;
+    for (size_t line = 0; glyphs < count; ++line) {
+        size_t n = count - glyphs;
+        if (n > BENCH_TEXT_LEN) n = BENCH_TEXT_LEN;
+        V2f pos = v2f(0, (float) (line % 8) * 20);
+        free_glyph_atlas_render_line_sized(&atlas, &renderer, bench_text, n, &pos, v4f(1, 1, 1, 1));
+        glyphs += n;
+    }
+    renderer_flush(&renderer);
+    work->vertices += glyphs*6;
+    work->glyphs += glyphs;
+}
+
+// Interleaved UI content: a label on top of every box, so the shader changes twice per item
+static void scenario_shader_switch(size_t count, size_t frame, Frame_Work *work)
+{
+    size_t items = count / 16;
+    if (items == 0) items = 1;
+    for (size_t i = 0; i < items; ++i) {
+        V2f pos = v2f((float) ((i*53 + frame) % SCREEN_WIDTH), (float) ((i*29) % SCREEN_HEIGHT));
+        renderer_set_shader(&renderer, (i % 2 == 0) ? SHADER_COLOR : SHADER_RAINBOW);
+        renderer_rect(&renderer, pos, v4f(0.2f, 0.2f, 0.2f, 1), v2f(64, 24));
+        renderer_set_shader(&renderer, SHADER_TEXT);
+        V2f text_pos = pos;
+        free_glyph_atlas_render_line_sized(&atlas, &renderer, "Label", 5, &text_pos, v4f(1, 1, 1, 1));
+        work->vertices += 6 + 5*6;
+        work->glyphs += 5;
+    }
+    renderer_flush(&renderer);
+}
+
+static void scenario_atlas_build(size_t count, size_t frame, Frame_Work *work)
+{
+    (void) count;
+    (void) frame;
+    (void) work;
+    free_glyph_atlas_destroy(&atlas);
+    if (software) {
+        free_glyph_atlas_build(&atlas, face);
+    } else {
+        free_glyph_atlas_init(&atlas, face);
+    }
+}
+
+// The demo scene of the app and the headless renderer
+static void scenario_app(size_t count, size_t frame, Frame_Work *work)
+{
+    (void) count;
+    (void) frame;
+    size_t vertices = renderer.stats.values[RENDERER_STAT_VERTICES];
+    app_update(&app);
+    app_render(&app, &renderer, &atlas, 1.0f);
+    work->vertices += renderer.stats.values[RENDERER_STAT_VERTICES] - vertices;
+    work->glyphs += APP_TITLE_LEN;
+}
+
+// Mass simulated bouncing rects, the untimed warm up frame starts the worker threads and
+// spawns them
+static void scenario_entities(size_t count, size_t frame, Frame_Work *work)
+{
+    (void) frame;
+    V2f size = v2f(SCREEN_WIDTH, SCREEN_HEIGHT);
+    if (entities.threads == NULL && !entities_init(&entities, threads)) exit(1);
+    if (entities.count != count && !entities_spawn(&entities, count, size, 1)) exit(1);
+    entities_update(&entities, size, false);
+    renderer_set_shader(&renderer, SHADER_COLOR);
+    entities_render(&entities, &renderer, 1.0f, 1.0f);
+    renderer_flush(&renderer);
+    work->vertices += count*6;
+}
+
+static const Scenario scenarios[] = {
+    {
+        .name = "rects",
+        .description = "count renderer_rect calls per frame with the color shader",
+        .frame = scenario_rects,
+    },
+    {
+        .name = "rotated_rects",
+        .description = "count rects per frame, each rotated with its own transform",
+        .frame = scenario_rotated_rects,
+    },
+    {
+        .name = "glyphs",
+        .description = "count glyphs per frame through free_glyph_atlas_render_line_sized",
+        .frame = scenario_glyphs,
+    },
+    {
+        .name = "shader_switch",
+        .description = "count/16 interleaved boxes and labels, one program per shader",
+        .frame = scenario_shader_switch,
+    },
+    {
+        .name = "shader_switch_uber",
+        .description = "count/16 interleaved boxes and labels through the uber shader",
+        .frame = scenario_shader_switch,
+        .uber = true,
+    },
+    {
+        .name = "atlas_build",
+        .description = "free_glyph_atlas_init once per frame",
+        .frame = scenario_atlas_build,
+        .frames_cap = 10,
+    },
+    {
+        .name = "app",
+        .description = "the demo scene: title text and a rainbow rect, count is ignored",
+        .frame = scenario_app,
+    },
+    {
+        .name = "entities",
+        .description = "count entities updated with entities_update and drawn as rects",
+        .frame = scenario_entities,
+    },
+};
+#define SCENARIOS_COUNT (sizeof(scenarios)/sizeof(scenarios[0]))
+
+static int compare_doubles(const void *a, const void *b)
+{
+    double x = *(const double *) a;
+    double y = *(const double *) b;
+    return (x > y) - (x < y);
+}
+
+// Nearest rank percentile of sorted samples
+static double percentile(const double *sorted, size_t count, double p)
+{
+    size_t rank = (size_t) (p / 100.0 * (double) count + 0.5);
+    if (rank < 1) rank = 1;
+    if (rank > count) rank = count;
+    return sorted[rank - 1];
+}
+
+static double frame_times[BENCH_FRAMES_CAP];
+
+#define LA_BENCH_VECTORS 4096
+#define LA_BENCH_REPS    128
+#define LA_BENCH_ROUNDS  3
+
+typedef struct {
+    V4f a[LA_BENCH_VECTORS], b[LA_BENCH_VECTORS], c[LA_BENCH_VECTORS];
+    V4f simd[LA_BENCH_VECTORS], scalar[LA_BENCH_VECTORS];
+} La_Bench_Data;
+
+static La_Bench_Data la_data;
+
+// Ordinary values plus the edge cases where SIMD instructions and libm tend to disagree
+static float la_bench_value(uint32_t *state)
+{
+    static const float specials[] = {0.0f, -0.0f, 0.5f, -0.5f, 1.0f, -1.5f, 8388607.5f, -8388609.0f, 1e30f, INFINITY, -INFINITY, NAN};
+    *state ^= *state << 13;
+    *state ^= *state >> 17;
+    *state ^= *state << 5;
+    if (*state % 8 == 0) return specials[(*state >> 8) % (sizeof(specials)/sizeof(specials[0]))];
+    return ((float) (*state >> 8) / (float) (1 << 24) - 0.5f) * 200.0f;
+}
+
+// Same bits, except for what C leaves unspecified: the payload of NaN and the sign of
+// zero returned by fminf/fmaxf for +0 and -0. COUNT_LA_OPS compares plain arithmetic.
+static size_t la_bench_mismatches(La_Op op, const float *simd, const float *scalar, size_t n)
+{
+    bool signed_zero = op == LA_OP_MIN || op == LA_OP_MAX || op == LA_OP_CLAMP;
+    size_t mismatches = 0;
+    for (size_t i = 0; i < n; ++i) {
+        if (isnan(simd[i]) && isnan(scalar[i])) continue;
+        if (signed_zero && simd[i] == 0.0f && scalar[i] == 0.0f) continue;
+        if (memcmp(&simd[i], &scalar[i], sizeof(float)) != 0) mismatches += 1;
+    }
+    return mismatches;
+}
+
+// Uniform in [0, 1)
+static double la_bench_unit(uint32_t *state)
+{
+    *state ^= *state << 13;
+    *state ^= *state >> 17;
+    *state ^= *state << 5;
+    return (double) (*state >> 8) / (double) (1 << 24);
+}
+
+// Inputs spread over the domain of the _fast function, b is the exponent of pow
+static void la_bench_fast_input(La_Fast f, uint32_t *state, float *a, float *b)
+{
+    double u = la_bench_unit(state)*2.0 - 1.0;
+    *b = 0.0f;
+    switch (f) {
+    case LA_FAST_SIN:
+    case LA_FAST_COS:
+        // Cubed to test small angles as densely as the large ones
+        *a = (float) (u*u*u*LA_FAST_TRIG_DOMAIN);
+        break;
+    case LA_FAST_EXP2:
+        *a = (float) (0.5 + u*126.5);
+        break;
+    case LA_FAST_LOG2:
+        *a = (float) exp2(0.5 + u*126.5);
+        break;
+    case LA_FAST_POW:
+        *a = (float) exp2(u*10.0);
+        *b = (float) ((la_bench_unit(state)*2.0 - 1.0)*3.2);
+        break;
+    default: assert(0 && "unreachable");
+    }
+}
+
+static double la_bench_fast_reference(La_Fast f, float a, float b)
+{
+    switch (f) {
+    case LA_FAST_SIN:  return sin(a);
+    case LA_FAST_COS:  return cos(a);
+    case LA_FAST_EXP2: return exp2(a);
+    case LA_FAST_LOG2: return log2(a);
+    case LA_FAST_POW:  return pow(a, b);
+    default: assert(0 && "unreachable");
+    }
+    return 0.0;
+}
+
+static double la_bench_fast_bound(La_Fast f)
+{
+    switch (f) {
+    case LA_FAST_SIN:
+    case LA_FAST_COS:  return LA_FAST_SIN_MAX_ERROR;
+    case LA_FAST_EXP2: return LA_FAST_EXP2_MAX_ERROR;
+    case LA_FAST_LOG2: return LA_FAST_LOG2_MAX_ERROR;
+    case LA_FAST_POW:  return LA_FAST_POW_MAX_ERROR;
+    default: assert(0 && "unreachable");
+    }
+    return 0.0;
+}
+
+// Every half and unorm16 code, 256 times every byte
+#define LA_PACK_VALUES 65536
+#define LA_PACK_REPS   16
+
+typedef struct {
+    float floats[2][LA_PACK_VALUES];
+    unsigned short codes[2][LA_PACK_VALUES];
+} La_Pack_Data;
+
+static La_Pack_Data la_pack_data;
+
+// Halves: every magnitude from subnormal to overflow plus the special values. Unorm: a bit
+// outside of [0, 1] on both sides, for unorm16 also the floats next to the halfway points.
+static float la_bench_pack_input(La_Pack p, uint32_t *state)
+{
+    static const float specials[] = {0.0f, -0.0f, 65504.0f, 65519.99f, 65520.0f, 6.1035156e-5f, 5.9604645e-8f, 2.9802322e-8f, INFINITY, -INFINITY, NAN};
+    double u = la_bench_unit(state);
+    if (p == LA_PACK_HALF) {
+        if (u < 0.05) return specials[(size_t) (u*20.0*(sizeof(specials)/sizeof(specials[0])))];
+        double sign = la_bench_unit(state) < 0.5 ? -1.0 : 1.0;
+        return (float) (sign*exp2(u*44.0 - 27.0));
+    }
+    if (u < 0.01) return NAN;
+    if (p == LA_PACK_UNORM16 && u < 0.2) {
+        float halfway = (float) ((floor(la_bench_unit(state)*65535.0) + 0.5)/65535.0);
+        return u < 0.1 ? nextafterf(halfway, 0.0f) : nextafterf(halfway, 1.0f);
+    }
+    return (float) (u*1.2 - 0.1);
+}
+
+// The exact value of a half
+static double la_bench_half_value(unsigned short h)
+{
+    double sign = h & 0x8000 ? -1.0 : 1.0;
+    int e = (h >> 10) & 31;
+    int m = h & 1023;
+    if (e == 31) return m ? NAN : sign*INFINITY;
+    if (e == 0) return sign*ldexp(m, -24);
+    return sign*ldexp(1024 + m, e - 25);
+}
+
+// Unorm16 has to round to nearest exactly. The float products of unorm8 and sRGB through
+// powf_fast may be off by one code close to the halfway point, by at most the slack.
+static size_t la_bench_pack_errors(La_Pack p, bool unpack, const float *floats, const unsigned short *codes)
+{
+    const unsigned char *bytes = (const unsigned char *) codes;
+    size_t errors = 0;
+    for (size_t i = 0; i < LA_PACK_VALUES; ++i) {
+        double x = floats[i];
+        bool srgb = p == LA_PACK_RGBA8_SRGB && i%4 != 3;
+        if (p == LA_PACK_HALF) {
+            unsigned short h = codes[i];
+            if (unpack) {
+                double expected = la_bench_half_value(h);
+                if (isnan(expected) ? !isnan(x) : x != expected) errors += 1;
+            } else if (isnan(x)) {
+                if (!isnan(la_bench_half_value(h))) errors += 1;
+            } else if (fabs(x) >= 65520.0) {
+                if ((h & 0x7fff) != 0x7c00) errors += 1;
+            } else {
+                // No neighbor is closer and ties go to the even code
+                double d = fabs(x - la_bench_half_value(h));
+                unsigned short neighbors[2] = {h - 1, h + 1};
+                for (size_t k = 0; k < 2; ++k) {
+                    if ((neighbors[k] & 0x8000) != (h & 0x8000) || (neighbors[k] & 0x7fff) > 0x7c00) continue;
+                    double dn = fabs(x - la_bench_half_value(neighbors[k]));
+                    if (dn < d || (dn == d && (h & 1))) errors += 1;
+                }
+            }
+            continue;
+        }
+
+        double max = p == LA_PACK_UNORM16 ? 65535.0 : 255.0;
+        unsigned int code = p == LA_PACK_UNORM16 ? codes[i] : bytes[i];
+        if (unpack) {
+            double expected = code/max;
+            if (srgb) expected = expected <= 0.04045 ? expected/12.92 : pow((expected + 0.055)/1.055, 2.4);
+            if (srgb ? fabs(x - expected) > 1e-5*expected : x != (float) expected) errors += 1;
+        } else {
+            double c = isnan(x) ? 0.0 : fmin(fmax(x, 0.0), 1.0);
+            if (srgb) c = c <= 0.0031308 ? c*12.92 : 1.055*pow(c, 1.0/2.4) - 0.055;
+            if (p == LA_PACK_UNORM16) {
+                if (code != (unsigned int) floor(c*max + 0.5)) errors += 1;
+                continue;
+            }
+            double slack = srgb ? 1e-3 : 1.0/65536.0;
+            if (fabs(code - c*max) > 0.5 + slack) errors += 1;
+        }
+    }
+    return errors;
+}
+
+// Runs op over the V2f, V3f or V4f view of la_data through both backends
+static void la_bench_run(size_t components, La_Op op, bool scalar, size_t reps)
+{
+    La_Bench_Data *d = &la_data;
+    V4f *out = scalar ? d->scalar : d->simd;
+    for (size_t r = 0; r < reps; ++r) {
+        switch (components) {
+        case 2:
+            (scalar ? la_bench_v2f_scalar : la_bench_v2f)(op, (V2f *) d->a, (V2f *) d->b, (V2f *) d->c, (V2f *) out, LA_BENCH_VECTORS);
+            break;
+        case 3:
+            (scalar ? la_bench_v3f_scalar : la_bench_v3f)(op, (V3f *) d->a, (V3f *) d->b, (V3f *) d->c, (V3f *) out, LA_BENCH_VECTORS);
+            break;
+        default:
+            (scalar ? la_bench_v4f_scalar : la_bench_v4f)(op, d->a, d->b, d->c, out, LA_BENCH_VECTORS);
+            break;
+        }
+    }
+}
+
+static bool run_la(FILE *out)
+{
+    uint32_t state = 0x9e3779b9;
+    float *inputs[] = {&la_data.a[0].x, &la_data.b[0].x, &la_data.c[0].x};
+    for (size_t k = 0; k < sizeof(inputs)/sizeof(inputs[0]); ++k) {
+        for (size_t i = 0; i < LA_BENCH_VECTORS*4; ++i) inputs[k][i] = la_bench_value(&state);
+    }
+
+    bool ok = true;
+    fprintf(out, "  \"la\": {\n");
+    fprintf(out, "    \"backend\": \"%s\",\n", LA_BACKEND);
+    fprintf(out, "    \"vectors\": %d,\n", LA_BENCH_VECTORS);
+    fprintf(out, "    \"ops\": [\n");
+    for (size_t components = 2; components <= 4; ++components) {
+        for (La_Op op = 0; op < COUNT_LA_OPS; ++op) {
+            // Only the first LA_BENCH_VECTORS vectors of the view are written
+            size_t floats = components*LA_BENCH_VECTORS;
+            memset(la_data.simd, 0, sizeof(la_data.simd));
+            memset(la_data.scalar, 0, sizeof(la_data.scalar));
+            la_bench_run(components, op, false, 1);
+            la_bench_run(components, op, true, 1);
+            size_t mismatches = la_bench_mismatches(op, &la_data.simd[0].x, &la_data.scalar[0].x, floats);
+            if (mismatches > 0) {
+                fprintf(stderr, "ERROR: v%zuf_%s: %zu of %zu components differ between %s and scalar\n",
+                        components, la_op_name(op), mismatches, floats, LA_BACKEND);
+                ok = false;
+            }
+
+            double secs[2] = {INFINITY, INFINITY};
+            for (size_t round = 0; round < LA_BENCH_ROUNDS; ++round) {
+                for (size_t scalar = 0; scalar < 2; ++scalar) {
+                    double start = now_secs();
+                    la_bench_run(components, op, scalar, LA_BENCH_REPS);
+                    secs[scalar] = fmin(secs[scalar], now_secs() - start);
+                }
+            }
+            double ops = (double) LA_BENCH_VECTORS*LA_BENCH_REPS;
+            fprintf(out, "      {\"name\": \"v%zuf_%s\", \"simd_ns\": %.3f, \"scalar_ns\": %.3f, \"mismatches\": %zu}%s\n",
+                    components, la_op_name(op), secs[0]/ops*1e9, secs[1]/ops*1e9, mismatches,
+                    components == 4 && op + 1 == COUNT_LA_OPS ? "" : ",");
+        }
+    }
+    fprintf(out, "    ],\n");
+
+    // One element short of a full register, so the scalar tails run as well
+    size_t n = LA_BENCH_VECTORS - 1;
+    fprintf(out, "    \"spans\": [\n");
+    bool first = true;
+    for (size_t components = 1; components <= 4; components *= 2) {
+        for (La_Op op = 0; op < COUNT_LA_OPS; ++op) {
+            float *a = &la_data.a[0].x, *b = &la_data.b[0].x;
+            if (!la_bench_span(op, components, false, a, b, &la_data.simd[0].x, n)) continue;
+            la_bench_span(op, components, true, a, b, &la_data.scalar[0].x, n);
+            size_t mismatches = la_bench_mismatches(op, &la_data.simd[0].x, &la_data.scalar[0].x, components*n);
+            const char *prefix = components == 1 ? "spanf" : components == 2 ? "span2f" : "span4f";
+            if (mismatches > 0) {
+                fprintf(stderr, "ERROR: %s_%s: %zu of %zu components differ from the per element functions\n",
+                        prefix, la_op_name(op), mismatches, components*n);
+                ok = false;
+            }
+
+            // Best of alternating rounds, the first round of each kernel tends to be slower
+            double secs[2] = {INFINITY, INFINITY};
+            for (size_t round = 0; round < LA_BENCH_ROUNDS; ++round) {
+                for (size_t per_element = 0; per_element < 2; ++per_element) {
+                    double start = now_secs();
+                    for (size_t r = 0; r < LA_BENCH_REPS; ++r) {
+                        la_bench_span(op, components, per_element, a, b, per_element ? &la_data.scalar[0].x : &la_data.simd[0].x, n);
+                    }
+                    secs[per_element] = fmin(secs[per_element], now_secs() - start);
+                }
+            }
+            double elements = (double) n*LA_BENCH_REPS;
+            fprintf(out, "%s      {\"name\": \"%s_%s\", \"span_ns\": %.3f, \"per_element_ns\": %.3f, \"mismatches\": %zu}",
+                    first ? "" : ",\n", prefix, la_op_name(op), secs[0]/elements*1e9, secs[1]/elements*1e9, mismatches);
+            first = false;
+        }
+    }
+    fprintf(out, "\n    ],\n");
+
+    fprintf(out, "    \"transforms\": [\n");
+    for (size_t components = 2; components <= 4; components += 2) {
+        const char *name = components == 2 ? "m3f_transform_points" : "m4f_transform_points";
+        const float *src = &la_data.a[0].x;
+        la_bench_transform(components, false, src, &la_data.simd[0].x, n);
+        la_bench_transform(components, true, src, &la_data.scalar[0].x, n);
+        size_t mismatches = la_bench_mismatches(COUNT_LA_OPS, &la_data.simd[0].x, &la_data.scalar[0].x, components*n);
+        if (mismatches > 0) {
+            fprintf(stderr, "ERROR: %s: %zu of %zu components differ from the single point function\n",
+                    name, mismatches, components*n);
+            ok = false;
+        }
+
+        double secs[2] = {INFINITY, INFINITY};
+        for (size_t round = 0; round < LA_BENCH_ROUNDS; ++round) {
+            for (size_t per_element = 0; per_element < 2; ++per_element) {
+                double start = now_secs();
+                for (size_t r = 0; r < LA_BENCH_REPS; ++r) {
+                    la_bench_transform(components, per_element, src, per_element ? &la_data.scalar[0].x : &la_data.simd[0].x, n);
+                }
+                secs[per_element] = fmin(secs[per_element], now_secs() - start);
+            }
+        }
+        double points = (double) n*LA_BENCH_REPS;
+        fprintf(out, "      {\"name\": \"%s\", \"batched_ns\": %.3f, \"per_element_ns\": %.3f, \"mismatches\": %zu}%s\n",
+                name, secs[0]/points*1e9, secs[1]/points*1e9, mismatches, components == 4 ? "" : ",");
+    }
+    fprintf(out, "    ],\n");
+
+    // The _fast approximations against double precision libm inside of their documented
+    // domain, the SIMD spans against the scalar ones and the speed against the float libm
+    n = LA_BENCH_VECTORS*4 - 1;
+    float *a = &la_data.a[0].x, *b = &la_data.b[0].x;
+    fprintf(out, "    \"fast\": [\n");
+    for (La_Fast f = 0; f < COUNT_LA_FASTS; ++f) {
+        for (size_t i = 0; i < n; ++i) la_bench_fast_input(f, &state, &a[i], &b[i]);
+        la_bench_fast(f, false, a, b, &la_data.simd[0].x, n);
+        la_bench_fast_scalar(f, false, a, b, &la_data.scalar[0].x, n);
+        size_t mismatches = la_bench_mismatches(COUNT_LA_OPS, &la_data.simd[0].x, &la_data.scalar[0].x, n);
+        if (mismatches > 0) {
+            fprintf(stderr, "ERROR: %s_fast: %zu of %zu values differ between %s and scalar\n",
+                    la_fast_name(f), mismatches, n, LA_BACKEND);
+            ok = false;
+        }
+
+        bool relative = f == LA_FAST_EXP2 || f == LA_FAST_POW;
+        double max_error = 0.0;
+        float worst = 0.0f;
+        for (size_t i = 0; i < n; ++i) {
+            double expected = la_bench_fast_reference(f, a[i], b[i]);
+            double error = fabs((double) (&la_data.simd[0].x)[i] - expected);
+            if (relative) error /= fabs(expected);
+            // The float result of log2 can not be more precise than its magnitude allows
+            if (f == LA_FAST_LOG2 && fabs(expected) > 1.0) error /= fabs(expected);
+            if (!(error <= max_error)) {
+                max_error = error;
+                worst = a[i];
+            }
+        }
+        double bound = la_bench_fast_bound(f);
+        if (!(max_error <= bound)) {
+            fprintf(stderr, "ERROR: %s_fast: %s error %g at %g exceeds the documented %g\n",
+                    la_fast_name(f), relative ? "relative" : "absolute", max_error, worst, bound);
+            ok = false;
+        }
+
+        double secs[2] = {INFINITY, INFINITY};
+        for (size_t round = 0; round < LA_BENCH_ROUNDS; ++round) {
+            for (size_t libm = 0; libm < 2; ++libm) {
+                double start = now_secs();
+                for (size_t r = 0; r < LA_BENCH_REPS; ++r) {
+                    la_bench_fast(f, libm, a, b, libm ? &la_data.scalar[0].x : &la_data.simd[0].x, n);
+                }
+                secs[libm] = fmin(secs[libm], now_secs() - start);
+            }
+        }
+        double values = (double) n*LA_BENCH_REPS;
+        fprintf(out, "      {\"name\": \"%s_fast\", \"fast_ns\": %.3f, \"libm_ns\": %.3f, \"max_error\": %.3g, \"bound\": %.3g, \"mismatches\": %zu}%s\n",
+                la_fast_name(f), secs[0]/values*1e9, secs[1]/values*1e9, max_error, bound, mismatches,
+                f + 1 == COUNT_LA_FASTS ? "" : ",");
+    }
+    fprintf(out, "    ],\n");
+
+    // Packing is checked against the exact rounding in double precision, unpacking against
+    // the exact value of every code
+    fprintf(out, "    \"packs\": [\n");
+    for (La_Pack p = 0; p < COUNT_LA_PACKS; ++p) {
+        for (size_t unpack = 0; unpack < 2; ++unpack) {
+            La_Pack_Data *d = &la_pack_data;
+            if (unpack) {
+                for (size_t i = 0; i < LA_PACK_VALUES; ++i) {
+                    d->codes[0][i] = (unsigned short) i;
+                    if (p == LA_PACK_RGBA8 || p == LA_PACK_RGBA8_SRGB) ((unsigned char *) d->codes[0])[i] = (unsigned char) i;
+                }
+            } else {
+                for (size_t i = 0; i < LA_PACK_VALUES; ++i) d->floats[0][i] = la_bench_pack_input(p, &state);
+            }
+            // The scalar build reads the inputs from index 0 and writes to index 1
+            memcpy(d->floats[1], d->floats[0], sizeof(d->floats[0]));
+            memcpy(d->codes[1], d->codes[0], sizeof(d->codes[0]));
+            la_bench_pack(p, unpack, d->floats[0], d->codes[0], LA_PACK_VALUES);
+            la_bench_pack_scalar(p, unpack, d->floats[1], d->codes[1], LA_PACK_VALUES);
+
+            size_t mismatches = 0;
+            if (unpack) {
+                mismatches = la_bench_mismatches(COUNT_LA_OPS, d->floats[0], d->floats[1], LA_PACK_VALUES);
+            } else {
+                mismatches = memcmp(d->codes[0], d->codes[1], sizeof(d->codes[0])) != 0;
+            }
+            size_t errors = la_bench_pack_errors(p, unpack, d->floats[0], d->codes[0]);
+            const char *name = la_pack_name(p);
+            const char *direction = unpack ? "unpack" : "pack";
+            if (mismatches > 0 || errors > 0) {
+                fprintf(stderr, "ERROR: %s_%s: %zu values differ between %s and scalar, %zu are not correctly rounded\n",
+                        name, direction, mismatches, LA_BACKEND, errors);
+                ok = false;
+            }
+
+            double secs[2] = {INFINITY, INFINITY};
+            for (size_t round = 0; round < LA_BENCH_ROUNDS; ++round) {
+                for (size_t scalar = 0; scalar < 2; ++scalar) {
+                    double start = now_secs();
+                    for (size_t r = 0; r < LA_PACK_REPS; ++r) {
+                        (scalar ? la_bench_pack_scalar : la_bench_pack)(p, unpack, d->floats[scalar], d->codes[scalar], LA_PACK_VALUES);
+                    }
+                    secs[scalar] = fmin(secs[scalar], now_secs() - start);
+                }
+            }
+            double values = (double) LA_PACK_VALUES*LA_PACK_REPS;
+            fprintf(out, "      {\"name\": \"%s_%s\", \"simd_ns\": %.3f, \"scalar_ns\": %.3f, \"mismatches\": %zu, \"errors\": %zu}%s\n",
+                    name, direction, secs[0]/values*1e9, secs[1]/values*1e9, mismatches, errors,
+                    p + 1 == COUNT_LA_PACKS && unpack ? "" : ",");
+        }
+    }
+    fprintf(out, "    ]\n");
+    fprintf(out, "  },\n");
+    return ok;
+}
+
+#ifdef GL_NULL
+// The exact OpenGL work per timed frame of the scenarios whose content does not depend on
+// count, derived from what a real driver has to be given for them. bench-null fails when
+// the batching layer makes more or fewer calls or uploads.
+typedef struct {
+    const char *scenario;
+    size_t count;           // Only checked with this count, 0 for any
+    size_t draw_calls;
+    size_t program_switches;
+    size_t uniform_uploads; // glUniform* calls
+    size_t bytes_uploaded;  // Vertices, materials and uniform arrays
+} Gl_Null_Expectation;
+
+static const Gl_Null_Expectation gl_null_expectations[] = {
+    // The title and the rect, one batch and program each. The time changes every frame, so
+    // the rainbow program gets its time and cells again.
+    {
+        .scenario = "app",
+        .draw_calls = 2,
+        .program_switches = 2,
+        .uniform_uploads = 2,
+        .bytes_uploaded = (APP_TITLE_LEN + 1)*6*sizeof(Vertex) + 2*sizeof(Material) + RAINBOW_CELLS_COUNT*sizeof(V2f),
+    },
+    // Everything is one batch of the uber program, which stays bound from the warm up frame
+    {
+        .scenario = "shader_switch_uber",
+        .count = BENCH_DEFAULT_COUNT,
+        .draw_calls = 2,
+        .program_switches = 0,
+        .uniform_uploads = 2,
+        .bytes_uploaded = (BENCH_DEFAULT_COUNT/16)*(1 + 5)*6*sizeof(Vertex) + 2*sizeof(Material) + RAINBOW_CELLS_COUNT*sizeof(V2f),
+    },
+};
+
+static bool check_gl_null_calls(const Scenario *scenario, const Gl_Null_Stats *before, size_t frames, size_t count)
+{
+    for (size_t i = 0; i < sizeof(gl_null_expectations)/sizeof(gl_null_expectations[0]); ++i) {
+        const Gl_Null_Expectation *e = &gl_null_expectations[i];
+        if (strcmp(e->scenario, scenario->name) != 0) continue;
+        if (e->count != 0 && e->count != count) continue;
+
+        const size_t *calls = gl_null_stats.calls;
+        const size_t *prev = before->calls;
+        size_t actual[4] = {
+            calls[GL_NULL_DRAW_ARRAYS] - prev[GL_NULL_DRAW_ARRAYS],
+            calls[GL_NULL_USE_PROGRAM] - prev[GL_NULL_USE_PROGRAM],
+            calls[GL_NULL_UNIFORM1F] - prev[GL_NULL_UNIFORM1F] + calls[GL_NULL_UNIFORM1I] - prev[GL_NULL_UNIFORM1I] +
+            calls[GL_NULL_UNIFORM2F] - prev[GL_NULL_UNIFORM2F] + calls[GL_NULL_UNIFORM2FV] - prev[GL_NULL_UNIFORM2FV],
+            gl_null_stats.bytes_uploaded - before->bytes_uploaded,
+        };
+        size_t expected[4] = {e->draw_calls, e->program_switches, e->uniform_uploads, e->bytes_uploaded};
+        const char *names[4] = {"draw calls", "program switches", "uniform uploads", "uploaded bytes"};
+        bool ok = true;
+        for (size_t j = 0; j < 4; ++j) {
+            if (actual[j] != expected[j]*frames) {
+                fprintf(stderr, "ERROR: %s: expected %zu %s per frame, got %.2f\n",
+                        scenario->name, expected[j], names[j], (double) actual[j]/frames);
+                ok = false;
+            }
+        }
+        return ok;
+    }
+    return true;
+}
+#endif // GL_NULL
+
+static void begin_frame(Framebuffer *fb)
+{
+    if (software) {
+        softrast_clear(&softrast, v4f(0, 0, 0, 1));
+    } else {
+        framebuffer_bind(fb);
+        glClear(GL_COLOR_BUFFER_BIT);
+    }
+}
+
+// softrast_draw is synchronous, so only OpenGL has to wait for the frame to finish
+static void end_frame(void)
+{
+    if (!software) glFinish();
+    renderer_end_frame(&renderer);
+}
+
+static bool run_scenario(FILE *out, const Scenario *scenario, Framebuffer *fb, size_t frames, size_t count, bool last)
+{
+    bool ok = true;
+    if (scenario->frames_cap > 0 && frames > scenario->frames_cap) frames = scenario->frames_cap;
+    renderer.uber = scenario->uber;
+    renderer.resolution = v2f(SCREEN_WIDTH, SCREEN_HEIGHT);
+    app_init(&app);
+
+    // One untimed frame to warm up caches and driver state. Its time is not the one of any
+    // timed frame, so every timed frame uploads the time dependent uniforms.
+    renderer.time = -1.0;
+    begin_frame(fb);
+    scenario->frame(count, 0, &(Frame_Work) {0});
+    end_frame();
+
+    // Only the timed frames count towards the stats
+    memset(&renderer.total, 0, sizeof(renderer.total));
+    renderer.frames = 0;
+    Frame_Work work = {0};
+
+#ifdef GL_NULL
+    Gl_Null_Stats gl_stats = gl_null_stats;
+#endif
+
+    double total = 0.0;
+    for (size_t frame = 0; frame < frames; ++frame) {
+        double start = now_secs();
+        renderer.time = (double) frame / 60.0;
+        begin_frame(fb);
+        scenario->frame(count, frame, &work);
+        end_frame();
+        frame_times[frame] = now_secs() - start;
+        total += frame_times[frame];
+    }
+
+    const size_t *stats = renderer.total.values;
+    qsort(frame_times, frames, sizeof(frame_times[0]), compare_doubles);
+
+    fprintf(out, "    {\n");
+    fprintf(out, "      \"name\": \"%s\",\n", scenario->name);
+    fprintf(out, "      \"description\": \"%s\",\n", scenario->description);
+    fprintf(out, "      \"count\": %zu,\n", count);
+    fprintf(out, "      \"frames\": %zu,\n", frames);
+    fprintf(out, "      \"vertices_per_second\": %.0f,\n", (double) work.vertices / total);
+    fprintf(out, "      \"glyphs_per_second\": %.0f,\n", (double) work.glyphs / total);
+    fprintf(out, "      \"draw_calls_per_frame\": %.2f,\n", (double) stats[RENDERER_STAT_DRAW_CALLS] / frames);
+    fprintf(out, "      \"bytes_uploaded_per_frame\": %.0f,\n", (double) stats[RENDERER_STAT_BYTES_UPLOADED] / frames);
+    // Averages per frame, except for the peak batch fill which is the maximum
+    fprintf(out, "      \"renderer_stats\": {");
+    for (Renderer_Stat s = 0; s < COUNT_RENDERER_STATS; ++s) {
+        double value = s == RENDERER_STAT_PEAK_BATCH_FILL ? (double) stats[s] : (double) stats[s] / frames;
+        fprintf(out, "%s\"%s\": %.2f", s == 0 ? "" : ", ", renderer_stat_name(s), value);
+    }
+    fprintf(out, "},\n");
+    fprintf(out, "      \"gpu_memory_bytes\": %zu,\n", gpu_memory.total_bytes);
+    fprintf(out, "      \"gpu_memory_peak_bytes\": %zu,\n", gpu_memory.peak_bytes);
+    fprintf(out, "      \"frame_time_ms\": {\"min\": %.4f, \"avg\": %.4f, \"p50\": %.4f, \"p90\": %.4f, \"p99\": %.4f, \"max\": %.4f}",
+            frame_times[0]*1000.0,
+            total/frames*1000.0,
+            percentile(frame_times, frames, 50)*1000.0,
+            percentile(frame_times, frames, 90)*1000.0,
+            percentile(frame_times, frames, 99)*1000.0,
+            frame_times[frames - 1]*1000.0);
+#ifdef GL_NULL
+    fprintf(out, ",\n      \"gl_vertices_drawn\": %zu,\n", gl_null_stats.vertices_drawn - gl_stats.vertices_drawn);
+    fprintf(out, "      \"gl_bytes_uploaded\": %zu,\n", gl_null_stats.bytes_uploaded - gl_stats.bytes_uploaded);
+    fprintf(out, "      \"gl_calls\": {");
+    bool first = true;
+    for (Gl_Null_Call call = 0; call < COUNT_GL_NULL_CALLS; ++call) {
+        size_t n = gl_null_stats.calls[call] - gl_stats.calls[call];
+        if (n == 0) continue;
+        fprintf(out, "%s\"%s\": %zu", first ? "" : ", ", gl_null_call_name(call), n);
+        first = false;
+    }
+    fprintf(out, "}\n");
+    ok = check_gl_null_calls(scenario, &gl_stats, frames, count);
+#else
+    fprintf(out, "\n");
+#endif
+    fprintf(out, "    }%s\n", last ? "" : ",");
+    return ok;
+}
+
+static void usage(const char *program)
+{
+    fprintf(stderr, "Usage: %s [OPTIONS]\n", program);
+    fprintf(stderr, "    --frames <n>        timed frames per scenario (default: %d, max: %d)\n", BENCH_DEFAULT_FRAMES, BENCH_FRAMES_CAP);
+    fprintf(stderr, "    --count <n>         amount of work per frame (default: %d)\n", BENCH_DEFAULT_COUNT);
+    fprintf(stderr, "    --scenario <name>   only run this scenario, \"la\" only runs the la.h backend comparison\n");
+    fprintf(stderr, "    --output <path>     write the JSON report to this file instead of stdout\n");
+    fprintf(stderr, "    --software          rasterize with the CPU backend instead of OpenGL\n");
+    fprintf(stderr, "    --threads <n>       threads of the software rasterizer and the entity update (default: one per CPU)\n");
+    fprintf(stderr, "    --help              print this help\n");
+    fprintf(stderr, "Scenarios:\n");
+    for (size_t i = 0; i < SCENARIOS_COUNT; ++i) {
+        fprintf(stderr, "    %-20s%s\n", scenarios[i].name, scenarios[i].description);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    int result = 0;
+#ifndef GL_NULL
+    Egl_Context ctx = {0};
+#endif
+    Framebuffer fb = {0};
+    FILE *out = stdout;
+
+    size_t frames = BENCH_DEFAULT_FRAMES;
+    size_t count = BENCH_DEFAULT_COUNT;
+    const char *only = NULL;
+    const char *output_file_path = NULL;
+
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+            frames = strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--count") == 0 && i + 1 < argc) {
+            count = strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--scenario") == 0 && i + 1 < argc) {
+            only = argv[++i];
+        } else if (strcmp(argv[i], "--output") == 0 && i + 1 < argc) {
+            output_file_path = argv[++i];
+        } else if (strcmp(argv[i], "--software") == 0) {
+            software = true;
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            threads = strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--help") == 0) {
+            usage(argv[0]);
+            return 0;
+        } else {
+            usage(argv[0]);
+            fprintf(stderr, "ERROR: unknown flag %s\n", argv[i]);
+            return 1;
+        }
+    }
+    if (frames == 0 || frames > BENCH_FRAMES_CAP) {
+        usage(argv[0]);
+        fprintf(stderr, "ERROR: frames has to be between 1 and %d\n", BENCH_FRAMES_CAP);
+        return 1;
+    }
+
+    if (!app_load_face(APP_FONT_FILE_PATH, FREE_GLYPH_FONT_SIZE, &face)) return_defer(1);
+
+    char renderer_name[128];
+    if (software) {
+        if (!softrast_init(&softrast, SCREEN_WIDTH, SCREEN_HEIGHT, threads)) return_defer(1);
+        snprintf(renderer_name, sizeof(renderer_name), "software rasterizer (%zu threads)", softrast.threads_count + 1);
+        free_glyph_atlas_build(&atlas, face);
+        softrast.atlas = &atlas;
+        renderer_init_software(&renderer, &softrast);
+    } else {
+#ifndef GL_NULL
+        if (!egl_context_init(&ctx)) return_defer(1);
+
+        glewExperimental = GL_TRUE;
+        GLenum glew_err = glewInit();
+        if (glew_err != GLEW_OK && glew_err != GLEW_ERROR_NO_GLX_DISPLAY) {
+            fprintf(stderr, "ERROR: %s\n", glewGetErrorString(glew_err));
+            return_defer(1);
+        }
+#endif
+
+        if (!framebuffer_init(&fb, SCREEN_WIDTH, SCREEN_HEIGHT)) return_defer(1);
+
+        glEnable(GL_BLEND);
+        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        glClearColor(0, 0, 0, 1);
+
+        renderer_init(&renderer);
+        free_glyph_atlas_init(&atlas, face);
+        snprintf(renderer_name, sizeof(renderer_name), "%s", glGetString(GL_RENDERER));
+    }
+
+    if (output_file_path) {
+        out = fopen(output_file_path, "w");
+        if (!out) {
+            fprintf(stderr, "ERROR: Could not open %s\n", output_file_path);
+            out = stdout;
+            return_defer(1);
+        }
+    }
+
+    size_t selected[SCENARIOS_COUNT];
+    size_t selected_count = 0;
+    for (size_t i = 0; i < SCENARIOS_COUNT; ++i) {
+        if (only == NULL || strcmp(only, scenarios[i].name) == 0) selected[selected_count++] = i;
+    }
+    bool la = only == NULL || strcmp(only, "la") == 0;
+    if (selected_count == 0 && !la) {
+        usage(argv[0]);
+        fprintf(stderr, "ERROR: unknown scenario %s\n", only);
+        return_defer(1);
+    }
+
+    fprintf(out, "{\n");
+    fprintf(out, "  \"renderer\": \"%s\",\n", renderer_name);
+    fprintf(out, "  \"resolution\": [%d, %d],\n", SCREEN_WIDTH, SCREEN_HEIGHT);
+    if (la && !run_la(out)) result = 1;
+    fprintf(out, "  \"scenarios\": [\n");
+    for (size_t i = 0; i < selected_count; ++i) {
+        if (!run_scenario(out, &scenarios[selected[i]], &fb, frames, count, i + 1 == selected_count)) result = 1;
+    }
+    fprintf(out, "  ]\n");
+    fprintf(out, "}\n");
+
+defer:
+    if (out != stdout) fclose(out);
+    if (fb.fbo) framebuffer_destroy(&fb);
+    if (softrast.pixels) softrast_destroy(&softrast);
+    if (entities.threads) entities_destroy(&entities);
+#ifndef GL_NULL
+    egl_context_destroy(&ctx);
+#endif
+    return result;
+}
@@ -0,0 +1,290 @@
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "damage.h"
+
+#define DAMAGE_FNV_OFFSET 0xcbf29ce484222325ull
+#define DAMAGE_FNV_PRIME  0x100000001b3ull
+
+static uint64_t damage_hash_u32(uint64_t h, uint32_t x)
+{
+    for (int i = 0; i < 4; ++i) {
+        h ^= (x >> (i*8)) & 0xFF;
+        h *= DAMAGE_FNV_PRIME;
+    }
+    return h;
+}
+
+static uint64_t damage_hash_f32(uint64_t h, float x)
+{
+    uint32_t bits;
+    memcpy(&bits, &x, sizeof(bits));
+    return damage_hash_u32(h, bits);
+}
+
+static uint64_t damage_hash_v4f(uint64_t h, V4f v)
+{
+    h = damage_hash_f32(h, v.x);
+    h = damage_hash_f32(h, v.y);
+    h = damage_hash_f32(h, v.z);
+    return damage_hash_f32(h, v.w);
+}
+
+static bool damage_rect_empty(Damage_Rect r)
+{
+    return r.x0 >= r.x1 || r.y0 >= r.y1;
+}
+
+static Damage_Rect damage_rect_union(Damage_Rect a, Damage_Rect b)
+{
+    return (Damage_Rect) {
+        .x0 = a.x0 < b.x0 ? a.x0 : b.x0,
+        .y0 = a.y0 < b.y0 ? a.y0 : b.y0,
+        .x1 = a.x1 > b.x1 ? a.x1 : b.x1,
+        .y1 = a.y1 > b.y1 ? a.y1 : b.y1,
+    };
+}
+
+static bool damage_rect_overlaps(Damage_Rect a, Damage_Rect b)
+{
+    return a.x0 < b.x1 && b.x0 < a.x1 && a.y0 < b.y1 && b.y0 < a.y1;
+}
+
+static double damage_rect_area(Damage_Rect r)
+{
+    return damage_rect_empty(r) ? 0.0 : (double) (r.x1 - r.x0)*(r.y1 - r.y0);
+}
+
+static void damage_remove_rect(Damage *d, size_t i)
+{
+    d->rects[i] = d->rects[--d->rects_count];
+}
+
+// Overlapping rects are merged, so no pixel is drawn twice. Past DAMAGE_RECTS_CAP the pair
+// whose union covers the least extra area is merged.
+static void damage_add(Damage *d, Damage_Rect rect)
+{
+    if (damage_rect_empty(rect)) return;
+    for (size_t i = 0; i < d->rects_count;) {
+        if (damage_rect_overlaps(d->rects[i], rect)) {
+            rect = damage_rect_union(rect, d->rects[i]);
+            damage_remove_rect(d, i);
+            i = 0;
+        } else {
+            i += 1;
+        }
+    }
+    if (d->rects_count < DAMAGE_RECTS_CAP) {
+        d->rects[d->rects_count++] = rect;
+        return;
+    }
+
+    size_t best = 0;
+    double best_cost = INFINITY;
+    for (size_t i = 0; i < d->rects_count; ++i) {
+        Damage_Rect u = damage_rect_union(d->rects[i], rect);
+        double cost = damage_rect_area(u) - damage_rect_area(d->rects[i]) - damage_rect_area(rect);
+        if (cost < best_cost) {
+            best_cost = cost;
+            best = i;
+        }
+    }
+    Damage_Rect merged = damage_rect_union(d->rects[best], rect);
+    damage_remove_rect(d, best);
+    // The union may overlap the others now
+    damage_add(d, merged);
+}
+
+static int damage_compare_primitives(const void *a, const void *b)
+{
+    uint64_t x = ((const Damage_Primitive *) a)->key;
+    uint64_t y = ((const Damage_Primitive *) b)->key;
+    return (x > y) - (x < y);
+}
+
+void damage_destroy(Damage *d)
+{
+    for (size_t i = 0; i < 2; ++i) {
+        free(d->recorded[i].primitives);
+        free(d->recorded[i].sorted);
+        free(d->recorded[i].batch_begin);
+        free(d->recorded[i].batch_bounds);
+    }
+    memset(d, 0, sizeof(*d));
+}
+
+void damage_invalidate(Damage *d)
+{
+    d->valid = false;
+}
+
+static void damage_push_primitive(Damage_Frame *f, Damage_Primitive primitive)
+{
+    if (f->primitives_count >= f->primitives_capacity) {
+        f->primitives_capacity = f->primitives_capacity == 0 ? 1024 : f->primitives_capacity*2;
+        f->primitives = realloc(f->primitives, sizeof(Damage_Primitive)*f->primitives_capacity);
+        f->sorted = realloc(f->sorted, sizeof(Damage_Primitive)*f->primitives_capacity);
+        if (f->primitives == NULL || f->sorted == NULL) {
+            fprintf(stderr, "ERROR: Could not grow damage tracking to %zu primitives\n", f->primitives_capacity);
+            exit(1);
+        }
+    }
+    f->primitives[f->primitives_count++] = primitive;
+}
+
+static void damage_collect(Damage *d, const Render_List *list)
+{
+    Damage_Frame *f = &d->recorded[d->current];
+    f->primitives_count = 0;
+    f->batches_count = list->batches_count;
+    if (list->batches_count + 1 > f->batches_capacity) {
+        free(f->batch_begin);
+        free(f->batch_bounds);
+        f->batches_capacity = list->batches_count + 1;
+        f->batch_begin = malloc(sizeof(size_t)*f->batches_capacity);
+        f->batch_bounds = malloc(sizeof(Damage_Rect)*f->batches_capacity);
+        if (f->batch_begin == NULL || f->batch_bounds == NULL) {
+            fprintf(stderr, "ERROR: Could not allocate the bounds of %zu batches\n", f->batches_capacity);
+            exit(1);
+        }
+    }
+    for (size_t b = 0; b < list->batches_count; ++b) {
+        const Render_Batch *batch = &list->batches[b];
+        const Vertex *vertices = &list->vertices[batch->vertices_begin];
+        const Material *materials = &list->materials[batch->materials_begin];
+
+        uint64_t batch_key = damage_hash_u32(DAMAGE_FNV_OFFSET, batch->texture);
+        batch_key = damage_hash_f32(batch_key, batch->resolution.x);
+        batch_key = damage_hash_f32(batch_key, batch->resolution.y);
+        f->batch_begin[b] = f->primitives_count;
+        Damage_Rect *batch_bounds = &f->batch_bounds[b];
+        *batch_bounds = (Damage_Rect) {0};
+        for (size_t i = 0; i + 3 <= batch->vertices_count; i += 3) {
+            uint64_t key = batch_key;
+            float min_x = INFINITY, min_y = INFINITY, max_x = -INFINITY, max_y = -INFINITY;
+            bool animated = false;
+            for (size_t j = 0; j < 3; ++j) {
+                const Vertex *v = &vertices[i + j];
+                key = damage_hash_f32(key, v->position.x);
+                key = damage_hash_f32(key, v->position.y);
+                key = damage_hash_v4f(key, v->color);
+                key = damage_hash_f32(key, v->uv.x);
+                key = damage_hash_f32(key, v->uv.y);
+                key = damage_hash_u32(key, v->mode);
+                key = damage_hash_v4f(key, materials[v->material].tint);
+                key = damage_hash_v4f(key, materials[v->material].params);
+                animated = animated || v->mode == SHADER_RAINBOW;
+                min_x = fminf(min_x, v->position.x);
+                min_y = fminf(min_y, v->position.y);
+                max_x = fmaxf(max_x, v->position.x);
+                max_y = fmaxf(max_y, v->position.y);
+            }
+            if (animated) key = damage_hash_f32(key, (float) batch->time);
+
+            Damage_Rect bounds = {
+                .x0 = (int) clampf(floorf(min_x), 0, d->width),
+                .y0 = (int) clampf(floorf(min_y), 0, d->height),
+                .x1 = (int) clampf(ceilf(max_x), 0, d->width),
+                .y1 = (int) clampf(ceilf(max_y), 0, d->height),
+            };
+            // Off screen triangles do not touch any pixel
+            if (damage_rect_empty(bounds)) continue;
+            *batch_bounds = damage_rect_empty(*batch_bounds) ? bounds : damage_rect_union(*batch_bounds, bounds);
+            damage_push_primitive(f, (Damage_Primitive) {.key = key, .bounds = bounds});
+        }
+    }
+    f->batch_begin[list->batches_count] = f->primitives_count;
+    memcpy(f->sorted, f->primitives, sizeof(Damage_Primitive)*f->primitives_count);
+    qsort(f->sorted, f->primitives_count, sizeof(Damage_Primitive), damage_compare_primitives);
+}
+
+// The keys of batch b of f in draw order, leaving out the ones missing from other. A batch
+// past the end hashes like an empty one.
+static uint64_t damage_order_hash(const Damage_Frame *f, size_t b, const Damage_Frame *other)
+{
+    uint64_t h = DAMAGE_FNV_OFFSET;
+    if (b >= f->batches_count) return h;
+    for (size_t i = f->batch_begin[b]; i < f->batch_begin[b + 1]; ++i) {
+        const Damage_Primitive *p = &f->primitives[i];
+        if (bsearch(p, other->sorted, other->primitives_count, sizeof(Damage_Primitive), damage_compare_primitives) == NULL) continue;
+        h = damage_hash_u32(h, (uint32_t) p->key);
+        h = damage_hash_u32(h, (uint32_t) (p->key >> 32));
+    }
+    return h;
+}
+
+static Damage_Rect damage_batch_bounds(const Damage_Frame *f, size_t b)
+{
+    return b < f->batches_count ? f->batch_bounds[b] : (Damage_Rect) {0};
+}
+
+void damage_compute(Damage *d, const Render_List *list)
+{
+    if (list->width != d->width || list->height != d->height) {
+        d->width = list->width;
+        d->height = list->height;
+        d->valid = false;
+    }
+    d->current = 1 - d->current;
+    damage_collect(d, list);
+
+    d->rects_count = 0;
+    if (!d->valid) {
+        damage_add(d, (Damage_Rect) {0, 0, d->width, d->height});
+    } else {
+        const Damage_Frame *current = &d->recorded[d->current];
+        const Damage_Frame *previous = &d->recorded[1 - d->current];
+        // Both arrays are sorted, equal keys cancel out
+        const Damage_Primitive *a = current->sorted;
+        const Damage_Primitive *b = previous->sorted;
+        size_t n = current->primitives_count;
+        size_t m = previous->primitives_count;
+        size_t i = 0, j = 0;
+        while (i < n || j < m) {
+            if (j >= m || (i < n && a[i].key < b[j].key)) {
+                damage_add(d, a[i++].bounds);
+            } else if (i >= n || b[j].key < a[i].key) {
+                damage_add(d, b[j++].bounds);
+            } else {
+                i += 1;
+                j += 1;
+            }
+        }
+
+        size_t batches = current->batches_count > previous->batches_count ? current->batches_count : previous->batches_count;
+        for (size_t k = 0; k < batches; ++k) {
+            if (damage_order_hash(current, k, previous) != damage_order_hash(previous, k, current)) {
+                damage_add(d, damage_batch_bounds(current, k));
+                damage_add(d, damage_batch_bounds(previous, k));
+            }
+        }
+    }
+    d->valid = true;
+
+    double damaged = 0.0;
+    for (size_t i = 0; i < d->rects_count; ++i) damaged += damage_rect_area(d->rects[i]);
+    if (d->width > 0 && d->height > 0) d->damaged_fraction += damaged/((double) d->width*d->height);
+    d->frames += 1;
+}
+
+void damage_draw(const Damage *d, const Render_List *list, Renderer *r, V4f clear_color)
+{
+    for (size_t i = 0; i < d->rects_count; ++i) {
+        Damage_Rect rect = d->rects[i];
+        renderer_set_scissor(r, rect.x0, rect.y0, rect.x1 - rect.x0, rect.y1 - rect.y0);
+        renderer_clear(r, clear_color);
+        for (size_t b = 0; b < list->batches_count; ++b) {
+            if (damage_rect_overlaps(d->recorded[d->current].batch_bounds[b], rect)) render_list_draw_batch(list, b, r);
+        }
+    }
+    renderer_reset_scissor(r);
+    renderer_end_frame(r);
+}
+
+void damage_report(const Damage *d, FILE *stream)
+{
+    if (d->frames == 0) return;
+    fprintf(stream, "Damage: %.2f%% of the pixels redrawn per frame on average over %zu frames\n",
+            d->damaged_fraction/d->frames*100.0, d->frames);
+}
@@ -0,0 +1,78 @@
+#ifndef DAMAGE_H_
+#define DAMAGE_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "renderer.h"
+#include "render_list.h"
+
+// Partial redraw into a retained color buffer. Every triangle of a recorded frame is reduced
+// to a hash of everything that decides its pixels (vertices, material, texture and, for the
+// time dependent rainbow shader, the time) and its bounding box. Triangles without a match
+// in the previous frame, and the ones that disappeared since, damage their bounding box.
+// damage_draw clears and redraws only the damaged rectangles under scissor, everything
+// else keeps the pixels of the previous frame. Batches whose triangles lie entirely
+// outside of a rectangle are not drawn for it.
+//
+// Blending makes the order matter too. For every batch the triangles that exist in both
+// frames are hashed in draw order, a batch whose order hash differs from the one with the
+// same index in the previous frame damages its bounds in both frames. Batches are matched
+// by index, so inserting a batch damages the ones after it.
+
+#define DAMAGE_RECTS_CAP 4
+
+// Pixels with the origin in the bottom left like glScissor, end exclusive
+typedef struct {
+    int x0, y0;
+    int x1, y1;
+} Damage_Rect;
+
+typedef struct {
+    uint64_t key;
+    Damage_Rect bounds;
+} Damage_Primitive;
+
+typedef struct {
+    Damage_Primitive *primitives; // In draw order
+    Damage_Primitive *sorted;     // By key
+    size_t primitives_count;
+    size_t primitives_capacity;
+    // Per batch the index of its first primitive (one past the last batch too) and the
+    // union of their bounds, empty when the batch does not touch the screen
+    size_t *batch_begin;
+    Damage_Rect *batch_bounds;
+    size_t batches_count;
+    size_t batches_capacity;
+} Damage_Frame;
+
+typedef struct {
+    // The current and the previous frame
+    Damage_Frame recorded[2];
+    size_t current;
+
+    int width;
+    int height;
+    bool valid; // The retained buffer holds the previous frame
+    // Regions to redraw in the current frame, disjoint
+    Damage_Rect rects[DAMAGE_RECTS_CAP];
+    size_t rects_count;
+
+    size_t frames;
+    double damaged_fraction; // Sum over all frames
+} Damage;
+
+void damage_destroy(Damage *d);
+// The retained buffer was lost or resized, or something the primitives do not capture
+// changed (e.g. the contents of a texture), the next frame redraws everything
+void damage_invalidate(Damage *d);
+// Compares the frame recorded in list with the previous one and collects the damaged rects
+void damage_compute(Damage *d, const Render_List *list);
+// Redraws the damaged rects of list, the one of the last damage_compute, with r into the
+// bound retained buffer, ends the frame of r
+void damage_draw(const Damage *d, const Render_List *list, Renderer *r, V4f clear_color);
+void damage_report(const Damage *d, FILE *stream);
+
+#endif  // DAMAGE_H_
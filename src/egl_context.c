@@ -0,0 +1,85 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "egl_context.h"
+#include <EGL/eglext.h>
+
+static EGLDisplay egl_get_display(void)
+{
+    const char *extensions = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+    if (extensions && strstr(extensions, "EGL_MESA_platform_surfaceless")) {
+        PFNEGLGETPLATFORMDISPLAYEXTPROC get_platform_display =
+            (PFNEGLGETPLATFORMDISPLAYEXTPROC) eglGetProcAddress("eglGetPlatformDisplayEXT");
+        if (get_platform_display) {
+            EGLDisplay display = get_platform_display(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, NULL);
+            if (display != EGL_NO_DISPLAY) return display;
+        }
+    }
+    return eglGetDisplay(EGL_DEFAULT_DISPLAY);
+}
+
+bool egl_context_init(Egl_Context *ctx)
+{
+    ctx->display = egl_get_display();
+    if (ctx->display == EGL_NO_DISPLAY) {
+        fprintf(stderr, "ERROR: Could not get an EGL display\n");
+        return false;
+    }
+
+    EGLint major, minor;
+    if (!eglInitialize(ctx->display, &major, &minor)) {
+        fprintf(stderr, "ERROR: Could not initialize EGL: 0x%x\n", eglGetError());
+        return false;
+    }
+
+    const char *extensions = eglQueryString(ctx->display, EGL_EXTENSIONS);
+    if (!extensions || !strstr(extensions, "EGL_KHR_surfaceless_context")) {
+        fprintf(stderr, "ERROR: EGL %d.%d does not support surfaceless contexts\n", major, minor);
+        return false;
+    }
+
+    if (!eglBindAPI(EGL_OPENGL_API)) {
+        fprintf(stderr, "ERROR: EGL does not support desktop OpenGL\n");
+        return false;
+    }
+
+    EGLConfig config = EGL_NO_CONFIG_KHR;
+    if (!strstr(extensions, "EGL_KHR_no_config_context")) {
+        const EGLint config_attribs[] = {
+            EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+            EGL_NONE,
+        };
+        EGLint configs_count = 0;
+        if (!eglChooseConfig(ctx->display, config_attribs, &config, 1, &configs_count) || configs_count == 0) {
+            fprintf(stderr, "ERROR: Could not find an EGL config for OpenGL\n");
+            return false;
+        }
+    }
+
+    const EGLint context_attribs[] = {
+        EGL_CONTEXT_MAJOR_VERSION, 3,
+        EGL_CONTEXT_MINOR_VERSION, 3,
+        EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+        EGL_NONE,
+    };
+    ctx->context = eglCreateContext(ctx->display, config, EGL_NO_CONTEXT, context_attribs);
+    if (ctx->context == EGL_NO_CONTEXT) {
+        fprintf(stderr, "ERROR: Could not create an OpenGL 3.3 context: 0x%x\n", eglGetError());
+        return false;
+    }
+
+    if (!eglMakeCurrent(ctx->display, EGL_NO_SURFACE, EGL_NO_SURFACE, ctx->context)) {
+        fprintf(stderr, "ERROR: Could not make the EGL context current: 0x%x\n", eglGetError());
+        return false;
+    }
+
+    return true;
+}
+
+void egl_context_destroy(Egl_Context *ctx)
+{
+    if (ctx->display == EGL_NO_DISPLAY) return;
+    eglMakeCurrent(ctx->display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    if (ctx->context != EGL_NO_CONTEXT) eglDestroyContext(ctx->display, ctx->context);
+    eglTerminate(ctx->display);
+}
@@ -0,0 +1,18 @@
+#ifndef EGL_CONTEXT_H_
+#define EGL_CONTEXT_H_
+
+#include <stdbool.h>
+#include <EGL/egl.h>
+
+// OpenGL 3.3 core context without any window or display server. Uses the surfaceless Mesa
+// platform when available (llvmpipe works on machines without a GPU) and falls back to the
+// default EGL display otherwise. Rendering has to go into a Framebuffer.
+typedef struct {
+    EGLDisplay display;
+    EGLContext context;
+} Egl_Context;
+
+bool egl_context_init(Egl_Context *ctx);
+void egl_context_destroy(Egl_Context *ctx);
+
+#endif  // EGL_CONTEXT_H_
@@ -0,0 +1,282 @@
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "entities.h"
+
+#define PI 3.14159265358979323846f
+
+static void *entities_worker(void *arg);
+
+bool entities_init(Entities *e, size_t threads)
+{
+    memset(e, 0, sizeof(*e));
+    if (threads == 0) {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        threads = cpus > 0 ? (size_t) cpus : 1;
+    }
+    // Before the synchronization objects, so a failure has nothing to clean up
+    e->threads = malloc(sizeof(*e->threads) * threads);
+    if (e->threads == NULL) {
+        fprintf(stderr, "ERROR: Could not allocate %zu entity threads\n", threads);
+        return false;
+    }
+    pthread_mutex_init(&e->mutex, NULL);
+    pthread_cond_init(&e->work_cond, NULL);
+    pthread_cond_init(&e->done_cond, NULL);
+    for (size_t i = 0; i + 1 < threads; ++i) {
+        if (pthread_create(&e->threads[i], NULL, entities_worker, e) != 0) {
+            fprintf(stderr, "WARNING: Could only start %zu entity threads\n", i + 1);
+            break;
+        }
+        e->threads_count += 1;
+    }
+    return true;
+}
+
+static void entities_free_fields(Entities *e)
+{
+    free(e->x);
+    free(e->y);
+    free(e->prev_x);
+    free(e->prev_y);
+    free(e->vx);
+    free(e->vy);
+    free(e->half_w);
+    free(e->half_h);
+    free(e->color);
+}
+
+void entities_destroy(Entities *e)
+{
+    pthread_mutex_lock(&e->mutex);
+    e->quit = true;
+    pthread_cond_broadcast(&e->work_cond);
+    pthread_mutex_unlock(&e->mutex);
+    for (size_t i = 0; i < e->threads_count; ++i) {
+        pthread_join(e->threads[i], NULL);
+    }
+    pthread_cond_destroy(&e->done_cond);
+    pthread_cond_destroy(&e->work_cond);
+    pthread_mutex_destroy(&e->mutex);
+
+    entities_free_fields(e);
+    free(e->threads);
+    memset(e, 0, sizeof(*e));
+}
+
+// xorshift32, never returns 0 for a seed other than 0
+static unsigned int entities_random(unsigned int *state)
+{
+    unsigned int x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return x;
+}
+
+// Uniform in [lo, hi)
+static float entities_random_range(unsigned int *state, float lo, float hi)
+{
+    return lo + (hi - lo)*(float) (entities_random(state) >> 8)/(float) (1 << 24);
+}
+
+bool entities_spawn(Entities *e, size_t count, V2f size, unsigned int seed)
+{
+    if (count > e->capacity) {
+        entities_free_fields(e);
+        e->x      = malloc(sizeof(*e->x)*count);
+        e->y      = malloc(sizeof(*e->y)*count);
+        e->prev_x = malloc(sizeof(*e->prev_x)*count);
+        e->prev_y = malloc(sizeof(*e->prev_y)*count);
+        e->vx     = malloc(sizeof(*e->vx)*count);
+        e->vy     = malloc(sizeof(*e->vy)*count);
+        e->half_w = malloc(sizeof(*e->half_w)*count);
+        e->half_h = malloc(sizeof(*e->half_h)*count);
+        e->color  = malloc(sizeof(*e->color)*count);
+        if (!e->x || !e->y || !e->prev_x || !e->prev_y || !e->vx || !e->vy ||
+            !e->half_w || !e->half_h || !e->color) {
+            fprintf(stderr, "ERROR: Could not allocate %zu entities\n", count);
+            entities_free_fields(e);
+            e->x = e->y = e->prev_x = e->prev_y = e->vx = e->vy = e->half_w = e->half_h = NULL;
+            e->color = NULL;
+            e->count = 0;
+            e->capacity = 0;
+            return false;
+        }
+        e->capacity = count;
+    }
+
+    unsigned int state = seed != 0 ? seed : 1;
+    for (size_t i = 0; i < count; ++i) {
+        e->half_w[i] = entities_random_range(&state, 1.0f, 3.0f);
+        e->half_h[i] = entities_random_range(&state, 1.0f, 3.0f);
+        e->x[i] = entities_random_range(&state, e->half_w[i], fmaxf(e->half_w[i], size.x - e->half_w[i]));
+        e->y[i] = entities_random_range(&state, e->half_h[i], fmaxf(e->half_h[i], size.y - e->half_h[i]));
+        e->prev_x[i] = e->x[i];
+        e->prev_y[i] = e->y[i];
+        float angle = entities_random_range(&state, 0.0f, 2.0f*PI);
+        float speed = entities_random_range(&state, 0.5f, 3.0f);
+        e->vx[i] = cosf(angle)*speed;
+        e->vy[i] = sinf(angle)*speed;
+        e->color[i] = v4f(entities_random_range(&state, 0.2f, 1.0f),
+                          entities_random_range(&state, 0.2f, 1.0f),
+                          entities_random_range(&state, 0.2f, 1.0f),
+                          1.0f);
+    }
+    e->count = count;
+    e->size = size;
+    return true;
+}
+
+// Points vel away from the walls at lo and hi it touches, the low wall wins when the
+// entity touches both. Unlike the flip of app_update the result does not depend on the
+// previous direction, so an entity that ended up outside after a resize comes back.
+static void entities_bounce(float *vel, const float *pos, const float *half, float lo, float hi, size_t n)
+{
+    size_t i = 0;
+#ifdef LA_SIMD
+    La_F4 lo4 = la_f4_set1(lo);
+    La_F4 hi4 = la_f4_set1(hi);
+    La_I4 sign = la_i4_set1((int) 0x80000000u);
+    La_I4 magnitude = la_i4_set1(0x7fffffff);
+    for (; i + 4 <= n; i += 4) {
+        La_F4 p = la_f4_loadu(pos + i);
+        La_F4 h = la_f4_loadu(half + i);
+        La_I4 v = la_f4_as_i4(la_f4_loadu(vel + i));
+        La_F4 positive = la_i4_as_f4(la_i4_and(v, magnitude));
+        La_F4 negative = la_i4_as_f4(la_i4_or(v, sign));
+        La_F4 result = la_f4_select(la_f4_gt(hi4, la_f4_add(p, h)), la_i4_as_f4(v), negative);
+        result = la_f4_select(la_f4_gt(la_f4_sub(p, h), lo4), result, positive);
+        la_f4_store(vel + i, result);
+    }
+#endif // LA_SIMD
+    for (; i < n; ++i) {
+        float v = vel[i];
+        if (!(hi > pos[i] + half[i])) v = -fabsf(v);
+        if (!(pos[i] - half[i] > lo)) v = fabsf(v);
+        vel[i] = v;
+    }
+}
+
+static void entities_update_chunk(Entities *e, size_t begin, size_t end)
+{
+    size_t n = end - begin;
+    memcpy(e->prev_x + begin, e->x + begin, sizeof(float)*n);
+    memcpy(e->prev_y + begin, e->y + begin, sizeof(float)*n);
+    if (e->clamp) {
+        // Like app_resize, or the slow ones would take many steps to come back
+        for (size_t i = begin; i < end; ++i) {
+            e->x[i] = clampf(e->x[i], e->half_w[i], fmaxf(e->half_w[i], e->size.x - e->half_w[i]));
+            e->y[i] = clampf(e->y[i], e->half_h[i], fmaxf(e->half_h[i], e->size.y - e->half_h[i]));
+        }
+    }
+    spanf_sum(e->x + begin, e->x + begin, e->vx + begin, n);
+    spanf_sum(e->y + begin, e->y + begin, e->vy + begin, n);
+    entities_bounce(e->vx + begin, e->x + begin, e->half_w + begin, 0.0f, e->size.x, n);
+    entities_bounce(e->vy + begin, e->y + begin, e->half_h + begin, 0.0f, e->size.y, n);
+}
+
+static void entities_update_chunks(Entities *e)
+{
+    for (;;) {
+        size_t begin = atomic_fetch_add(&e->next_chunk, ENTITIES_CHUNK);
+        if (begin >= e->count) break;
+        size_t end = begin + ENTITIES_CHUNK < e->count ? begin + ENTITIES_CHUNK : e->count;
+        entities_update_chunk(e, begin, end);
+    }
+}
+
+static void *entities_worker(void *arg)
+{
+    Entities *e = arg;
+    size_t generation = 0;
+    for (;;) {
+        pthread_mutex_lock(&e->mutex);
+        while (e->generation == generation && !e->quit) {
+            pthread_cond_wait(&e->work_cond, &e->mutex);
+        }
+        if (e->quit) {
+            pthread_mutex_unlock(&e->mutex);
+            return NULL;
+        }
+        generation = e->generation;
+        pthread_mutex_unlock(&e->mutex);
+
+        entities_update_chunks(e);
+
+        pthread_mutex_lock(&e->mutex);
+        e->workers_busy -= 1;
+        if (e->workers_busy == 0) pthread_cond_signal(&e->done_cond);
+        pthread_mutex_unlock(&e->mutex);
+    }
+}
+
+void entities_update(Entities *e, V2f size, bool paused)
+{
+    if (e->count == 0) return;
+    if (paused) {
+        memcpy(e->prev_x, e->x, sizeof(float)*e->count);
+        memcpy(e->prev_y, e->y, sizeof(float)*e->count);
+        return;
+    }
+    e->clamp = size.x < e->size.x || size.y < e->size.y;
+    e->size = size;
+    atomic_store(&e->next_chunk, 0);
+    // Waking the workers costs more than a single chunk
+    bool parallel = e->threads_count > 0 && e->count > ENTITIES_CHUNK;
+    if (parallel) {
+        pthread_mutex_lock(&e->mutex);
+        e->generation += 1;
+        e->workers_busy = e->threads_count;
+        pthread_cond_broadcast(&e->work_cond);
+        pthread_mutex_unlock(&e->mutex);
+    }
+
+    entities_update_chunks(e);
+
+    if (parallel) {
+        pthread_mutex_lock(&e->mutex);
+        while (e->workers_busy > 0) {
+            pthread_cond_wait(&e->done_cond, &e->mutex);
+        }
+        pthread_mutex_unlock(&e->mutex);
+    }
+}
+
+// Rects per renderer_reserve, the batch takes 6 vertices per rect
+#define ENTITIES_RENDER_BATCH (VERTICES_CAP/6)
+
+void entities_render(const Entities *e, Renderer *r, float alpha, float scale)
+{
+    GLuint mode = r->current_shader;
+    V2f uv = v2f(0, 0);
+    for (size_t begin = 0; begin < e->count; begin += ENTITIES_RENDER_BATCH) {
+        size_t n = e->count - begin < ENTITIES_RENDER_BATCH ? e->count - begin : ENTITIES_RENDER_BATCH;
+        Vertex *v = renderer_reserve(r, 6*n);
+        // After the reserve, which may have flushed and moved the current material to 0
+        GLuint material = r->current_material;
+        for (size_t i = begin; i < begin + n; ++i) {
+            // The same corners as renderer_rect_center
+            float w = 2.0f*e->half_w[i]*scale;
+            float h = 2.0f*e->half_h[i]*scale;
+            float x0 = lerpf(e->prev_x[i], e->x[i], alpha)*scale - w/2;
+            float y0 = lerpf(e->prev_y[i], e->y[i], alpha)*scale - h/2;
+            V2f p0 = v2f(x0, y0);
+            V2f p1 = v2f(x0 + w, y0);
+            V2f p2 = v2f(x0, y0 + h);
+            V2f p3 = v2f(x0 + w, y0 + h);
+            V4f c = e->color[i];
+            v[0] = (Vertex) {.position = p0, .color = c, .uv = uv, .mode = mode, .material = material};
+            v[1] = (Vertex) {.position = p1, .color = c, .uv = uv, .mode = mode, .material = material};
+            v[2] = (Vertex) {.position = p2, .color = c, .uv = uv, .mode = mode, .material = material};
+            v[3] = (Vertex) {.position = p1, .color = c, .uv = uv, .mode = mode, .material = material};
+            v[4] = (Vertex) {.position = p2, .color = c, .uv = uv, .mode = mode, .material = material};
+            v[5] = (Vertex) {.position = p3, .color = c, .uv = uv, .mode = mode, .material = material};
+            v += 6;
+        }
+    }
+}
@@ -0,0 +1,62 @@
+#ifndef ENTITIES_H_
+#define ENTITIES_H_
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "renderer.h"
+
+// Mass simulation of solid rects that bounce off the walls like the rect of the demo scene.
+// Every field is its own array (structure of arrays), so the update streams through the
+// floats 4 at a time with the la.h SIMD backend: spanf_sum integrates the positions and
+// a branchless kernel turns the velocities around at the walls. The entities are updated
+// in ENTITIES_CHUNK pieces, which the calling thread and the workers take turns on.
+// entities_render writes the vertices straight into the batch of the renderer.
+
+#define ENTITIES_CHUNK 4096
+
+typedef struct {
+    // Centers and velocities in logical units, velocities per simulation step
+    float *x;
+    float *y;
+    float *prev_x; // Before the last step, rendering interpolates from here
+    float *prev_y;
+    float *vx;
+    float *vy;
+    float *half_w;
+    float *half_h;
+    V4f *color;
+    size_t count;
+    size_t capacity;
+
+    // The step that is currently computed
+    V2f size;
+    bool clamp; // The walls moved inwards, entities outside are moved back in first
+
+    // Worker threads, the calling thread updates chunks as well
+    pthread_t *threads;
+    size_t threads_count;
+    pthread_mutex_t mutex;
+    pthread_cond_t work_cond;
+    pthread_cond_t done_cond;
+    size_t generation;
+    size_t workers_busy;
+    bool quit;
+    atomic_size_t next_chunk;
+} Entities;
+
+// threads is the total amount of updating threads, 0 uses one per online CPU
+bool entities_init(Entities *e, size_t threads);
+void entities_destroy(Entities *e);
+// Replaces the entities with count new ones at random places inside of size, the same
+// seed gives the same entities
+bool entities_spawn(Entities *e, size_t count, V2f size, unsigned int seed);
+// One fixed simulation step inside of the walls at 0 and size, like app_update
+void entities_update(Entities *e, V2f size, bool paused);
+// Appends the rects with the current shader and material of r, positions are blended with
+// alpha and multiplied by scale. The transforms of r are not applied.
+void entities_render(const Entities *e, Renderer *r, float alpha, float scale);
+
+#endif  // ENTITIES_H_
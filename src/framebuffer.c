@@ -0,0 +1,93 @@
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "framebuffer.h"
+#include "gpu_memory.h"
+
+bool framebuffer_init(Framebuffer *fb, int width, int height)
+{
+    fb->width = width;
+    fb->height = height;
+
+    glGenTextures(1, &fb->color);
+    glBindTexture(GL_TEXTURE_2D, fb->color);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+    gpu_memory_track_texture(fb->color, "framebuffer color", GL_RGBA8, width, height);
+
+    glGenFramebuffers(1, &fb->fbo);
+    glBindFramebuffer(GL_FRAMEBUFFER, fb->fbo);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, fb->color, 0);
+
+    GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+    if (status != GL_FRAMEBUFFER_COMPLETE) {
+        fprintf(stderr, "ERROR: Framebuffer %dx%d is incomplete: 0x%x\n", width, height, status);
+        framebuffer_destroy(fb);
+        return false;
+    }
+
+    return true;
+}
+
+void framebuffer_destroy(Framebuffer *fb)
+{
+    glDeleteFramebuffers(1, &fb->fbo);
+    glDeleteTextures(1, &fb->color);
+    gpu_memory_untrack(GPU_RESOURCE_TEXTURE, fb->color);
+    fb->fbo = 0;
+    fb->color = 0;
+}
+
+void framebuffer_bind(Framebuffer *fb)
+{
+    glBindFramebuffer(GL_FRAMEBUFFER, fb->fbo);
+    glViewport(0, 0, fb->width, fb->height);
+}
+
+bool framebuffer_read_rgb(Framebuffer *fb, unsigned char *pixels)
+{
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, fb->fbo);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, fb->width, fb->height, GL_RGB, GL_UNSIGNED_BYTE, pixels);
+
+    // OpenGL stores the bottom row first
+    size_t stride = (size_t) fb->width * 3;
+    unsigned char *row = malloc(stride);
+    if (!row) {
+        fprintf(stderr, "ERROR: Could not allocate a row of %zu bytes\n", stride);
+        return false;
+    }
+    for (int y = 0; y < fb->height/2; ++y) {
+        unsigned char *top = pixels + (size_t) y * stride;
+        unsigned char *bottom = pixels + (size_t) (fb->height - 1 - y) * stride;
+        memcpy(row, top, stride);
+        memcpy(top, bottom, stride);
+        memcpy(bottom, row, stride);
+    }
+    free(row);
+    return true;
+}
+
+Errno framebuffer_save_ppm(Framebuffer *fb, const char *file_path)
+{
+    Errno result = 0;
+    FILE *f = NULL;
+    size_t size = (size_t) fb->width * fb->height * 3;
+    unsigned char *pixels = malloc(size);
+    if (!pixels) return_defer(ENOMEM);
+
+    if (!framebuffer_read_rgb(fb, pixels)) return_defer(ENOMEM);
+
+    f = fopen(file_path, "wb");
+    if (!f) return_defer(errno);
+    fprintf(f, "P6\n%d %d\n255\n", fb->width, fb->height);
+    if (fwrite(pixels, size, 1, f) != 1) return_defer(errno);
+
+defer:
+    if (f) fclose(f);
+    free(pixels);
+    return result;
+}
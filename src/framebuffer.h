@@ -0,0 +1,25 @@
+#ifndef FRAMEBUFFER_H_
+#define FRAMEBUFFER_H_
+
+#include <stdbool.h>
+#include "gl.h"
+
+#include "common.h"
+
+// Offscreen RGBA8 color target
+typedef struct {
+    GLuint fbo;
+    GLuint color;
+    int width;
+    int height;
+} Framebuffer;
+
+bool framebuffer_init(Framebuffer *fb, int width, int height);
+void framebuffer_destroy(Framebuffer *fb);
+void framebuffer_bind(Framebuffer *fb);
+// Reads the framebuffer back as top-down RGB rows, pixels has to hold width*height*3 bytes.
+// Fails when the temporary row could not be allocated.
+bool framebuffer_read_rgb(Framebuffer *fb, unsigned char *pixels);
+Errno framebuffer_save_ppm(Framebuffer *fb, const char *file_path);
+
+#endif  // FRAMEBUFFER_H_
@@ -0,0 +1,13 @@
+#ifndef GL_H_
+#define GL_H_
+
+// Every OpenGL entry point of the renderer goes through this header. Building with GL_NULL
+// replaces them with the no-op implementation of gl_null.c that only records what would
+// have been sent to the driver.
+#ifdef GL_NULL
+#include "gl_null.h"
+#else
+#include <GL/glew.h>
+#endif
+
+#endif  // GL_H_
@@ -0,0 +1,785 @@
+#include <assert.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "gl_null.h"
+
+Gl_Null_Stats gl_null_stats = {0};
+
+static_assert(COUNT_GL_NULL_CALLS == 64, "Update the names of the calls accordingly");
+static const char *gl_null_call_names[COUNT_GL_NULL_CALLS] = {
+    [GL_NULL_ACTIVE_TEXTURE] = "glActiveTexture",
+    [GL_NULL_ATTACH_SHADER] = "glAttachShader",
+    [GL_NULL_BEGIN_QUERY] = "glBeginQuery",
+    [GL_NULL_BIND_ATTRIB_LOCATION] = "glBindAttribLocation",
+    [GL_NULL_BIND_BUFFER] = "glBindBuffer",
+    [GL_NULL_BIND_BUFFER_BASE] = "glBindBufferBase",
+    [GL_NULL_BIND_FRAMEBUFFER] = "glBindFramebuffer",
+    [GL_NULL_BIND_TEXTURE] = "glBindTexture",
+    [GL_NULL_BIND_VERTEX_ARRAY] = "glBindVertexArray",
+    [GL_NULL_BLEND_FUNC] = "glBlendFunc",
+    [GL_NULL_BUFFER_DATA] = "glBufferData",
+    [GL_NULL_BUFFER_SUB_DATA] = "glBufferSubData",
+    [GL_NULL_CHECK_FRAMEBUFFER_STATUS] = "glCheckFramebufferStatus",
+    [GL_NULL_CLEAR] = "glClear",
+    [GL_NULL_CLEAR_COLOR] = "glClearColor",
+    [GL_NULL_COMPILE_SHADER] = "glCompileShader",
+    [GL_NULL_CREATE_PROGRAM] = "glCreateProgram",
+    [GL_NULL_CREATE_SHADER] = "glCreateShader",
+    [GL_NULL_DELETE_FRAMEBUFFERS] = "glDeleteFramebuffers",
+    [GL_NULL_DELETE_SHADER] = "glDeleteShader",
+    [GL_NULL_DELETE_TEXTURES] = "glDeleteTextures",
+    [GL_NULL_DETACH_SHADER] = "glDetachShader",
+    [GL_NULL_DISABLE] = "glDisable",
+    [GL_NULL_DRAW_ARRAYS] = "glDrawArrays",
+    [GL_NULL_ENABLE] = "glEnable",
+    [GL_NULL_ENABLE_VERTEX_ATTRIB_ARRAY] = "glEnableVertexAttribArray",
+    [GL_NULL_END_QUERY] = "glEndQuery",
+    [GL_NULL_FINISH] = "glFinish",
+    [GL_NULL_FRAMEBUFFER_TEXTURE_2D] = "glFramebufferTexture2D",
+    [GL_NULL_GEN_BUFFERS] = "glGenBuffers",
+    [GL_NULL_GEN_FRAMEBUFFERS] = "glGenFramebuffers",
+    [GL_NULL_GEN_QUERIES] = "glGenQueries",
+    [GL_NULL_GEN_TEXTURES] = "glGenTextures",
+    [GL_NULL_GEN_VERTEX_ARRAYS] = "glGenVertexArrays",
+    [GL_NULL_GET_ACTIVE_ATTRIB] = "glGetActiveAttrib",
+    [GL_NULL_GET_ACTIVE_UNIFORM] = "glGetActiveUniform",
+    [GL_NULL_GET_ACTIVE_UNIFORMSIV] = "glGetActiveUniformsiv",
+    [GL_NULL_GET_ATTRIB_LOCATION] = "glGetAttribLocation",
+    [GL_NULL_GET_INTEGERV] = "glGetIntegerv",
+    [GL_NULL_GET_PROGRAM_INFO_LOG] = "glGetProgramInfoLog",
+    [GL_NULL_GET_PROGRAMIV] = "glGetProgramiv",
+    [GL_NULL_GET_QUERY_OBJECTUI64V] = "glGetQueryObjectui64v",
+    [GL_NULL_GET_SHADER_INFO_LOG] = "glGetShaderInfoLog",
+    [GL_NULL_GET_SHADERIV] = "glGetShaderiv",
+    [GL_NULL_GET_STRING] = "glGetString",
+    [GL_NULL_GET_UNIFORM_BLOCK_INDEX] = "glGetUniformBlockIndex",
+    [GL_NULL_GET_UNIFORM_LOCATION] = "glGetUniformLocation",
+    [GL_NULL_LINK_PROGRAM] = "glLinkProgram",
+    [GL_NULL_PIXEL_STOREI] = "glPixelStorei",
+    [GL_NULL_READ_PIXELS] = "glReadPixels",
+    [GL_NULL_SCISSOR] = "glScissor",
+    [GL_NULL_SHADER_SOURCE] = "glShaderSource",
+    [GL_NULL_TEX_IMAGE_2D] = "glTexImage2D",
+    [GL_NULL_TEX_PARAMETERI] = "glTexParameteri",
+    [GL_NULL_TEX_SUB_IMAGE_2D] = "glTexSubImage2D",
+    [GL_NULL_UNIFORM1F] = "glUniform1f",
+    [GL_NULL_UNIFORM1I] = "glUniform1i",
+    [GL_NULL_UNIFORM2F] = "glUniform2f",
+    [GL_NULL_UNIFORM2FV] = "glUniform2fv",
+    [GL_NULL_UNIFORM_BLOCK_BINDING] = "glUniformBlockBinding",
+    [GL_NULL_USE_PROGRAM] = "glUseProgram",
+    [GL_NULL_VERTEX_ATTRIB_I_POINTER] = "glVertexAttribIPointer",
+    [GL_NULL_VERTEX_ATTRIB_POINTER] = "glVertexAttribPointer",
+    [GL_NULL_VIEWPORT] = "glViewport",
+};
+
+const char *gl_null_call_name(Gl_Null_Call call)
+{
+    return gl_null_call_names[call];
+}
+
+void gl_null_reset_stats(void)
+{
+    memset(&gl_null_stats, 0, sizeof(gl_null_stats));
+}
+
+// Object names handed out by the Gen/Create functions, 0 is never a valid name
+static GLuint gl_null_next_name = 1;
+
+static void gl_null_gen(GLsizei n, GLuint *names)
+{
+    for (GLsizei i = 0; i < n; ++i) {
+        names[i] = gl_null_next_name++;
+    }
+}
+
+// Shaders are never compiled, but the uniforms of their source are collected, so the
+// renderer finds the same uniforms and makes the same glUniform* calls as with a driver.
+// A uniform counts as active when its name appears again after the declaration, like a
+// compiler drops the unused ones. Array sizes are not evaluated and reported as 1.
+
+#define GL_NULL_UNIFORMS_CAP 16
+#define GL_NULL_SHADERS_CAP  16
+#define GL_NULL_PROGRAMS_CAP 16
+#define GL_NULL_NAME_CAP     64
+
+typedef struct {
+    char name[GL_NULL_NAME_CAP];
+    GLenum type;
+    bool array;
+    bool used;
+} Gl_Null_Uniform;
+
+typedef struct {
+    GLuint name; // 0 for a free slot
+    Gl_Null_Uniform uniforms[GL_NULL_UNIFORMS_CAP];
+    size_t uniforms_count;
+} Gl_Null_Shader;
+
+typedef struct {
+    GLuint name; // 0 for a free slot
+    GLuint shaders[2];
+    size_t shaders_count;
+    // Active uniforms after linking, the location of a uniform is its index
+    Gl_Null_Uniform uniforms[GL_NULL_UNIFORMS_CAP];
+    size_t uniforms_count;
+} Gl_Null_Program;
+
+static Gl_Null_Shader gl_null_shaders[GL_NULL_SHADERS_CAP];
+static Gl_Null_Program gl_null_programs[GL_NULL_PROGRAMS_CAP];
+
+static Gl_Null_Shader *gl_null_find_shader(GLuint name)
+{
+    for (size_t i = 0; i < GL_NULL_SHADERS_CAP; ++i) {
+        if (gl_null_shaders[i].name == name) return &gl_null_shaders[i];
+    }
+    return NULL;
+}
+
+static Gl_Null_Program *gl_null_find_program(GLuint name)
+{
+    for (size_t i = 0; i < GL_NULL_PROGRAMS_CAP; ++i) {
+        if (gl_null_programs[i].name == name) return &gl_null_programs[i];
+    }
+    return NULL;
+}
+
+static GLenum gl_null_glsl_type(const char *type)
+{
+    static const struct { const char *name; GLenum type; } types[] = {
+        {"float", GL_FLOAT},
+        {"vec2", GL_FLOAT_VEC2},
+        {"vec3", GL_FLOAT_VEC3},
+        {"vec4", GL_FLOAT_VEC4},
+        {"int", GL_INT},
+        {"uint", GL_UNSIGNED_INT},
+        {"mat3", GL_FLOAT_MAT3},
+        {"mat4", GL_FLOAT_MAT4},
+        {"sampler2D", GL_SAMPLER_2D},
+    };
+    for (size_t i = 0; i < sizeof(types)/sizeof(types[0]); ++i) {
+        if (strcmp(types[i].name, type) == 0) return types[i].type;
+    }
+    return 0;
+}
+
+static bool gl_null_is_ident(char c, bool first)
+{
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_' || (!first && c >= '0' && c <= '9');
+}
+
+// Next identifier or single character token of the source, skipping white space,
+// comments and preprocessor lines. Returns false at the end of the source.
+static bool gl_null_next_token(const char **source, char token[GL_NULL_NAME_CAP])
+{
+    const char *s = *source;
+    for (;;) {
+        while (*s == ' ' || *s == '\t' || *s == '\n' || *s == '\r') ++s;
+        if (s[0] == '/' && s[1] == '/') {
+            while (*s && *s != '\n') ++s;
+        } else if (s[0] == '/' && s[1] == '*') {
+            s += 2;
+            while (*s && !(s[0] == '*' && s[1] == '/')) ++s;
+            if (*s) s += 2;
+        } else if (*s == '#') {
+            while (*s && *s != '\n') ++s;
+        } else {
+            break;
+        }
+    }
+    if (*s == '\0') return false;
+
+    size_t n = 1;
+    if (gl_null_is_ident(*s, true)) {
+        while (gl_null_is_ident(s[n], false)) ++n;
+    }
+    size_t copied = n < GL_NULL_NAME_CAP ? n : GL_NULL_NAME_CAP - 1;
+    memcpy(token, s, copied);
+    token[copied] = '\0';
+    *source = s + n;
+    return true;
+}
+
+static void gl_null_parse_uniforms(Gl_Null_Shader *shader, const char *source)
+{
+    shader->uniforms_count = 0;
+    char token[GL_NULL_NAME_CAP];
+    const char *s = source;
+    while (gl_null_next_token(&s, token)) {
+        if (strcmp(token, "uniform") != 0) {
+            // Every other appearance of a declared name is a use
+            for (size_t i = 0; i < shader->uniforms_count; ++i) {
+                if (strcmp(shader->uniforms[i].name, token) == 0) shader->uniforms[i].used = true;
+            }
+            continue;
+        }
+        char type[GL_NULL_NAME_CAP];
+        if (!gl_null_next_token(&s, type) || !gl_null_next_token(&s, token)) break;
+        // Uniform blocks are bound through their buffer
+        if (!gl_null_is_ident(token[0], true)) continue;
+        if (shader->uniforms_count >= GL_NULL_UNIFORMS_CAP) continue;
+        Gl_Null_Uniform *u = &shader->uniforms[shader->uniforms_count++];
+        memcpy(u->name, token, sizeof(u->name));
+        u->type = gl_null_glsl_type(type);
+        u->array = false;
+        u->used = false;
+        const char *after = s;
+        if (gl_null_next_token(&after, token) && strcmp(token, "[") == 0) u->array = true;
+    }
+}
+
+static size_t gl_null_pixel_size(GLenum format)
+{
+    switch (format) {
+    case GL_RED:  return 1;
+    case GL_RG:   return 2;
+    case GL_RGB:  return 3;
+    case GL_RGBA: return 4;
+    default:      return 4;
+    }
+}
+
+#define gl_null_count(call) gl_null_stats.calls[call] += 1
+
+void gl_null_ActiveTexture(GLenum texture)
+{
+    (void) texture;
+    gl_null_count(GL_NULL_ACTIVE_TEXTURE);
+}
+
+void gl_null_AttachShader(GLuint program, GLuint shader)
+{
+    gl_null_count(GL_NULL_ATTACH_SHADER);
+    Gl_Null_Program *p = gl_null_find_program(program);
+    if (p && p->shaders_count < 2) p->shaders[p->shaders_count++] = shader;
+}
+
+void gl_null_BeginQuery(GLenum target, GLuint id)
+{
+    (void) target;
+    (void) id;
+    gl_null_count(GL_NULL_BEGIN_QUERY);
+}
+
+void gl_null_BindAttribLocation(GLuint program, GLuint index, const GLchar *name)
+{
+    (void) program;
+    (void) index;
+    (void) name;
+    gl_null_count(GL_NULL_BIND_ATTRIB_LOCATION);
+}
+
+void gl_null_BindBuffer(GLenum target, GLuint buffer)
+{
+    (void) target;
+    (void) buffer;
+    gl_null_count(GL_NULL_BIND_BUFFER);
+}
+
+void gl_null_BindBufferBase(GLenum target, GLuint index, GLuint buffer)
+{
+    (void) target;
+    (void) index;
+    (void) buffer;
+    gl_null_count(GL_NULL_BIND_BUFFER_BASE);
+}
+
+void gl_null_BindFramebuffer(GLenum target, GLuint framebuffer)
+{
+    (void) target;
+    (void) framebuffer;
+    gl_null_count(GL_NULL_BIND_FRAMEBUFFER);
+}
+
+void gl_null_BindTexture(GLenum target, GLuint texture)
+{
+    (void) target;
+    (void) texture;
+    gl_null_count(GL_NULL_BIND_TEXTURE);
+}
+
+void gl_null_BindVertexArray(GLuint array)
+{
+    (void) array;
+    gl_null_count(GL_NULL_BIND_VERTEX_ARRAY);
+}
+
+void gl_null_BlendFunc(GLenum sfactor, GLenum dfactor)
+{
+    (void) sfactor;
+    (void) dfactor;
+    gl_null_count(GL_NULL_BLEND_FUNC);
+}
+
+void gl_null_BufferData(GLenum target, GLsizeiptr size, const void *data, GLenum usage)
+{
+    (void) target;
+    (void) usage;
+    gl_null_count(GL_NULL_BUFFER_DATA);
+    if (data) gl_null_stats.bytes_uploaded += size;
+}
+
+void gl_null_BufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void *data)
+{
+    (void) target;
+    (void) offset;
+    (void) data;
+    gl_null_count(GL_NULL_BUFFER_SUB_DATA);
+    gl_null_stats.bytes_uploaded += size;
+}
+
+GLenum gl_null_CheckFramebufferStatus(GLenum target)
+{
+    (void) target;
+    gl_null_count(GL_NULL_CHECK_FRAMEBUFFER_STATUS);
+    return GL_FRAMEBUFFER_COMPLETE;
+}
+
+void gl_null_Clear(GLbitfield mask)
+{
+    (void) mask;
+    gl_null_count(GL_NULL_CLEAR);
+}
+
+void gl_null_ClearColor(GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha)
+{
+    (void) red;
+    (void) green;
+    (void) blue;
+    (void) alpha;
+    gl_null_count(GL_NULL_CLEAR_COLOR);
+}
+
+void gl_null_CompileShader(GLuint shader)
+{
+    (void) shader;
+    gl_null_count(GL_NULL_COMPILE_SHADER);
+}
+
+GLuint gl_null_CreateProgram(void)
+{
+    gl_null_count(GL_NULL_CREATE_PROGRAM);
+    GLuint name = gl_null_next_name++;
+    Gl_Null_Program *p = gl_null_find_program(0);
+    if (p) *p = (Gl_Null_Program) {.name = name};
+    return name;
+}
+
+GLuint gl_null_CreateShader(GLenum type)
+{
+    (void) type;
+    gl_null_count(GL_NULL_CREATE_SHADER);
+    GLuint name = gl_null_next_name++;
+    Gl_Null_Shader *shader = gl_null_find_shader(0);
+    if (shader) *shader = (Gl_Null_Shader) {.name = name};
+    return name;
+}
+
+void gl_null_DeleteFramebuffers(GLsizei n, const GLuint *framebuffers)
+{
+    (void) n;
+    (void) framebuffers;
+    gl_null_count(GL_NULL_DELETE_FRAMEBUFFERS);
+}
+
+void gl_null_DeleteShader(GLuint shader)
+{
+    gl_null_count(GL_NULL_DELETE_SHADER);
+    Gl_Null_Shader *s = gl_null_find_shader(shader);
+    if (s) s->name = 0;
+}
+
+void gl_null_DeleteTextures(GLsizei n, const GLuint *textures)
+{
+    (void) n;
+    (void) textures;
+    gl_null_count(GL_NULL_DELETE_TEXTURES);
+}
+
+void gl_null_DetachShader(GLuint program, GLuint shader)
+{
+    gl_null_count(GL_NULL_DETACH_SHADER);
+    Gl_Null_Program *p = gl_null_find_program(program);
+    if (p) {
+        for (size_t i = 0; i < p->shaders_count; ++i) {
+            if (p->shaders[i] == shader) p->shaders[i--] = p->shaders[--p->shaders_count];
+        }
+    }
+}
+
+void gl_null_Disable(GLenum cap)
+{
+    (void) cap;
+    gl_null_count(GL_NULL_DISABLE);
+}
+
+void gl_null_DrawArrays(GLenum mode, GLint first, GLsizei count)
+{
+    (void) mode;
+    (void) first;
+    gl_null_count(GL_NULL_DRAW_ARRAYS);
+    gl_null_stats.draw_calls += 1;
+    gl_null_stats.vertices_drawn += count;
+}
+
+void gl_null_Enable(GLenum cap)
+{
+    (void) cap;
+    gl_null_count(GL_NULL_ENABLE);
+}
+
+void gl_null_EnableVertexAttribArray(GLuint index)
+{
+    (void) index;
+    gl_null_count(GL_NULL_ENABLE_VERTEX_ATTRIB_ARRAY);
+}
+
+void gl_null_EndQuery(GLenum target)
+{
+    (void) target;
+    gl_null_count(GL_NULL_END_QUERY);
+}
+
+void gl_null_Finish(void)
+{
+    gl_null_count(GL_NULL_FINISH);
+}
+
+void gl_null_FramebufferTexture2D(GLenum target, GLenum attachment, GLenum textarget, GLuint texture, GLint level)
+{
+    (void) target;
+    (void) attachment;
+    (void) textarget;
+    (void) texture;
+    (void) level;
+    gl_null_count(GL_NULL_FRAMEBUFFER_TEXTURE_2D);
+}
+
+void gl_null_GenBuffers(GLsizei n, GLuint *buffers)
+{
+    gl_null_count(GL_NULL_GEN_BUFFERS);
+    gl_null_gen(n, buffers);
+}
+
+void gl_null_GenFramebuffers(GLsizei n, GLuint *framebuffers)
+{
+    gl_null_count(GL_NULL_GEN_FRAMEBUFFERS);
+    gl_null_gen(n, framebuffers);
+}
+
+void gl_null_GenQueries(GLsizei n, GLuint *ids)
+{
+    gl_null_count(GL_NULL_GEN_QUERIES);
+    gl_null_gen(n, ids);
+}
+
+void gl_null_GenTextures(GLsizei n, GLuint *textures)
+{
+    gl_null_count(GL_NULL_GEN_TEXTURES);
+    gl_null_gen(n, textures);
+}
+
+void gl_null_GenVertexArrays(GLsizei n, GLuint *arrays)
+{
+    gl_null_count(GL_NULL_GEN_VERTEX_ARRAYS);
+    gl_null_gen(n, arrays);
+}
+
+// The attributes are bound by the renderer, so programs report none to check
+void gl_null_GetActiveAttrib(GLuint program, GLuint index, GLsizei bufSize, GLsizei *length, GLint *size, GLenum *type, GLchar *name)
+{
+    (void) program;
+    (void) index;
+    gl_null_count(GL_NULL_GET_ACTIVE_ATTRIB);
+    if (length) *length = 0;
+    if (size) *size = 0;
+    if (type) *type = 0;
+    if (name && bufSize > 0) name[0] = '\0';
+}
+
+void gl_null_GetActiveUniform(GLuint program, GLuint index, GLsizei bufSize, GLsizei *length, GLint *size, GLenum *type, GLchar *name)
+{
+    gl_null_count(GL_NULL_GET_ACTIVE_UNIFORM);
+    Gl_Null_Program *p = gl_null_find_program(program);
+    if (!p || index >= p->uniforms_count) {
+        if (length) *length = 0;
+        if (size) *size = 0;
+        if (type) *type = 0;
+        if (name && bufSize > 0) name[0] = '\0';
+        return;
+    }
+    const Gl_Null_Uniform *u = &p->uniforms[index];
+    if (size) *size = 1;
+    if (type) *type = u->type;
+    // Arrays are reported as `name[0]` like by the drivers
+    int n = 0;
+    if (name && bufSize > 0) n = snprintf(name, bufSize, u->array ? "%s[0]" : "%s", u->name);
+    if (length) *length = n < bufSize ? n : bufSize - 1;
+}
+
+void gl_null_GetActiveUniformsiv(GLuint program, GLsizei uniformCount, const GLuint *uniformIndices, GLenum pname, GLint *params)
+{
+    (void) program;
+    (void) uniformIndices;
+    (void) pname;
+    gl_null_count(GL_NULL_GET_ACTIVE_UNIFORMSIV);
+    for (GLsizei i = 0; i < uniformCount; ++i) params[i] = -1;
+}
+
+GLint gl_null_GetAttribLocation(GLuint program, const GLchar *name)
+{
+    (void) program;
+    (void) name;
+    gl_null_count(GL_NULL_GET_ATTRIB_LOCATION);
+    return -1;
+}
+
+void gl_null_GetIntegerv(GLenum pname, GLint *data)
+{
+    gl_null_count(GL_NULL_GET_INTEGERV);
+    // A common desktop limit, the glyph atlas wraps its rows like with such a driver
+    *data = pname == GL_MAX_TEXTURE_SIZE ? 8192 : 0;
+}
+
+void gl_null_GetProgramInfoLog(GLuint program, GLsizei bufSize, GLsizei *length, GLchar *infoLog)
+{
+    (void) program;
+    gl_null_count(GL_NULL_GET_PROGRAM_INFO_LOG);
+    if (length) *length = 0;
+    if (infoLog && bufSize > 0) infoLog[0] = '\0';
+}
+
+void gl_null_GetProgramiv(GLuint program, GLenum pname, GLint *params)
+{
+    gl_null_count(GL_NULL_GET_PROGRAMIV);
+    Gl_Null_Program *p = gl_null_find_program(program);
+    switch (pname) {
+    case GL_LINK_STATUS:     *params = GL_TRUE; break;
+    case GL_ACTIVE_UNIFORMS: *params = p ? (GLint) p->uniforms_count : 0; break;
+    default:                 *params = 0; break;
+    }
+}
+
+void gl_null_GetQueryObjectui64v(GLuint id, GLenum pname, GLuint64 *params)
+{
+    (void) id;
+    gl_null_count(GL_NULL_GET_QUERY_OBJECTUI64V);
+    // Nothing is ever waited for
+    *params = pname == GL_QUERY_RESULT_AVAILABLE ? GL_TRUE : 0;
+}
+
+void gl_null_GetShaderInfoLog(GLuint shader, GLsizei bufSize, GLsizei *length, GLchar *infoLog)
+{
+    (void) shader;
+    gl_null_count(GL_NULL_GET_SHADER_INFO_LOG);
+    if (length) *length = 0;
+    if (infoLog && bufSize > 0) infoLog[0] = '\0';
+}
+
+void gl_null_GetShaderiv(GLuint shader, GLenum pname, GLint *params)
+{
+    (void) shader;
+    gl_null_count(GL_NULL_GET_SHADERIV);
+    *params = pname == GL_COMPILE_STATUS ? GL_TRUE : 0;
+}
+
+const GLubyte *gl_null_GetString(GLenum name)
+{
+    (void) name;
+    gl_null_count(GL_NULL_GET_STRING);
+    return (const GLubyte *) "null";
+}
+
+GLuint gl_null_GetUniformBlockIndex(GLuint program, const GLchar *uniformBlockName)
+{
+    (void) program;
+    (void) uniformBlockName;
+    gl_null_count(GL_NULL_GET_UNIFORM_BLOCK_INDEX);
+    return GL_INVALID_INDEX;
+}
+
+GLint gl_null_GetUniformLocation(GLuint program, const GLchar *name)
+{
+    gl_null_count(GL_NULL_GET_UNIFORM_LOCATION);
+    Gl_Null_Program *p = gl_null_find_program(program);
+    if (!p) return -1;
+    for (size_t i = 0; i < p->uniforms_count; ++i) {
+        if (strcmp(p->uniforms[i].name, name) == 0) return (GLint) i;
+    }
+    return -1;
+}
+
+// The uniforms used by any of the attached shaders become the active ones
+void gl_null_LinkProgram(GLuint program)
+{
+    gl_null_count(GL_NULL_LINK_PROGRAM);
+    Gl_Null_Program *p = gl_null_find_program(program);
+    if (!p) return;
+    p->uniforms_count = 0;
+    for (size_t i = 0; i < p->shaders_count; ++i) {
+        const Gl_Null_Shader *shader = gl_null_find_shader(p->shaders[i]);
+        if (!shader) continue;
+        for (size_t j = 0; j < shader->uniforms_count; ++j) {
+            const Gl_Null_Uniform *u = &shader->uniforms[j];
+            if (!u->used) continue;
+            bool known = false;
+            for (size_t k = 0; k < p->uniforms_count && !known; ++k) {
+                known = strcmp(p->uniforms[k].name, u->name) == 0;
+            }
+            if (!known && p->uniforms_count < GL_NULL_UNIFORMS_CAP) p->uniforms[p->uniforms_count++] = *u;
+        }
+    }
+}
+
+void gl_null_PixelStorei(GLenum pname, GLint param)
+{
+    (void) pname;
+    (void) param;
+    gl_null_count(GL_NULL_PIXEL_STOREI);
+}
+
+void gl_null_ReadPixels(GLint x, GLint y, GLsizei width, GLsizei height, GLenum format, GLenum type, void *pixels)
+{
+    (void) x;
+    (void) y;
+    (void) type;
+    gl_null_count(GL_NULL_READ_PIXELS);
+    memset(pixels, 0, (size_t) width * height * gl_null_pixel_size(format));
+}
+
+void gl_null_Scissor(GLint x, GLint y, GLsizei width, GLsizei height)
+{
+    (void) x;
+    (void) y;
+    (void) width;
+    (void) height;
+    gl_null_count(GL_NULL_SCISSOR);
+}
+
+void gl_null_ShaderSource(GLuint shader, GLsizei count, const GLchar *const *string, const GLint *length)
+{
+    gl_null_count(GL_NULL_SHADER_SOURCE);
+    Gl_Null_Shader *s = gl_null_find_shader(shader);
+    if (!s) return;
+    size_t size = 0;
+    for (GLsizei i = 0; i < count; ++i) size += length && length[i] >= 0 ? (size_t) length[i] : strlen(string[i]);
+    char *source = malloc(size + 1);
+    if (!source) return;
+    size = 0;
+    for (GLsizei i = 0; i < count; ++i) {
+        size_t n = length && length[i] >= 0 ? (size_t) length[i] : strlen(string[i]);
+        memcpy(source + size, string[i], n);
+        size += n;
+    }
+    source[size] = '\0';
+    gl_null_parse_uniforms(s, source);
+    free(source);
+}
+
+void gl_null_TexImage2D(GLenum target, GLint level, GLint internalformat, GLsizei width, GLsizei height, GLint border, GLenum format, GLenum type, const void *pixels)
+{
+    (void) target;
+    (void) level;
+    (void) internalformat;
+    (void) border;
+    (void) type;
+    gl_null_count(GL_NULL_TEX_IMAGE_2D);
+    if (pixels) gl_null_stats.bytes_uploaded += (size_t) width * height * gl_null_pixel_size(format);
+}
+
+void gl_null_TexParameteri(GLenum target, GLenum pname, GLint param)
+{
+    (void) target;
+    (void) pname;
+    (void) param;
+    gl_null_count(GL_NULL_TEX_PARAMETERI);
+}
+
+void gl_null_TexSubImage2D(GLenum target, GLint level, GLint xoffset, GLint yoffset, GLsizei width, GLsizei height, GLenum format, GLenum type, const void *pixels)
+{
+    (void) target;
+    (void) level;
+    (void) xoffset;
+    (void) yoffset;
+    (void) type;
+    (void) pixels;
+    gl_null_count(GL_NULL_TEX_SUB_IMAGE_2D);
+    gl_null_stats.bytes_uploaded += (size_t) width * height * gl_null_pixel_size(format);
+}
+
+void gl_null_Uniform1f(GLint location, GLfloat v0)
+{
+    (void) location;
+    (void) v0;
+    gl_null_count(GL_NULL_UNIFORM1F);
+}
+
+void gl_null_Uniform1i(GLint location, GLint v0)
+{
+    (void) location;
+    (void) v0;
+    gl_null_count(GL_NULL_UNIFORM1I);
+}
+
+void gl_null_Uniform2f(GLint location, GLfloat v0, GLfloat v1)
+{
+    (void) location;
+    (void) v0;
+    (void) v1;
+    gl_null_count(GL_NULL_UNIFORM2F);
+}
+
+void gl_null_Uniform2fv(GLint location, GLsizei count, const GLfloat *value)
+{
+    (void) location;
+    (void) value;
+    gl_null_count(GL_NULL_UNIFORM2FV);
+    gl_null_stats.bytes_uploaded += (size_t) count * 2 * sizeof(GLfloat);
+}
+
+void gl_null_UniformBlockBinding(GLuint program, GLuint uniformBlockIndex, GLuint uniformBlockBinding)
+{
+    (void) program;
+    (void) uniformBlockIndex;
+    (void) uniformBlockBinding;
+    gl_null_count(GL_NULL_UNIFORM_BLOCK_BINDING);
+}
+
+void gl_null_UseProgram(GLuint program)
+{
+    (void) program;
+    gl_null_count(GL_NULL_USE_PROGRAM);
+}
+
+void gl_null_VertexAttribIPointer(GLuint index, GLint size, GLenum type, GLsizei stride, const void *pointer)
+{
+    (void) index;
+    (void) size;
+    (void) type;
+    (void) stride;
+    (void) pointer;
+    gl_null_count(GL_NULL_VERTEX_ATTRIB_I_POINTER);
+}
+
+void gl_null_VertexAttribPointer(GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const void *pointer)
+{
+    (void) index;
+    (void) size;
+    (void) type;
+    (void) normalized;
+    (void) stride;
+    (void) pointer;
+    gl_null_count(GL_NULL_VERTEX_ATTRIB_POINTER);
+}
+
+void gl_null_Viewport(GLint x, GLint y, GLsizei width, GLsizei height)
+{
+    (void) x;
+    (void) y;
+    (void) width;
+    (void) height;
+    gl_null_count(GL_NULL_VIEWPORT);
+}
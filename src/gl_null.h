@@ -0,0 +1,224 @@
+#ifndef GL_NULL_H_
+#define GL_NULL_H_
+
+// No-op OpenGL backend for profiling and testing the batching layer without a driver.
+// Every entry point used by the renderer, the glyph atlas and the framebuffer is replaced
+// by a function that only counts the call and the amount of data it would have uploaded.
+// Programs report the uniforms their shader sources use, so the uniform uploads of the
+// renderer happen like with a driver.
+// Included through gl.h when building with -DGL_NULL.
+
+#include <stddef.h>
+#include <GL/glcorearb.h>
+
+typedef enum {
+    GL_NULL_ACTIVE_TEXTURE = 0,
+    GL_NULL_ATTACH_SHADER,
+    GL_NULL_BEGIN_QUERY,
+    GL_NULL_BIND_ATTRIB_LOCATION,
+    GL_NULL_BIND_BUFFER,
+    GL_NULL_BIND_BUFFER_BASE,
+    GL_NULL_BIND_FRAMEBUFFER,
+    GL_NULL_BIND_TEXTURE,
+    GL_NULL_BIND_VERTEX_ARRAY,
+    GL_NULL_BLEND_FUNC,
+    GL_NULL_BUFFER_DATA,
+    GL_NULL_BUFFER_SUB_DATA,
+    GL_NULL_CHECK_FRAMEBUFFER_STATUS,
+    GL_NULL_CLEAR,
+    GL_NULL_CLEAR_COLOR,
+    GL_NULL_COMPILE_SHADER,
+    GL_NULL_CREATE_PROGRAM,
+    GL_NULL_CREATE_SHADER,
+    GL_NULL_DELETE_FRAMEBUFFERS,
+    GL_NULL_DELETE_SHADER,
+    GL_NULL_DELETE_TEXTURES,
+    GL_NULL_DETACH_SHADER,
+    GL_NULL_DISABLE,
+    GL_NULL_DRAW_ARRAYS,
+    GL_NULL_ENABLE,
+    GL_NULL_ENABLE_VERTEX_ATTRIB_ARRAY,
+    GL_NULL_END_QUERY,
+    GL_NULL_FINISH,
+    GL_NULL_FRAMEBUFFER_TEXTURE_2D,
+    GL_NULL_GEN_BUFFERS,
+    GL_NULL_GEN_FRAMEBUFFERS,
+    GL_NULL_GEN_QUERIES,
+    GL_NULL_GEN_TEXTURES,
+    GL_NULL_GEN_VERTEX_ARRAYS,
+    GL_NULL_GET_ACTIVE_ATTRIB,
+    GL_NULL_GET_ACTIVE_UNIFORM,
+    GL_NULL_GET_ACTIVE_UNIFORMSIV,
+    GL_NULL_GET_ATTRIB_LOCATION,
+    GL_NULL_GET_INTEGERV,
+    GL_NULL_GET_PROGRAM_INFO_LOG,
+    GL_NULL_GET_PROGRAMIV,
+    GL_NULL_GET_QUERY_OBJECTUI64V,
+    GL_NULL_GET_SHADER_INFO_LOG,
+    GL_NULL_GET_SHADERIV,
+    GL_NULL_GET_STRING,
+    GL_NULL_GET_UNIFORM_BLOCK_INDEX,
+    GL_NULL_GET_UNIFORM_LOCATION,
+    GL_NULL_LINK_PROGRAM,
+    GL_NULL_PIXEL_STOREI,
+    GL_NULL_READ_PIXELS,
+    GL_NULL_SCISSOR,
+    GL_NULL_SHADER_SOURCE,
+    GL_NULL_TEX_IMAGE_2D,
+    GL_NULL_TEX_PARAMETERI,
+    GL_NULL_TEX_SUB_IMAGE_2D,
+    GL_NULL_UNIFORM1F,
+    GL_NULL_UNIFORM1I,
+    GL_NULL_UNIFORM2F,
+    GL_NULL_UNIFORM2FV,
+    GL_NULL_UNIFORM_BLOCK_BINDING,
+    GL_NULL_USE_PROGRAM,
+    GL_NULL_VERTEX_ATTRIB_I_POINTER,
+    GL_NULL_VERTEX_ATTRIB_POINTER,
+    GL_NULL_VIEWPORT,
+    COUNT_GL_NULL_CALLS,
+} Gl_Null_Call;
+
+typedef struct {
+    size_t calls[COUNT_GL_NULL_CALLS];
+    size_t draw_calls;
+    size_t vertices_drawn;
+    size_t bytes_uploaded; // Buffer and texture data passed to the "driver"
+} Gl_Null_Stats;
+
+extern Gl_Null_Stats gl_null_stats;
+
+const char *gl_null_call_name(Gl_Null_Call call);
+void gl_null_reset_stats(void);
+
+void gl_null_ActiveTexture(GLenum texture);
+void gl_null_AttachShader(GLuint program, GLuint shader);
+void gl_null_BeginQuery(GLenum target, GLuint id);
+void gl_null_BindAttribLocation(GLuint program, GLuint index, const GLchar *name);
+void gl_null_BindBuffer(GLenum target, GLuint buffer);
+void gl_null_BindBufferBase(GLenum target, GLuint index, GLuint buffer);
+void gl_null_BindFramebuffer(GLenum target, GLuint framebuffer);
+void gl_null_BindTexture(GLenum target, GLuint texture);
+void gl_null_BindVertexArray(GLuint array);
+void gl_null_BlendFunc(GLenum sfactor, GLenum dfactor);
+void gl_null_BufferData(GLenum target, GLsizeiptr size, const void *data, GLenum usage);
+void gl_null_BufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void *data);
+GLenum gl_null_CheckFramebufferStatus(GLenum target);
+void gl_null_Clear(GLbitfield mask);
+void gl_null_ClearColor(GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha);
+void gl_null_CompileShader(GLuint shader);
+GLuint gl_null_CreateProgram(void);
+GLuint gl_null_CreateShader(GLenum type);
+void gl_null_DeleteFramebuffers(GLsizei n, const GLuint *framebuffers);
+void gl_null_DeleteShader(GLuint shader);
+void gl_null_DeleteTextures(GLsizei n, const GLuint *textures);
+void gl_null_DetachShader(GLuint program, GLuint shader);
+void gl_null_Disable(GLenum cap);
+void gl_null_DrawArrays(GLenum mode, GLint first, GLsizei count);
+void gl_null_Enable(GLenum cap);
+void gl_null_EnableVertexAttribArray(GLuint index);
+void gl_null_EndQuery(GLenum target);
+void gl_null_Finish(void);
+void gl_null_FramebufferTexture2D(GLenum target, GLenum attachment, GLenum textarget, GLuint texture, GLint level);
+void gl_null_GenBuffers(GLsizei n, GLuint *buffers);
+void gl_null_GenFramebuffers(GLsizei n, GLuint *framebuffers);
+void gl_null_GenQueries(GLsizei n, GLuint *ids);
+void gl_null_GenTextures(GLsizei n, GLuint *textures);
+void gl_null_GenVertexArrays(GLsizei n, GLuint *arrays);
+void gl_null_GetActiveAttrib(GLuint program, GLuint index, GLsizei bufSize, GLsizei *length, GLint *size, GLenum *type, GLchar *name);
+void gl_null_GetActiveUniform(GLuint program, GLuint index, GLsizei bufSize, GLsizei *length, GLint *size, GLenum *type, GLchar *name);
+void gl_null_GetActiveUniformsiv(GLuint program, GLsizei uniformCount, const GLuint *uniformIndices, GLenum pname, GLint *params);
+GLint gl_null_GetAttribLocation(GLuint program, const GLchar *name);
+void gl_null_GetIntegerv(GLenum pname, GLint *data);
+void gl_null_GetProgramInfoLog(GLuint program, GLsizei bufSize, GLsizei *length, GLchar *infoLog);
+void gl_null_GetProgramiv(GLuint program, GLenum pname, GLint *params);
+void gl_null_GetQueryObjectui64v(GLuint id, GLenum pname, GLuint64 *params);
+void gl_null_GetShaderInfoLog(GLuint shader, GLsizei bufSize, GLsizei *length, GLchar *infoLog);
+void gl_null_GetShaderiv(GLuint shader, GLenum pname, GLint *params);
+const GLubyte *gl_null_GetString(GLenum name);
+GLuint gl_null_GetUniformBlockIndex(GLuint program, const GLchar *uniformBlockName);
+GLint gl_null_GetUniformLocation(GLuint program, const GLchar *name);
+void gl_null_LinkProgram(GLuint program);
+void gl_null_PixelStorei(GLenum pname, GLint param);
+void gl_null_ReadPixels(GLint x, GLint y, GLsizei width, GLsizei height, GLenum format, GLenum type, void *pixels);
+void gl_null_Scissor(GLint x, GLint y, GLsizei width, GLsizei height);
+void gl_null_ShaderSource(GLuint shader, GLsizei count, const GLchar *const *string, const GLint *length);
+void gl_null_TexImage2D(GLenum target, GLint level, GLint internalformat, GLsizei width, GLsizei height, GLint border, GLenum format, GLenum type, const void *pixels);
+void gl_null_TexParameteri(GLenum target, GLenum pname, GLint param);
+void gl_null_TexSubImage2D(GLenum target, GLint level, GLint xoffset, GLint yoffset, GLsizei width, GLsizei height, GLenum format, GLenum type, const void *pixels);
+void gl_null_Uniform1f(GLint location, GLfloat v0);
+void gl_null_Uniform1i(GLint location, GLint v0);
+void gl_null_Uniform2f(GLint location, GLfloat v0, GLfloat v1);
+void gl_null_Uniform2fv(GLint location, GLsizei count, const GLfloat *value);
+void gl_null_UniformBlockBinding(GLuint program, GLuint uniformBlockIndex, GLuint uniformBlockBinding);
+void gl_null_UseProgram(GLuint program);
+void gl_null_VertexAttribIPointer(GLuint index, GLint size, GLenum type, GLsizei stride, const void *pointer);
+void gl_null_VertexAttribPointer(GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const void *pointer);
+void gl_null_Viewport(GLint x, GLint y, GLsizei width, GLsizei height);
+
+#define glActiveTexture gl_null_ActiveTexture
+#define glAttachShader gl_null_AttachShader
+#define glBeginQuery gl_null_BeginQuery
+#define glBindAttribLocation gl_null_BindAttribLocation
+#define glBindBuffer gl_null_BindBuffer
+#define glBindBufferBase gl_null_BindBufferBase
+#define glBindFramebuffer gl_null_BindFramebuffer
+#define glBindTexture gl_null_BindTexture
+#define glBindVertexArray gl_null_BindVertexArray
+#define glBlendFunc gl_null_BlendFunc
+#define glBufferData gl_null_BufferData
+#define glBufferSubData gl_null_BufferSubData
+#define glCheckFramebufferStatus gl_null_CheckFramebufferStatus
+#define glClear gl_null_Clear
+#define glClearColor gl_null_ClearColor
+#define glCompileShader gl_null_CompileShader
+#define glCreateProgram gl_null_CreateProgram
+#define glCreateShader gl_null_CreateShader
+#define glDeleteFramebuffers gl_null_DeleteFramebuffers
+#define glDeleteShader gl_null_DeleteShader
+#define glDeleteTextures gl_null_DeleteTextures
+#define glDetachShader gl_null_DetachShader
+#define glDisable gl_null_Disable
+#define glDrawArrays gl_null_DrawArrays
+#define glEnable gl_null_Enable
+#define glEnableVertexAttribArray gl_null_EnableVertexAttribArray
+#define glEndQuery gl_null_EndQuery
+#define glFinish gl_null_Finish
+#define glFramebufferTexture2D gl_null_FramebufferTexture2D
+#define glGenBuffers gl_null_GenBuffers
+#define glGenFramebuffers gl_null_GenFramebuffers
+#define glGenQueries gl_null_GenQueries
+#define glGenTextures gl_null_GenTextures
+#define glGenVertexArrays gl_null_GenVertexArrays
+#define glGetActiveAttrib gl_null_GetActiveAttrib
+#define glGetActiveUniform gl_null_GetActiveUniform
+#define glGetActiveUniformsiv gl_null_GetActiveUniformsiv
+#define glGetAttribLocation gl_null_GetAttribLocation
+#define glGetIntegerv gl_null_GetIntegerv
+#define glGetProgramInfoLog gl_null_GetProgramInfoLog
+#define glGetProgramiv gl_null_GetProgramiv
+#define glGetQueryObjectui64v gl_null_GetQueryObjectui64v
+#define glGetShaderInfoLog gl_null_GetShaderInfoLog
+#define glGetShaderiv gl_null_GetShaderiv
+#define glGetString gl_null_GetString
+#define glGetUniformBlockIndex gl_null_GetUniformBlockIndex
+#define glGetUniformLocation gl_null_GetUniformLocation
+#define glLinkProgram gl_null_LinkProgram
+#define glPixelStorei gl_null_PixelStorei
+#define glReadPixels gl_null_ReadPixels
+#define glScissor gl_null_Scissor
+#define glShaderSource gl_null_ShaderSource
+#define glTexImage2D gl_null_TexImage2D
+#define glTexParameteri gl_null_TexParameteri
+#define glTexSubImage2D gl_null_TexSubImage2D
+#define glUniform1f gl_null_Uniform1f
+#define glUniform1i gl_null_Uniform1i
+#define glUniform2f gl_null_Uniform2f
+#define glUniform2fv gl_null_Uniform2fv
+#define glUniformBlockBinding gl_null_UniformBlockBinding
+#define glUseProgram gl_null_UseProgram
+#define glVertexAttribIPointer gl_null_VertexAttribIPointer
+#define glVertexAttribPointer gl_null_VertexAttribPointer
+#define glViewport gl_null_Viewport
+
+#endif  // GL_NULL_H_
@@ -1,6 +1,9 @@
 #include <stdlib.h>
 #include <stdio.h>
+#include <stddef.h>
+#include <string.h>
 #include "glyph.h"
+#include "gpu_memory.h"
 
 // CODE from tsoding: https://github.com/tsoding/ded
 /*
@@ -25,21 +28,84 @@ LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
 OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
 WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
  */
-void free_glyph_atlas_init(Free_Glyph_Atlas *atlas, FT_Face face)
+// Width the rows of the atlas wrap at, 0 without a limit. The software rasterizer has
+// none, free_glyph_atlas_init sets it before the atlas builder thread is started.
+static FT_UInt free_glyph_atlas_max_width = 0;
+
+// Moves to the start of the next row when a glyph of width w does not fit into this one
+static void free_glyph_atlas_wrap(FT_UInt *x, FT_UInt *row, FT_UInt w)
+{
+    if (free_glyph_atlas_max_width > 0 && *x > 0 && *x + w > free_glyph_atlas_max_width) {
+        *x = 0;
+        *row += 1;
+    }
+}
+
+// Rasterizes the glyphs into atlas->pixels on the CPU, which is also what the software
+// rasterizer samples from
+void free_glyph_atlas_build(Free_Glyph_Atlas *atlas, FT_Face face)
 {
     FT_Int32 load_flags = FT_LOAD_RENDER | FT_LOAD_TARGET_(FT_RENDER_MODE_SDF);
+    atlas->pixel_size = face->size->metrics.y_ppem;
+    FT_UInt row_height = 0;
+    FT_UInt x = 0;
+    FT_UInt row = 0;
     for (int i = 32; i < 128; ++i) {
         if (FT_Load_Char(face, i, load_flags)) {
             fprintf(stderr, "ERROR: could not load glyph of character: %d\n", i);
             exit(1);
         }
 
-        atlas->atlas_width += face->glyph->bitmap.width;
-        if (atlas->atlas_height < face->glyph->bitmap.rows) {
-            atlas->atlas_height = face->glyph->bitmap.rows;
+        free_glyph_atlas_wrap(&x, &row, face->glyph->bitmap.width);
+        x += face->glyph->bitmap.width;
+        if (atlas->atlas_width < x) atlas->atlas_width = x;
+        if (row_height < face->glyph->bitmap.rows) row_height = face->glyph->bitmap.rows;
+    }
+    atlas->atlas_height = (row + 1)*row_height;
+
+    atlas->pixels = calloc((size_t) atlas->atlas_width * atlas->atlas_height, 1);
+    if (atlas->pixels == NULL) {
+        fprintf(stderr, "ERROR: could not allocate glyph atlas of %ux%u\n", atlas->atlas_width, atlas->atlas_height);
+        exit(1);
+    }
+
+    x = 0;
+    row = 0;
+    for (int i = 32; i < 128; ++i) {
+        if (FT_Load_Char(face, i, load_flags)) {
+            fprintf(stderr, "ERROR: could not load glyph of a character: %d\n", i);
+            exit(1);
+        }
+
+        if (FT_Render_Glyph(face->glyph, FT_RENDER_MODE_NORMAL)) {
+            fprintf(stderr, "ERROR: could not render glyph of a character: %d\n", i);
+            exit(1);
         }
+
+        atlas->metrics[i].ax = face->glyph->advance.x >> 6;
+        atlas->metrics[i].ay = face->glyph->advance.y >> 6;
+        atlas->metrics[i].bw = face->glyph->bitmap.width;
+        atlas->metrics[i].bh = face->glyph->bitmap.rows;
+        atlas->metrics[i].bl = face->glyph->bitmap_left;
+        atlas->metrics[i].bt = face->glyph->bitmap_top;
+        free_glyph_atlas_wrap(&x, &row, face->glyph->bitmap.width);
+        FT_UInt y = row*row_height;
+        atlas->metrics[i].tx = (float) x / (float) atlas->atlas_width;
+        atlas->metrics[i].ty = (float) y / (float) atlas->atlas_height;
+
+        FT_Bitmap *bitmap = &face->glyph->bitmap;
+        for (unsigned int r = 0; r < bitmap->rows; ++r) {
+            memcpy(atlas->pixels + (size_t) (y + r) * atlas->atlas_width + x,
+                   bitmap->buffer + (ptrdiff_t) r * bitmap->pitch,
+                   bitmap->width);
+        }
+        x += face->glyph->bitmap.width;
     }
+}
 
+// Creates the texture from atlas->pixels in a single upload
+void free_glyph_atlas_upload(Free_Glyph_Atlas *atlas)
+{
     glActiveTexture(GL_TEXTURE0);
     glGenTextures(1, &atlas->glyphs_texture);
     glBindTexture(GL_TEXTURE_2D, atlas->glyphs_texture);
@@ -49,6 +115,13 @@ void free_glyph_atlas_init(Free_Glyph_Atlas *atlas, FT_Face face)
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
 
+    free_glyph_atlas_update(atlas);
+}
+
+void free_glyph_atlas_update(const Free_Glyph_Atlas *atlas)
+{
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, atlas->glyphs_texture);
     glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
     glTexImage2D(
         GL_TEXTURE_2D,
@@ -59,63 +132,69 @@ void free_glyph_atlas_init(Free_Glyph_Atlas *atlas, FT_Face face)
         0,
         GL_RED,
         GL_UNSIGNED_BYTE,
-        NULL);
-
-    int x = 0;
-    for (int i = 32; i < 128; ++i) {
-        if (FT_Load_Char(face, i, load_flags)) {
-            fprintf(stderr, "ERROR: could not load glyph of a character: %d\n", i);
-            exit(1);
-        }
+        atlas->pixels);
+    gpu_memory_track_texture(atlas->glyphs_texture, "glyph atlas", GL_R8,
+                             (int) atlas->atlas_width, (int) atlas->atlas_height);
+}
 
-        if (FT_Render_Glyph(face->glyph, FT_RENDER_MODE_NORMAL)) {
-            fprintf(stderr, "ERROR: could not render glyph of a character: %d\n", i);
-            exit(1);
-        }
+FT_UInt free_glyph_atlas_pixel_size(float scale)
+{
+    if (scale > FREE_GLYPH_MAX_SCALE) scale = FREE_GLYPH_MAX_SCALE;
+    FT_UInt size = (FT_UInt) (FREE_GLYPH_FONT_SIZE*scale + 0.5f);
+    return size < 1 ? 1 : size;
+}
 
-        atlas->metrics[i].ax = face->glyph->advance.x >> 6;
-        atlas->metrics[i].ay = face->glyph->advance.y >> 6;
-        atlas->metrics[i].bw = face->glyph->bitmap.width;
-        atlas->metrics[i].bh = face->glyph->bitmap.rows;
-        atlas->metrics[i].bl = face->glyph->bitmap_left;
-        atlas->metrics[i].bt = face->glyph->bitmap_top;
-        atlas->metrics[i].tx = (float) x / (float) atlas->atlas_width;
+void free_glyph_atlas_init(Free_Glyph_Atlas *atlas, FT_Face face)
+{
+    static bool queried = false;
+    if (!queried) {
+        GLint max_size = 0;
+        glGetIntegerv(GL_MAX_TEXTURE_SIZE, &max_size);
+        if (max_size > 0) free_glyph_atlas_max_width = (FT_UInt) max_size;
+        queried = true;
+    }
+    free_glyph_atlas_build(atlas, face);
+    free_glyph_atlas_upload(atlas);
+}
 
-        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
-        glTexSubImage2D(GL_TEXTURE_2D,
-                        0,
-                        x,
-                        0,
-                        face->glyph->bitmap.width,
-                        face->glyph->bitmap.rows,
-                        GL_RED,
-                        GL_UNSIGNED_BYTE,
-                        face->glyph->bitmap.buffer);
-        x += face->glyph->bitmap.width;
+void free_glyph_atlas_destroy(Free_Glyph_Atlas *atlas)
+{
+    if (atlas->glyphs_texture) {
+        glDeleteTextures(1, &atlas->glyphs_texture);
+        gpu_memory_untrack(GPU_RESOURCE_TEXTURE, atlas->glyphs_texture);
     }
+    free(atlas->pixels);
+    memset(atlas, 0, sizeof(*atlas));
 }
 
 void free_glyph_atlas_render_line_sized(Free_Glyph_Atlas *atlas, Renderer *r, const char *text, size_t text_size, V2f *pos, V4f color)
 {
+    free_glyph_atlas_render_line_scaled(atlas, r, text, text_size, pos, color, 1.0f);
+}
+
+// The atlas stores signed distance fields, so glyphs stay sharp when they are scaled
+void free_glyph_atlas_render_line_scaled(Free_Glyph_Atlas *atlas, Renderer *r, const char *text, size_t text_size, V2f *pos, V4f color, float scale)
+{
+    renderer_set_texture(r, atlas->glyphs_texture);
     for (size_t i = 0; i < text_size; ++i) {
         size_t glyph_index = text[i];
         if (glyph_index >= GLYPH_METRICS_CAPACITY) {
             glyph_index = '?';
         }
         Glyph_Metric metric = atlas->metrics[glyph_index];
-        float x2 = pos->x + metric.bl;
-        float y2 = -pos->y - metric.bt;
-        float w  = metric.bw;
-        float h  = metric.bh;
+        float x2 = pos->x + metric.bl*scale;
+        float y2 = -pos->y - metric.bt*scale;
+        float w  = metric.bw*scale;
+        float h  = metric.bh*scale;
 
-        pos->x += metric.ax;
-        pos->y += metric.ay;
+        pos->x += metric.ax*scale;
+        pos->y += metric.ay*scale;
 
         renderer_image_rect(r,
                             v2f(x2, -y2),
                             color,
                             v2f(w, -h),
-                            v2f(metric.tx, 0),
+                            v2f(metric.tx, metric.ty),
                             v2f(metric.bw / (float) atlas->atlas_width, metric.bh / (float) atlas->atlas_height));
     }
 }
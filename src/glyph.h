@@ -31,6 +31,10 @@ WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include FT_FREETYPE_H
 
 #define FREE_GLYPH_FONT_SIZE 100
+// Largest content scale the atlas is rasterized for, above it the glyphs are scaled up.
+// The glyphs are laid out in a single row that wraps at the GL_MAX_TEXTURE_SIZE of the
+// context, at 2x the row is about 10000 pixels wide.
+#define FREE_GLYPH_MAX_SCALE 2.0f
 
 // https://en.wikibooks.org/wiki/OpenGL_Programming/Modern_OpenGL_Tutorial_Text_Rendering_02
 
@@ -45,18 +49,31 @@ typedef struct {
     float bt; // bitmap_top;
 
     float tx; // x offset of glyph in texture coordinates
+    float ty; // y offset of glyph in texture coordinates
 } Glyph_Metric;
 
 #define GLYPH_METRICS_CAPACITY 128
 
 typedef struct {
+    FT_UInt pixel_size; // Of the face the atlas was rasterized from
     FT_UInt atlas_width;
     FT_UInt atlas_height;
     GLuint glyphs_texture;
+    unsigned char *pixels; // CPU copy of the texture, atlas_width*atlas_height bytes
     Glyph_Metric metrics[GLYPH_METRICS_CAPACITY];
 } Free_Glyph_Atlas;
 
+// Also queries GL_MAX_TEXTURE_SIZE the first time, every later build wraps its rows at it
 void free_glyph_atlas_init(Free_Glyph_Atlas *atlas, FT_Face face);
+void free_glyph_atlas_build(Free_Glyph_Atlas *atlas, FT_Face face);
+void free_glyph_atlas_upload(Free_Glyph_Atlas *atlas);
+// Replaces the contents of the existing texture with atlas->pixels, e.g. after rebuilding
+// the atlas at another size
+void free_glyph_atlas_update(const Free_Glyph_Atlas *atlas);
+// Font pixel size the atlas is rasterized at for FREE_GLYPH_FONT_SIZE text at a content scale
+FT_UInt free_glyph_atlas_pixel_size(float scale);
+void free_glyph_atlas_destroy(Free_Glyph_Atlas *atlas);
 void free_glyph_atlas_render_line_sized(Free_Glyph_Atlas *atlas, Renderer *r, const char *text, size_t text_size, V2f *pos, V4f color);
+void free_glyph_atlas_render_line_scaled(Free_Glyph_Atlas *atlas, Renderer *r, const char *text, size_t text_size, V2f *pos, V4f color, float scale);
 
 #endif  // GLYPH_H_
@@ -0,0 +1,142 @@
+#include <assert.h>
+#include <string.h>
+
+#include "gpu_memory.h"
+
+Gpu_Memory gpu_memory = {
+    .budget_bytes = GPU_MEMORY_DEFAULT_BUDGET,
+};
+
+static_assert(COUNT_GPU_RESOURCE_KINDS == 2, "Update the names of the resource kinds accordingly");
+static const char *gpu_resource_kind_names[COUNT_GPU_RESOURCE_KINDS] = {
+    [GPU_RESOURCE_BUFFER]  = "buffer",
+    [GPU_RESOURCE_TEXTURE] = "texture",
+};
+
+#define MIB(bytes) ((double) (bytes) / (1024.0*1024.0))
+
+static size_t gpu_memory_bytes_per_pixel(GLenum internal_format)
+{
+    switch (internal_format) {
+    case GL_RED:
+    case GL_R8:    return 1;
+    case GL_RG8:   return 2;
+    case GL_RGB:
+    case GL_RGB8:  return 3;
+    case GL_RGBA:
+    case GL_RGBA8: return 4;
+    default:
+        fprintf(stderr, "WARNING: gpu memory: unknown texture format 0x%x, assuming 4 bytes per pixel\n", internal_format);
+        return 4;
+    }
+}
+
+static const char *gpu_memory_format_name(GLenum internal_format)
+{
+    switch (internal_format) {
+    case GL_RED:   return "RED";
+    case GL_R8:    return "R8";
+    case GL_RG8:   return "RG8";
+    case GL_RGB:   return "RGB";
+    case GL_RGB8:  return "RGB8";
+    case GL_RGBA:  return "RGBA";
+    case GL_RGBA8: return "RGBA8";
+    default:       return "?";
+    }
+}
+
+static void gpu_memory_check_budget(void)
+{
+    if (gpu_memory.total_bytes > gpu_memory.peak_bytes) gpu_memory.peak_bytes = gpu_memory.total_bytes;
+
+    bool over = gpu_memory.total_bytes > gpu_memory.budget_bytes;
+    if (over && !gpu_memory.over_budget) {
+        const Gpu_Resource *largest = NULL;
+        for (size_t i = 0; i < gpu_memory.count; ++i) {
+            if (!largest || gpu_memory.resources[i].bytes > largest->bytes) largest = &gpu_memory.resources[i];
+        }
+        fprintf(stderr, "WARNING: GPU memory budget of %.2f MiB exceeded: %.2f MiB in use, largest is %s %s with %.2f MiB\n",
+                MIB(gpu_memory.budget_bytes), MIB(gpu_memory.total_bytes),
+                gpu_resource_kind_names[largest->kind], largest->name, MIB(largest->bytes));
+    }
+    gpu_memory.over_budget = over;
+}
+
+void gpu_memory_set_budget(size_t bytes)
+{
+    gpu_memory.budget_bytes = bytes;
+    gpu_memory.over_budget = false;
+    gpu_memory_check_budget();
+}
+
+static Gpu_Resource *gpu_memory_find(Gpu_Resource_Kind kind, GLuint id)
+{
+    for (size_t i = 0; i < gpu_memory.count; ++i) {
+        Gpu_Resource *res = &gpu_memory.resources[i];
+        if (res->kind == kind && res->id == id) return res;
+    }
+    return NULL;
+}
+
+static void gpu_memory_track(Gpu_Resource resource)
+{
+    Gpu_Resource *res = gpu_memory_find(resource.kind, resource.id);
+    if (res) {
+        gpu_memory.total_bytes -= res->bytes;
+    } else if (gpu_memory.count < GPU_RESOURCES_CAP) {
+        res = &gpu_memory.resources[gpu_memory.count++];
+    } else {
+        fprintf(stderr, "WARNING: gpu memory: more than %d resources, %s is not tracked\n", GPU_RESOURCES_CAP, resource.name);
+        return;
+    }
+    *res = resource;
+    gpu_memory.total_bytes += res->bytes;
+    gpu_memory_check_budget();
+}
+
+void gpu_memory_track_buffer(GLuint buffer, const char *name, size_t bytes)
+{
+    gpu_memory_track((Gpu_Resource) {
+        .kind = GPU_RESOURCE_BUFFER,
+        .id = buffer,
+        .name = name,
+        .bytes = bytes,
+    });
+}
+
+void gpu_memory_track_texture(GLuint texture, const char *name, GLenum internal_format, int width, int height)
+{
+    gpu_memory_track((Gpu_Resource) {
+        .kind = GPU_RESOURCE_TEXTURE,
+        .id = texture,
+        .name = name,
+        .format = internal_format,
+        .width = width,
+        .height = height,
+        .bytes = (size_t) width * height * gpu_memory_bytes_per_pixel(internal_format),
+    });
+}
+
+void gpu_memory_untrack(Gpu_Resource_Kind kind, GLuint id)
+{
+    Gpu_Resource *res = gpu_memory_find(kind, id);
+    if (!res) return;
+    gpu_memory.total_bytes -= res->bytes;
+    *res = gpu_memory.resources[--gpu_memory.count];
+    gpu_memory_check_budget();
+}
+
+void gpu_memory_report(FILE *stream)
+{
+    fprintf(stream, "GPU memory: %.2f MiB in %zu resources (peak %.2f MiB, budget %.2f MiB)\n",
+            MIB(gpu_memory.total_bytes), gpu_memory.count, MIB(gpu_memory.peak_bytes), MIB(gpu_memory.budget_bytes));
+    for (size_t i = 0; i < gpu_memory.count; ++i) {
+        const Gpu_Resource *res = &gpu_memory.resources[i];
+        char shape[64] = "";
+        if (res->kind == GPU_RESOURCE_TEXTURE) {
+            snprintf(shape, sizeof(shape), "%dx%d %s", res->width, res->height, gpu_memory_format_name(res->format));
+        }
+        fprintf(stream, "  %-8s %-20s %-18s %10zu bytes\n",
+                gpu_resource_kind_names[res->kind], res->name, shape, res->bytes);
+    }
+}
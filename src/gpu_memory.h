@@ -0,0 +1,52 @@
+#ifndef GPU_MEMORY_H_
+#define GPU_MEMORY_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+
+#include "gl.h"
+
+// Registry of the buffers and textures the renderer, the glyph atlas and the framebuffers
+// create. Sizes are computed from the allocation parameters (what the driver has to store
+// at least), not queried from the driver. Crossing the budget prints a warning once until
+// the total drops below it again.
+
+#define GPU_RESOURCES_CAP 64
+#define GPU_MEMORY_DEFAULT_BUDGET (64*1024*1024)
+
+typedef enum {
+    GPU_RESOURCE_BUFFER = 0,
+    GPU_RESOURCE_TEXTURE,
+    COUNT_GPU_RESOURCE_KINDS,
+} Gpu_Resource_Kind;
+
+typedef struct {
+    Gpu_Resource_Kind kind;
+    GLuint id;
+    const char *name; // Has to outlive the registry, e.g. a string literal
+    GLenum format;    // Internal format of textures
+    int width;
+    int height;
+    size_t bytes;
+} Gpu_Resource;
+
+typedef struct {
+    Gpu_Resource resources[GPU_RESOURCES_CAP];
+    size_t count;
+    size_t total_bytes;
+    size_t peak_bytes;
+    size_t budget_bytes;
+    bool over_budget;
+} Gpu_Memory;
+
+extern Gpu_Memory gpu_memory;
+
+void gpu_memory_set_budget(size_t bytes);
+// Tracking an id again replaces its previous size, e.g. after glBufferData
+void gpu_memory_track_buffer(GLuint buffer, const char *name, size_t bytes);
+void gpu_memory_track_texture(GLuint texture, const char *name, GLenum internal_format, int width, int height);
+void gpu_memory_untrack(Gpu_Resource_Kind kind, GLuint id);
+void gpu_memory_report(FILE *stream);
+
+#endif  // GPU_MEMORY_H_
@@ -0,0 +1,270 @@
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <GL/glew.h>
+
+#include "common.h"
+#include "renderer.h"
+#include "glyph.h"
+#include "app.h"
+#include "egl_context.h"
+#include "framebuffer.h"
+#include "softrast.h"
+#include "gpu_memory.h"
+#include "profiler.h"
+#include "trace.h"
+#include "timestep.h"
+#include "render_list.h"
+#include "damage.h"
+#include "entities.h"
+
+// Renders the demo scene without a window into an offscreen framebuffer and writes the
+// last frame to a PPM file. Runs on machines without a GPU or display (e.g. llvmpipe).
+// With --software no OpenGL context is created at all and the frames are rasterized by
+// softrast.c instead.
+
+#define HEADLESS_DEFAULT_FPS 60
+
+static Free_Glyph_Atlas atlas = {0};
+static Renderer renderer = {0};
+static Softrast softrast = {0};
+// With --damage the frames are recorded and only their damaged regions drawn with renderer
+static Renderer recorder = {0};
+static Render_List list = {0};
+static Damage damage = {0};
+static Entities entities = {0};
+
+static void usage(const char *program)
+{
+    fprintf(stderr, "Usage: %s [OPTIONS]\n", program);
+    fprintf(stderr, "    --frames <n>         amount of frames to render (default: 1)\n");
+    fprintf(stderr, "    --fps <n>            frame rate of the virtual clock (default: %d)\n", HEADLESS_DEFAULT_FPS);
+    fprintf(stderr, "    --sim-hz <hz>        simulation steps per second of the virtual clock (default: %.0f)\n", TIMESTEP_DEFAULT_HZ);
+    fprintf(stderr, "    --size <w>x<h>       size of the framebuffer (default: %dx%d)\n", SCREEN_WIDTH, SCREEN_HEIGHT);
+    fprintf(stderr, "    --scale <s>          content scale, framebuffer pixels per logical unit (default: 1)\n");
+    fprintf(stderr, "    --output <path.ppm>  write the last frame to this file\n");
+    fprintf(stderr, "    --uber               draw color, text and rainbow content with a single combined shader\n");
+    fprintf(stderr, "    --software           rasterize on the CPU instead of OpenGL\n");
+    fprintf(stderr, "    --threads <n>        threads of the software rasterizer and the entity update (default: one per CPU)\n");
+    fprintf(stderr, "    --entities <n>       simulate and draw n bouncing rects on top of the scene (default: 0)\n");
+    fprintf(stderr, "    --damage             only redraw the regions that changed since the previous frame\n");
+    fprintf(stderr, "    --profile            print frame timings, renderer stats and GPU memory, draw the profiler overlay\n");
+    fprintf(stderr, "    --gpu-budget <MiB>   warn when buffers and textures exceed this size (default: %d)\n", GPU_MEMORY_DEFAULT_BUDGET/(1024*1024));
+    fprintf(stderr, "    --trace <path.json>  record a Chrome trace of the frames\n");
+    fprintf(stderr, "    --trace-csv <path>   write per frame statistics as CSV\n");
+}
+
+int main(int argc, char **argv)
+{
+    int result = 0;
+    Egl_Context ctx = {0};
+    Framebuffer fb = {0};
+
+    int frames = 1;
+    double fps = HEADLESS_DEFAULT_FPS;
+    double sim_hz = TIMESTEP_DEFAULT_HZ;
+    int width = SCREEN_WIDTH;
+    int height = SCREEN_HEIGHT;
+    float scale = 1.0f;
+    const char *output_file_path = NULL;
+    bool profile = false;
+    bool software = false;
+    bool damaged = false;
+    size_t threads = 0;
+    size_t entities_count = 0;
+    const char *trace_file_path = NULL;
+    const char *trace_csv_file_path = NULL;
+
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+            char *end;
+            long n = strtol(argv[++i], &end, 10);
+            if (end == argv[i] || *end != '\0' || n <= 0 || n > INT_MAX) {
+                usage(argv[0]);
+                fprintf(stderr, "ERROR: invalid amount of frames %s\n", argv[i]);
+                return 1;
+            }
+            frames = (int) n;
+        } else if (strcmp(argv[i], "--fps") == 0 && i + 1 < argc) {
+            fps = atof(argv[++i]);
+            if (fps <= 0.0) {
+                usage(argv[0]);
+                fprintf(stderr, "ERROR: invalid frame rate %s\n", argv[i]);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--sim-hz") == 0 && i + 1 < argc) {
+            sim_hz = atof(argv[++i]);
+            if (sim_hz <= 0.0) {
+                usage(argv[0]);
+                fprintf(stderr, "ERROR: invalid simulation rate %s\n", argv[i]);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--size") == 0 && i + 1 < argc) {
+            if (sscanf(argv[++i], "%dx%d", &width, &height) != 2 || width <= 0 || height <= 0) {
+                usage(argv[0]);
+                fprintf(stderr, "ERROR: invalid size %s\n", argv[i]);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--scale") == 0 && i + 1 < argc) {
+            scale = (float) atof(argv[++i]);
+            if (scale <= 0.0f) {
+                usage(argv[0]);
+                fprintf(stderr, "ERROR: invalid content scale %s\n", argv[i]);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--output") == 0 && i + 1 < argc) {
+            output_file_path = argv[++i];
+        } else if (strcmp(argv[i], "--uber") == 0) {
+            renderer.uber = true;
+        } else if (strcmp(argv[i], "--software") == 0) {
+            software = true;
+        } else if (strcmp(argv[i], "--damage") == 0) {
+            damaged = true;
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            threads = strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--entities") == 0 && i + 1 < argc) {
+            entities_count = strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--profile") == 0) {
+            profile = true;
+        } else if (strcmp(argv[i], "--gpu-budget") == 0 && i + 1 < argc) {
+            gpu_memory_set_budget((size_t) (atof(argv[++i])*1024*1024));
+        } else if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc) {
+            trace_file_path = argv[++i];
+        } else if (strcmp(argv[i], "--trace-csv") == 0 && i + 1 < argc) {
+            trace_csv_file_path = argv[++i];
+        } else {
+            usage(argv[0]);
+            fprintf(stderr, "ERROR: unknown flag %s\n", argv[i]);
+            return 1;
+        }
+    }
+
+    FT_Face face;
+    if (!app_load_face(APP_FONT_FILE_PATH, free_glyph_atlas_pixel_size(scale), &face)) {
+        return_defer(1);
+    }
+
+    if (software) {
+        if (!softrast_init(&softrast, width, height, threads)) return_defer(1);
+        printf("Renderer: software rasterizer (%zu threads)\n", softrast.threads_count + 1);
+        free_glyph_atlas_build(&atlas, face);
+        softrast.atlas = &atlas;
+        renderer_init_software(&renderer, &softrast);
+    } else {
+        if (!egl_context_init(&ctx)) return_defer(1);
+
+        glewExperimental = GL_TRUE;
+        GLenum glew_err = glewInit();
+        // GLEW built against GLX reports the missing X display after it already loaded the
+        // OpenGL entry points, which is all we need
+        if (glew_err != GLEW_OK && glew_err != GLEW_ERROR_NO_GLX_DISPLAY) {
+            fprintf(stderr, "ERROR: %s\n", glewGetErrorString(glew_err));
+            return_defer(1);
+        }
+
+        printf("OpenGL version:  %s\n", glGetString(GL_VERSION));
+        printf("OpenGL renderer: %s\n", glGetString(GL_RENDERER));
+
+        if (!framebuffer_init(&fb, width, height)) return_defer(1);
+
+        glEnable(GL_BLEND);
+        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        glClearColor(0, 0, 0, 1);
+
+        renderer_init(&renderer);
+        free_glyph_atlas_init(&atlas, face);
+    }
+    profiler_init(profile, !software);
+    profiler.hud = profile;
+    if ((trace_file_path || trace_csv_file_path) && !trace_init(trace_file_path, trace_csv_file_path)) {
+        return_defer(1);
+    }
+
+    App app = {0};
+    app_init(&app);
+    app_resize(&app, width, height, scale);
+    if (entities_count > 0) {
+        if (!entities_init(&entities, threads)) return_defer(1);
+        if (!entities_spawn(&entities, entities_count, app.size, 1)) return_defer(1);
+    }
+    Timestep timestep;
+    timestep_init(&timestep, sim_hz);
+    Renderer *r = &renderer;
+    if (damaged) {
+        recorder.uber = renderer.uber;
+        renderer_init_recording(&recorder, &list);
+        r = &recorder;
+    }
+
+    for (int frame = 0; frame < frames; ++frame) {
+        profiler_begin_frame();
+        r->time = (double) frame / fps;
+        r->resolution = v2f(width, height);
+        if (!software) framebuffer_bind(&fb);
+        if (damaged) {
+            render_list_reset(&list, width, height);
+        } else if (software) {
+            softrast_clear(&softrast, v4f(0, 0, 0, 1));
+        } else {
+            glClear(GL_COLOR_BUFFER_BIT);
+        }
+
+        size_t steps = timestep_advance(&timestep, r->time);
+        for (size_t i = 0; i < steps; ++i) {
+            app_update(&app);
+            if (entities_count > 0) entities_update(&entities, app.size, app.paused);
+        }
+        app_render(&app, r, &atlas, timestep_alpha(&timestep));
+        if (entities_count > 0) {
+            renderer_set_shader(r, SHADER_COLOR);
+            entities_render(&entities, r, timestep_alpha(&timestep), app.scale);
+            renderer_flush(r);
+        }
+        profiler_draw_hud(r, &atlas, scale);
+        if (damaged) {
+            renderer_end_frame(&recorder);
+            damage_compute(&damage, &list);
+            damage_draw(&damage, &list, &renderer, v4f(0, 0, 0, 1));
+        } else {
+            renderer_end_frame(&renderer);
+        }
+        profiler_end_frame();
+        trace_frame(&renderer.last_frame);
+        trace_flush();
+    }
+    if (!software) glFinish();
+
+    if (profile) {
+        for (Profiler_Scope s = 0; s < COUNT_PROFILER_SCOPES; ++s) {
+            Profiler_Stats stats = profiler_stats(s);
+            printf("%-9s min %8.3f avg %8.3f p99 %8.3f ms\n",
+                   profiler_scope_name(s), stats.min*1000.0, stats.avg*1000.0, stats.p99*1000.0);
+        }
+        renderer_print_stats(&renderer, stdout);
+        gpu_memory_report(stdout);
+        damage_report(&damage, stdout);
+    }
+
+    if (output_file_path) {
+        Errno err = software
+            ? softrast_save_ppm(&softrast, output_file_path)
+            : framebuffer_save_ppm(&fb, output_file_path);
+        if (err != 0) {
+            fprintf(stderr, "ERROR: Could not write %s: %s\n", output_file_path, strerror(err));
+            return_defer(1);
+        }
+        printf("Wrote %s\n", output_file_path);
+    }
+
+defer:
+    trace_shutdown();
+    render_list_destroy(&list);
+    damage_destroy(&damage);
+    if (fb.fbo) framebuffer_destroy(&fb);
+    if (softrast.pixels) softrast_destroy(&softrast);
+    if (entities.threads) entities_destroy(&entities);
+    egl_context_destroy(&ctx);
+    return result;
+}
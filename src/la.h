@@ -1,12 +1,41 @@
 #ifndef LA_H_
 #define LA_H_
 
+#include <limits.h>
 #include <math.h>
+#include <stddef.h>
+#include <string.h>
 
 #ifndef LADEF
 #define LADEF static inline
 #endif // LADEF
 
+// SIMD backend of the V2f, V3f and V4f operations, picked at compile time: SSE2 (floor and
+// ceil use SSE4.1 when enabled) on x86, NEON on AArch64. Define LA_NO_SIMD to get the plain
+// per component code. V2f and V3f only use it for the operations that call into libm or
+// divide, their sum, sub, mul and lerp are faster without packing the lanes (see the "la"
+// section of the benchmark). Both produce the same bits: lerp is never fused into an FMA and
+// min, max and clamp keep the NaN handling of fminf/fmaxf. The only exception is the sign
+// of min/max(+0, -0), which C leaves open and compilers already change by swapping the
+// operands. The transcendentals, sqrlen and len stay scalar.
+#if !defined(LA_NO_SIMD) && defined(__SSE2__)
+#define LA_SSE2
+#define LA_BACKEND "sse2"
+#include <emmintrin.h>
+#ifdef __SSE4_1__
+#include <smmintrin.h>
+#endif
+#elif !defined(LA_NO_SIMD) && defined(__aarch64__) && defined(__ARM_NEON)
+#define LA_NEON
+#define LA_BACKEND "neon"
+#include <arm_neon.h>
+#else
+#define LA_BACKEND "scalar"
+#endif
+#if defined(LA_SSE2) || defined(LA_NEON)
+#define LA_SIMD
+#endif
+
 LADEF float lerpf(float a, float b, float t);
 LADEF double lerp(double a, double b, double t);
 LADEF int mini(int a, int b);
@@ -367,9 +396,140 @@ LADEF V4u v4u_max(V4u a, V4u b);
 LADEF V4u v4u_clamp(V4u x, V4u a, V4u b);
 LADEF unsigned int v4u_sqrlen(V4u a);
 
+// Span kernels apply one operation to n elements of arrays, vectorized with the SIMD backend
+// and finished with scalar code for the components that do not fill a register. dst may
+// be one of the inputs, nothing has to be aligned. The results are the same as calling the
+// per element functions. spanf_* take plain float streams, e.g. one field of SoA data.
+LADEF void spanf_sum(float *dst, const float *a, const float *b, size_t n);
+LADEF void spanf_sub(float *dst, const float *a, const float *b, size_t n);
+LADEF void spanf_mul(float *dst, const float *a, const float *b, size_t n);
+LADEF void spanf_scale_add(float *dst, const float *a, const float *b, float s, size_t n); // a + b*s
+LADEF void spanf_lerp(float *dst, const float *a, const float *b, float t, size_t n);
+LADEF void spanf_min(float *dst, const float *a, const float *b, size_t n);
+LADEF void spanf_max(float *dst, const float *a, const float *b, size_t n);
+LADEF void spanf_clamp(float *dst, const float *x, float a, float b, size_t n);
+LADEF void span2f_sum(V2f *dst, const V2f *a, const V2f *b, size_t n);
+LADEF void span2f_sub(V2f *dst, const V2f *a, const V2f *b, size_t n);
+LADEF void span2f_mul(V2f *dst, const V2f *a, const V2f *b, size_t n);
+LADEF void span2f_scale_add(V2f *dst, const V2f *a, const V2f *b, float s, size_t n);
+LADEF void span2f_lerp(V2f *dst, const V2f *a, const V2f *b, float t, size_t n);
+LADEF void span2f_min(V2f *dst, const V2f *a, const V2f *b, size_t n);
+LADEF void span2f_max(V2f *dst, const V2f *a, const V2f *b, size_t n);
+LADEF void span2f_clamp(V2f *dst, const V2f *x, V2f a, V2f b, size_t n);
+LADEF void span4f_sum(V4f *dst, const V4f *a, const V4f *b, size_t n);
+LADEF void span4f_sub(V4f *dst, const V4f *a, const V4f *b, size_t n);
+LADEF void span4f_mul(V4f *dst, const V4f *a, const V4f *b, size_t n);
+LADEF void span4f_scale_add(V4f *dst, const V4f *a, const V4f *b, float s, size_t n);
+LADEF void span4f_lerp(V4f *dst, const V4f *a, const V4f *b, float t, size_t n);
+LADEF void span4f_min(V4f *dst, const V4f *a, const V4f *b, size_t n);
+LADEF void span4f_max(V4f *dst, const V4f *a, const V4f *b, size_t n);
+LADEF void span4f_clamp(V4f *dst, const V4f *x, V4f a, V4f b, size_t n);
+
+// Approximations of sinf, cosf, exp2f, log2f and powf for animation and particle code:
+// polynomials and exponent bit tricks instead of calls into libm. The V2f, V3f, V4f and span
+// variants compute four lanes at once with the SIMD backend and give the same bits as the
+// scalar functions. The bounds are the maximum errors against libm inside of the domain,
+// checked by the "la" section of the benchmark. Outside of it, for infinities and NaN the
+// results are unspecified. There is no sqrt variant, v*f_sqrt is a single instruction with
+// the SIMD backend already.
+#define LA_FAST_TRIG_DOMAIN    8192.0f // |x| for sin and cos
+#define LA_FAST_SIN_MAX_ERROR  2.5e-7f // Absolute, also for cos
+#define LA_FAST_EXP2_MAX_ERROR 3e-7f   // Relative, -126 <= x <= 127
+#define LA_FAST_LOG2_MAX_ERROR 2e-7f   // Absolute, relative for |log2(x)| > 1, x positive and normal
+#define LA_FAST_POW_MAX_ERROR  2.5e-6f // Relative, base positive and normal, |exp*log2(base)| <= 32
+LADEF float sinf_fast(float x);
+LADEF float cosf_fast(float x);
+LADEF float exp2f_fast(float x);
+LADEF float log2f_fast(float x);
+LADEF float powf_fast(float base, float exp);
+LADEF V2f v2f_sin_fast(V2f a);
+LADEF V2f v2f_cos_fast(V2f a);
+LADEF V2f v2f_pow_fast(V2f base, V2f exp);
+LADEF V3f v3f_sin_fast(V3f a);
+LADEF V3f v3f_cos_fast(V3f a);
+LADEF V3f v3f_pow_fast(V3f base, V3f exp);
+LADEF V4f v4f_sin_fast(V4f a);
+LADEF V4f v4f_cos_fast(V4f a);
+LADEF V4f v4f_pow_fast(V4f base, V4f exp);
+// n floats, pass &v->x and n*2 or n*4 for arrays of vectors
+LADEF void spanf_sin_fast(float *dst, const float *a, size_t n);
+LADEF void spanf_cos_fast(float *dst, const float *a, size_t n);
+LADEF void spanf_exp2_fast(float *dst, const float *a, size_t n);
+LADEF void spanf_log2_fast(float *dst, const float *a, size_t n);
+LADEF void spanf_pow_fast(float *dst, const float *base, const float *exp, size_t n);
+
+// Packed storage for vertex attributes and CPU side images: IEEE half floats, unsigned
+// normalized 16 bit (0..65535 is 0..1) and 8 bit RGBA. Halves round to nearest even,
+// overflow to infinity and keep NaN. Unorm packing clamps to [0, 1] (NaN becomes 0) and
+// rounds x*max to the nearest code: exactly for unorm16, from the float product for
+// unorm8, which can only be off for inputs within 2^-24 of the halfway point. Unpacking is exact for halves and
+// the correctly rounded code/max for unorm. The sRGB variants apply the sRGB transfer
+// function to the color channels and keep alpha linear. They go through powf_fast: encoding
+// can be one code off within 1e-3 of the halfway point, decoding is within 1e-5 relative.
+// The "packs" entries of the benchmark check all of this.
+typedef struct { unsigned short x, y; } V2h;
+typedef struct { unsigned short x, y, z, w; } V4h;
+typedef struct { unsigned short x, y; } V2n;
+typedef struct { unsigned char r, g, b, a; } Rgba8;
+
+LADEF unsigned short f2h(float x);
+LADEF float h2f(unsigned short h);
+LADEF unsigned short f2unorm16(float x);
+LADEF float unorm162f(unsigned short u);
+LADEF unsigned char f2unorm8(float x);
+LADEF float unorm82f(unsigned char u);
+LADEF float linear2srgb(float x); // x is clamped to [0, 1]
+LADEF float srgb2linear(float x); // x in [0, 1]
+LADEF V2h v2h2f(V2f a);
+LADEF V2f v2f2h(V2h a);
+LADEF V4h v4h4f(V4f a);
+LADEF V4f v4f4h(V4h a);
+LADEF V2n v2n2f(V2f a);
+LADEF V2f v2f2n(V2n a);
+LADEF Rgba8 rgba8_from_v4f(V4f a);
+LADEF Rgba8 rgba8_from_v4f_srgb(V4f a);
+LADEF V4f v4f_from_rgba8(Rgba8 a);
+LADEF V4f v4f_from_rgba8_srgb(Rgba8 a);
+// Bulk converters, SIMD like the other spans. The half and unorm16 ones take n floats,
+// pass &v->x and n*2 or n*4 for arrays of V2h, V4h and V2n.
+LADEF void spanf_to_half(unsigned short *dst, const float *src, size_t n);
+LADEF void spanf_from_half(float *dst, const unsigned short *src, size_t n);
+LADEF void spanf_to_unorm16(unsigned short *dst, const float *src, size_t n);
+LADEF void spanf_from_unorm16(float *dst, const unsigned short *src, size_t n);
+LADEF void span4f_to_rgba8(Rgba8 *dst, const V4f *src, size_t n);
+LADEF void span4f_to_rgba8_srgb(Rgba8 *dst, const V4f *src, size_t n);
+LADEF void span4f_from_rgba8(V4f *dst, const Rgba8 *src, size_t n);
+LADEF void span4f_from_rgba8_srgb(V4f *dst, const Rgba8 *src, size_t n);
+
+// Column major like GLSL, c[i] is the i-th column. M3f is a 2D transform with the
+// translation in c[2], the w of its columns is padding (kept at 0) so that every column
+// fits a SIMD register, the same layout std140 uses for mat3.
+typedef struct { V4f c[3]; } M3f;
+typedef struct { V4f c[4]; } M4f;
+
+LADEF M3f m3f_identity(void);
+LADEF M3f m3f_translate(V2f t);
+LADEF M3f m3f_scale(V2f s);
+LADEF M3f m3f_rotate(float angle); // Counter clockwise with y up, clockwise on the screen
+LADEF M3f m3f_mul(M3f a, M3f b); // Applies b first, then a
+LADEF M3f m3f_inverse(M3f m); // Singular matrices give non finite entries
+LADEF V2f m3f_transform_point(M3f m, V2f p); // Affine, the last row of m is ignored
+LADEF void m3f_transform_points(M3f m, V2f *dst, const V2f *src, size_t n);
+LADEF M4f m4f_identity(void);
+LADEF M4f m4f_translate(V3f t);
+LADEF M4f m4f_scale(V3f s);
+LADEF M4f m4f_rotate_z(float angle);
+LADEF M4f m4f_ortho(float left, float right, float bottom, float top, float z_near, float z_far);
+LADEF M4f m4f_mul(M4f a, M4f b); // Applies b first, then a
+LADEF M4f m4f_inverse(M4f m); // Singular matrices give non finite entries
+LADEF V4f m4f_transform(M4f m, V4f v);
+LADEF void m4f_transform_points(M4f m, V4f *dst, const V4f *src, size_t n);
+
 #endif // LA_H_
 
-#ifdef LA_IMPLEMENTATION
+// Several headers may include la.h after LA_IMPLEMENTATION was defined
+#if defined(LA_IMPLEMENTATION) && !defined(LA_IMPLEMENTED_)
+#define LA_IMPLEMENTED_
 
 LADEF float lerpf(float a, float b, float t)
 {
@@ -421,6 +581,259 @@ LADEF unsigned int clampu(unsigned int x, unsigned int a, unsigned int b)
     return minu(maxu(a, x), b);
 }
 
+#ifdef LA_SIMD
+// Four float lanes, the V2f and V3f variants leave the upper lanes at zero
+#ifdef LA_SSE2
+typedef __m128 La_F4;
+#define la_f4_add  _mm_add_ps
+#define la_f4_sub  _mm_sub_ps
+#define la_f4_mul  _mm_mul_ps
+#define la_f4_div  _mm_div_ps
+#define la_f4_sqrt _mm_sqrt_ps
+
+static inline La_F4 la_f4_load(float x, float y, float z, float w)
+{
+    return _mm_setr_ps(x, y, z, w);
+}
+
+static inline void la_f4_store(float *f, La_F4 v)
+{
+    _mm_storeu_ps(f, v);
+}
+
+#define la_f4_loadu _mm_loadu_ps
+#define la_f4_set1  _mm_set1_ps
+#define la_f4_splat(v, i) _mm_shuffle_ps((v), (v), _MM_SHUFFLE(i, i, i, i))
+// (v0, v0, v2, v2) and (v1, v1, v3, v3)
+#define la_f4_dup_even(v) _mm_shuffle_ps((v), (v), _MM_SHUFFLE(2, 2, 0, 0))
+#define la_f4_dup_odd(v)  _mm_shuffle_ps((v), (v), _MM_SHUFFLE(3, 3, 1, 1))
+
+// Four int32 lanes for the bit tricks of the _fast functions, shr is a logical shift and
+// la_f4_gt gives all bits set in the lanes where a > b
+typedef __m128i La_I4;
+#define la_f4_as_i4   _mm_castps_si128
+#define la_i4_as_f4   _mm_castsi128_ps
+#define la_i4_from_f4 _mm_cvttps_epi32
+#define la_f4_from_i4 _mm_cvtepi32_ps
+#define la_i4_set1    _mm_set1_epi32
+#define la_i4_add     _mm_add_epi32
+#define la_i4_sub     _mm_sub_epi32
+#define la_i4_and     _mm_and_si128
+#define la_i4_or      _mm_or_si128
+#define la_i4_xor     _mm_xor_si128
+#define la_i4_shl     _mm_slli_epi32
+#define la_i4_shr     _mm_srli_epi32
+#define la_f4_gt(a, b) _mm_castps_si128(_mm_cmpgt_ps((a), (b)))
+#define la_i4_gt      _mm_cmpgt_epi32
+#define la_i4_eq      _mm_cmpeq_epi32
+
+static inline La_I4 la_i4_select(La_I4 mask, La_I4 a, La_I4 b)
+{
+    return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+
+static inline La_F4 la_f4_select(La_I4 mask, La_F4 a, La_F4 b)
+{
+    La_F4 m = _mm_castsi128_ps(mask);
+    return _mm_or_ps(_mm_and_ps(m, a), _mm_andnot_ps(m, b));
+}
+
+// Zero extend 4 unsigned shorts or bytes into the lanes and narrow them back, the stored
+// lanes have to fit the narrower type
+static inline La_I4 la_i4_load_u16(const unsigned short *src)
+{
+    return _mm_unpacklo_epi16(_mm_loadl_epi64((const __m128i *) src), _mm_setzero_si128());
+}
+
+static inline void la_i4_store_u16(unsigned short *dst, La_I4 v)
+{
+    // packs saturates to signed shorts, sign extending the low halves keeps their bits
+    v = _mm_srai_epi32(_mm_slli_epi32(v, 16), 16);
+    _mm_storel_epi64((__m128i *) dst, _mm_packs_epi32(v, v));
+}
+
+// Rounds x*scale to the nearest int in double precision, the product is exact for scales
+// of up to 29 significant bits
+static inline La_I4 la_i4_round_f4_wide(La_F4 x, double scale)
+{
+    const __m128d s = _mm_set1_pd(scale), half = _mm_set1_pd(0.5);
+    __m128i lo = _mm_cvttpd_epi32(_mm_add_pd(_mm_mul_pd(_mm_cvtps_pd(x), s), half));
+    __m128i hi = _mm_cvttpd_epi32(_mm_add_pd(_mm_mul_pd(_mm_cvtps_pd(_mm_movehl_ps(x, x)), s), half));
+    return _mm_unpacklo_epi64(lo, hi);
+}
+
+static inline La_I4 la_i4_load_u8(const unsigned char *src)
+{
+    int bytes;
+    memcpy(&bytes, src, sizeof(bytes));
+    __m128i v = _mm_unpacklo_epi8(_mm_cvtsi32_si128(bytes), _mm_setzero_si128());
+    return _mm_unpacklo_epi16(v, _mm_setzero_si128());
+}
+
+static inline void la_i4_store_u8(unsigned char *dst, La_I4 v)
+{
+    v = _mm_packs_epi32(v, v);
+    int bytes = _mm_cvtsi128_si32(_mm_packus_epi16(v, v));
+    memcpy(dst, &bytes, sizeof(bytes));
+}
+
+// minps and maxps return b when either operand is NaN, fminf and fmaxf the other operand
+static inline La_F4 la_f4_min(La_F4 a, La_F4 b)
+{
+    La_F4 b_nan = _mm_cmpunord_ps(b, b);
+    return _mm_or_ps(_mm_and_ps(b_nan, a), _mm_andnot_ps(b_nan, _mm_min_ps(a, b)));
+}
+
+static inline La_F4 la_f4_max(La_F4 a, La_F4 b)
+{
+    La_F4 b_nan = _mm_cmpunord_ps(b, b);
+    return _mm_or_ps(_mm_and_ps(b_nan, a), _mm_andnot_ps(b_nan, _mm_max_ps(a, b)));
+}
+
+#ifdef __SSE4_1__
+#define la_f4_floor _mm_floor_ps
+#define la_f4_ceil  _mm_ceil_ps
+#else
+// Rounds through int32. |a| >= 2^23, infinities and NaN are integral already and passed
+// through, the sign of a is kept for results of zero.
+static inline La_F4 la_f4_round_fixup(La_F4 a, La_F4 rounded)
+{
+    const La_F4 sign = _mm_set1_ps(-0.0f);
+    La_F4 small = _mm_cmplt_ps(_mm_andnot_ps(sign, a), _mm_set1_ps(8388608.0f));
+    rounded = _mm_or_ps(rounded, _mm_and_ps(a, sign));
+    return _mm_or_ps(_mm_and_ps(small, rounded), _mm_andnot_ps(small, a));
+}
+
+static inline La_F4 la_f4_floor(La_F4 a)
+{
+    La_F4 t = _mm_cvtepi32_ps(_mm_cvttps_epi32(a));
+    t = _mm_sub_ps(t, _mm_and_ps(_mm_cmpgt_ps(t, a), _mm_set1_ps(1.0f)));
+    return la_f4_round_fixup(a, t);
+}
+
+static inline La_F4 la_f4_ceil(La_F4 a)
+{
+    La_F4 t = _mm_cvtepi32_ps(_mm_cvttps_epi32(a));
+    t = _mm_add_ps(t, _mm_and_ps(_mm_cmplt_ps(t, a), _mm_set1_ps(1.0f)));
+    return la_f4_round_fixup(a, t);
+}
+#endif // __SSE4_1__
+#endif // LA_SSE2
+
+#ifdef LA_NEON
+typedef float32x4_t La_F4;
+#define la_f4_add   vaddq_f32
+#define la_f4_sub   vsubq_f32
+#define la_f4_mul   vmulq_f32
+#define la_f4_div   vdivq_f32
+#define la_f4_sqrt  vsqrtq_f32
+// IEEE minNum/maxNum, same NaN handling as fminf/fmaxf
+#define la_f4_min   vminnmq_f32
+#define la_f4_max   vmaxnmq_f32
+#define la_f4_floor vrndmq_f32
+#define la_f4_ceil  vrndpq_f32
+
+static inline La_F4 la_f4_load(float x, float y, float z, float w)
+{
+    float f[4] = {x, y, z, w};
+    return vld1q_f32(f);
+}
+
+static inline void la_f4_store(float *f, La_F4 v)
+{
+    vst1q_f32(f, v);
+}
+
+#define la_f4_loadu vld1q_f32
+#define la_f4_set1  vdupq_n_f32
+#define la_f4_splat(v, i) vdupq_laneq_f32((v), (i))
+#define la_f4_dup_even(v) vtrn1q_f32((v), (v))
+#define la_f4_dup_odd(v)  vtrn2q_f32((v), (v))
+
+typedef int32x4_t La_I4;
+#define la_f4_as_i4   vreinterpretq_s32_f32
+#define la_i4_as_f4   vreinterpretq_f32_s32
+#define la_i4_from_f4 vcvtq_s32_f32
+#define la_f4_from_i4 vcvtq_f32_s32
+#define la_i4_set1    vdupq_n_s32
+#define la_i4_add     vaddq_s32
+#define la_i4_sub     vsubq_s32
+#define la_i4_and     vandq_s32
+#define la_i4_or      vorrq_s32
+#define la_i4_xor     veorq_s32
+#define la_i4_shl(v, n) vshlq_n_s32((v), (n))
+#define la_i4_shr(v, n) vreinterpretq_s32_u32(vshrq_n_u32(vreinterpretq_u32_s32(v), (n)))
+#define la_f4_gt(a, b)  vreinterpretq_s32_u32(vcgtq_f32((a), (b)))
+#define la_i4_gt(a, b)  vreinterpretq_s32_u32(vcgtq_s32((a), (b)))
+#define la_i4_eq(a, b)  vreinterpretq_s32_u32(vceqq_s32((a), (b)))
+#define la_i4_select(m, a, b) vbslq_s32(vreinterpretq_u32_s32(m), (a), (b))
+#define la_f4_select(m, a, b) vbslq_f32(vreinterpretq_u32_s32(m), (a), (b))
+#define la_i4_load_u16(src)     vreinterpretq_s32_u32(vmovl_u16(vld1_u16(src)))
+#define la_i4_store_u16(dst, v) vst1_u16((dst), vmovn_u32(vreinterpretq_u32_s32(v)))
+
+static inline La_I4 la_i4_round_f4_wide(La_F4 x, double scale)
+{
+    const float64x2_t s = vdupq_n_f64(scale), half = vdupq_n_f64(0.5);
+    int64x2_t lo = vcvtq_s64_f64(vaddq_f64(vmulq_f64(vcvt_f64_f32(vget_low_f32(x)), s), half));
+    int64x2_t hi = vcvtq_s64_f64(vaddq_f64(vmulq_f64(vcvt_high_f64_f32(x), s), half));
+    return vcombine_s32(vmovn_s64(lo), vmovn_s64(hi));
+}
+
+static inline La_I4 la_i4_load_u8(const unsigned char *src)
+{
+    unsigned int bytes;
+    memcpy(&bytes, src, sizeof(bytes));
+    uint8x8_t b = vreinterpret_u8_u32(vdup_n_u32(bytes));
+    return vreinterpretq_s32_u32(vmovl_u16(vget_low_u16(vmovl_u8(b))));
+}
+
+static inline void la_i4_store_u8(unsigned char *dst, La_I4 v)
+{
+    uint16x4_t h = vmovn_u32(vreinterpretq_u32_s32(v));
+    unsigned int bytes = vget_lane_u32(vreinterpret_u32_u8(vmovn_u16(vcombine_u16(h, h))), 0);
+    memcpy(dst, &bytes, sizeof(bytes));
+}
+#endif // LA_NEON
+
+static inline La_F4 la_f4_lerp(La_F4 a, La_F4 b, La_F4 t)
+{
+    return la_f4_add(a, la_f4_mul(la_f4_sub(b, a), t));
+}
+
+static inline La_F4 la_f4_clamp(La_F4 x, La_F4 a, La_F4 b)
+{
+    return la_f4_min(la_f4_max(a, x), b);
+}
+
+#define la_f4_2f(a) la_f4_load((a).x, (a).y, 0.0f, 0.0f)
+#define la_f4_3f(a) la_f4_load((a).x, (a).y, (a).z, 0.0f)
+#define la_f4_4f(a) la_f4_load((a).x, (a).y, (a).z, (a).w)
+
+static inline V2f la_f4_to_v2f(La_F4 v)
+{
+    float f[4];
+    la_f4_store(f, v);
+    V2f r = {f[0], f[1]};
+    return r;
+}
+
+static inline V3f la_f4_to_v3f(La_F4 v)
+{
+    float f[4];
+    la_f4_store(f, v);
+    V3f r = {f[0], f[1], f[2]};
+    return r;
+}
+
+static inline V4f la_f4_to_v4f(La_F4 v)
+{
+    float f[4];
+    la_f4_store(f, v);
+    V4f r = {f[0], f[1], f[2], f[3]};
+    return r;
+}
+#endif // LA_SIMD
+
 LADEF V2f v2f(float x, float y)
 {
     V2f v;
@@ -545,16 +958,24 @@ LADEF V2f v2f_mul(V2f a, V2f b)
 
 LADEF V2f v2f_div(V2f a, V2f b)
 {
+#ifdef LA_SIMD
+    return la_f4_to_v2f(la_f4_div(la_f4_2f(a), la_f4_2f(b)));
+#else
     a.x /= b.x;
     a.y /= b.y;
     return a;
+#endif // LA_SIMD
 }
 
 LADEF V2f v2f_sqrt(V2f a)
 {
+#ifdef LA_SIMD
+    return la_f4_to_v2f(la_f4_sqrt(la_f4_2f(a)));
+#else
     a.x = sqrtf(a.x);
     a.y = sqrtf(a.y);
     return a;
+#endif // LA_SIMD
 }
 
 LADEF V2f v2f_pow(V2f base, V2f exp)
@@ -580,16 +1001,24 @@ LADEF V2f v2f_cos(V2f a)
 
 LADEF V2f v2f_min(V2f a, V2f b)
 {
+#ifdef LA_SIMD
+    return la_f4_to_v2f(la_f4_min(la_f4_2f(a), la_f4_2f(b)));
+#else
     a.x = fminf(a.x, b.x);
     a.y = fminf(a.y, b.y);
     return a;
+#endif // LA_SIMD
 }
 
 LADEF V2f v2f_max(V2f a, V2f b)
 {
+#ifdef LA_SIMD
+    return la_f4_to_v2f(la_f4_max(la_f4_2f(a), la_f4_2f(b)));
+#else
     a.x = fmaxf(a.x, b.x);
     a.y = fmaxf(a.y, b.y);
     return a;
+#endif // LA_SIMD
 }
 
 LADEF V2f v2f_lerp(V2f a, V2f b, V2f t)
@@ -601,23 +1030,35 @@ LADEF V2f v2f_lerp(V2f a, V2f b, V2f t)
 
 LADEF V2f v2f_floor(V2f a)
 {
+#ifdef LA_SIMD
+    return la_f4_to_v2f(la_f4_floor(la_f4_2f(a)));
+#else
     a.x = floorf(a.x);
     a.y = floorf(a.y);
     return a;
+#endif // LA_SIMD
 }
 
 LADEF V2f v2f_ceil(V2f a)
 {
+#ifdef LA_SIMD
+    return la_f4_to_v2f(la_f4_ceil(la_f4_2f(a)));
+#else
     a.x = ceilf(a.x);
     a.y = ceilf(a.y);
     return a;
+#endif // LA_SIMD
 }
 
 LADEF V2f v2f_clamp(V2f x, V2f a, V2f b)
 {
+#ifdef LA_SIMD
+    return la_f4_to_v2f(la_f4_clamp(la_f4_2f(x), la_f4_2f(a), la_f4_2f(b)));
+#else
     x.x = clampf(x.x, a.x, b.x);
     x.y = clampf(x.y, a.y, b.y);
     return x;
+#endif // LA_SIMD
 }
 
 LADEF float v2f_sqrlen(V2f a)
@@ -1288,18 +1729,26 @@ LADEF V3f v3f_mul(V3f a, V3f b)
 
 LADEF V3f v3f_div(V3f a, V3f b)
 {
+#ifdef LA_SIMD
+    return la_f4_to_v3f(la_f4_div(la_f4_3f(a), la_f4_3f(b)));
+#else
     a.x /= b.x;
     a.y /= b.y;
     a.z /= b.z;
     return a;
+#endif // LA_SIMD
 }
 
 LADEF V3f v3f_sqrt(V3f a)
 {
+#ifdef LA_SIMD
+    return la_f4_to_v3f(la_f4_sqrt(la_f4_3f(a)));
+#else
     a.x = sqrtf(a.x);
     a.y = sqrtf(a.y);
     a.z = sqrtf(a.z);
     return a;
+#endif // LA_SIMD
 }
 
 LADEF V3f v3f_pow(V3f base, V3f exp)
@@ -1328,18 +1777,26 @@ LADEF V3f v3f_cos(V3f a)
 
 LADEF V3f v3f_min(V3f a, V3f b)
 {
+#ifdef LA_SIMD
+    return la_f4_to_v3f(la_f4_min(la_f4_3f(a), la_f4_3f(b)));
+#else
     a.x = fminf(a.x, b.x);
     a.y = fminf(a.y, b.y);
     a.z = fminf(a.z, b.z);
     return a;
+#endif // LA_SIMD
 }
 
 LADEF V3f v3f_max(V3f a, V3f b)
 {
+#ifdef LA_SIMD
+    return la_f4_to_v3f(la_f4_max(la_f4_3f(a), la_f4_3f(b)));
+#else
     a.x = fmaxf(a.x, b.x);
     a.y = fmaxf(a.y, b.y);
     a.z = fmaxf(a.z, b.z);
     return a;
+#endif // LA_SIMD
 }
 
 LADEF V3f v3f_lerp(V3f a, V3f b, V3f t)
@@ -1352,26 +1809,38 @@ LADEF V3f v3f_lerp(V3f a, V3f b, V3f t)
 
 LADEF V3f v3f_floor(V3f a)
 {
+#ifdef LA_SIMD
+    return la_f4_to_v3f(la_f4_floor(la_f4_3f(a)));
+#else
     a.x = floorf(a.x);
     a.y = floorf(a.y);
     a.z = floorf(a.z);
     return a;
+#endif // LA_SIMD
 }
 
 LADEF V3f v3f_ceil(V3f a)
 {
+#ifdef LA_SIMD
+    return la_f4_to_v3f(la_f4_ceil(la_f4_3f(a)));
+#else
     a.x = ceilf(a.x);
     a.y = ceilf(a.y);
     a.z = ceilf(a.z);
     return a;
+#endif // LA_SIMD
 }
 
 LADEF V3f v3f_clamp(V3f x, V3f a, V3f b)
 {
+#ifdef LA_SIMD
+    return la_f4_to_v3f(la_f4_clamp(la_f4_3f(x), la_f4_3f(a), la_f4_3f(b)));
+#else
     x.x = clampf(x.x, a.x, b.x);
     x.y = clampf(x.y, a.y, b.y);
     x.z = clampf(x.z, a.z, b.z);
     return x;
+#endif // LA_SIMD
 }
 
 LADEF float v3f_sqrlen(V3f a)
@@ -2094,47 +2563,67 @@ LADEF V4f v4f4u(V4u a)
 
 LADEF V4f v4f_sum(V4f a, V4f b)
 {
+#ifdef LA_SIMD
+    return la_f4_to_v4f(la_f4_add(la_f4_4f(a), la_f4_4f(b)));
+#else
     a.x += b.x;
     a.y += b.y;
     a.z += b.z;
     a.w += b.w;
     return a;
+#endif // LA_SIMD
 }
 
 LADEF V4f v4f_sub(V4f a, V4f b)
 {
+#ifdef LA_SIMD
+    return la_f4_to_v4f(la_f4_sub(la_f4_4f(a), la_f4_4f(b)));
+#else
     a.x -= b.x;
     a.y -= b.y;
     a.z -= b.z;
     a.w -= b.w;
     return a;
+#endif // LA_SIMD
 }
 
 LADEF V4f v4f_mul(V4f a, V4f b)
 {
+#ifdef LA_SIMD
+    return la_f4_to_v4f(la_f4_mul(la_f4_4f(a), la_f4_4f(b)));
+#else
     a.x *= b.x;
     a.y *= b.y;
     a.z *= b.z;
     a.w *= b.w;
     return a;
+#endif // LA_SIMD
 }
 
 LADEF V4f v4f_div(V4f a, V4f b)
 {
+#ifdef LA_SIMD
+    return la_f4_to_v4f(la_f4_div(la_f4_4f(a), la_f4_4f(b)));
+#else
     a.x /= b.x;
     a.y /= b.y;
     a.z /= b.z;
     a.w /= b.w;
     return a;
+#endif // LA_SIMD
 }
 
 LADEF V4f v4f_sqrt(V4f a)
 {
+#ifdef LA_SIMD
+    return la_f4_to_v4f(la_f4_sqrt(la_f4_4f(a)));
+#else
     a.x = sqrtf(a.x);
     a.y = sqrtf(a.y);
     a.z = sqrtf(a.z);
     a.w = sqrtf(a.w);
     return a;
+#endif // LA_SIMD
 }
 
 LADEF V4f v4f_pow(V4f base, V4f exp)
@@ -2166,56 +2655,80 @@ LADEF V4f v4f_cos(V4f a)
 
 LADEF V4f v4f_min(V4f a, V4f b)
 {
+#ifdef LA_SIMD
+    return la_f4_to_v4f(la_f4_min(la_f4_4f(a), la_f4_4f(b)));
+#else
     a.x = fminf(a.x, b.x);
     a.y = fminf(a.y, b.y);
     a.z = fminf(a.z, b.z);
     a.w = fminf(a.w, b.w);
     return a;
+#endif // LA_SIMD
 }
 
 LADEF V4f v4f_max(V4f a, V4f b)
 {
+#ifdef LA_SIMD
+    return la_f4_to_v4f(la_f4_max(la_f4_4f(a), la_f4_4f(b)));
+#else
     a.x = fmaxf(a.x, b.x);
     a.y = fmaxf(a.y, b.y);
     a.z = fmaxf(a.z, b.z);
     a.w = fmaxf(a.w, b.w);
     return a;
+#endif // LA_SIMD
 }
 
 LADEF V4f v4f_lerp(V4f a, V4f b, V4f t)
 {
+#ifdef LA_SIMD
+    return la_f4_to_v4f(la_f4_lerp(la_f4_4f(a), la_f4_4f(b), la_f4_4f(t)));
+#else
     a.x = lerpf(a.x, b.x, t.x);
     a.y = lerpf(a.y, b.y, t.y);
     a.z = lerpf(a.z, b.z, t.z);
     a.w = lerpf(a.w, b.w, t.w);
     return a;
+#endif // LA_SIMD
 }
 
 LADEF V4f v4f_floor(V4f a)
 {
+#ifdef LA_SIMD
+    return la_f4_to_v4f(la_f4_floor(la_f4_4f(a)));
+#else
     a.x = floorf(a.x);
     a.y = floorf(a.y);
     a.z = floorf(a.z);
     a.w = floorf(a.w);
     return a;
+#endif // LA_SIMD
 }
 
 LADEF V4f v4f_ceil(V4f a)
 {
+#ifdef LA_SIMD
+    return la_f4_to_v4f(la_f4_ceil(la_f4_4f(a)));
+#else
     a.x = ceilf(a.x);
     a.y = ceilf(a.y);
     a.z = ceilf(a.z);
     a.w = ceilf(a.w);
     return a;
+#endif // LA_SIMD
 }
 
 LADEF V4f v4f_clamp(V4f x, V4f a, V4f b)
 {
+#ifdef LA_SIMD
+    return la_f4_to_v4f(la_f4_clamp(la_f4_4f(x), la_f4_4f(a), la_f4_4f(b)));
+#else
     x.x = clampf(x.x, a.x, b.x);
     x.y = clampf(x.y, a.y, b.y);
     x.z = clampf(x.z, a.z, b.z);
     x.w = clampf(x.w, a.w, b.w);
     return x;
+#endif // LA_SIMD
 }
 
 LADEF float v4f_sqrlen(V4f a)
@@ -2875,4 +3388,1001 @@ LADEF unsigned int v4u_sqrlen(V4u a)
     return a.x*a.x + a.y*a.y + a.z*a.z + a.w*a.w;
 }
 
+// The spans work on the flat floats of the arrays: n is the amount of floats, the bounds
+// of clamp repeat every 1, 2 or 4 floats and are passed as 4 floats
+#ifdef LA_SIMD
+#define LA_SPAN_SIMD(expr) for (; i + 4 <= n; i += 4) la_f4_store(dst + i, (expr))
+#else
+#define LA_SPAN_SIMD(expr)
+#endif // LA_SIMD
+
+static inline void la_span_sum(float *dst, const float *a, const float *b, size_t n)
+{
+    size_t i = 0;
+    LA_SPAN_SIMD(la_f4_add(la_f4_loadu(a + i), la_f4_loadu(b + i)));
+    for (; i < n; ++i) dst[i] = a[i] + b[i];
+}
+
+static inline void la_span_sub(float *dst, const float *a, const float *b, size_t n)
+{
+    size_t i = 0;
+    LA_SPAN_SIMD(la_f4_sub(la_f4_loadu(a + i), la_f4_loadu(b + i)));
+    for (; i < n; ++i) dst[i] = a[i] - b[i];
+}
+
+static inline void la_span_mul(float *dst, const float *a, const float *b, size_t n)
+{
+    size_t i = 0;
+    LA_SPAN_SIMD(la_f4_mul(la_f4_loadu(a + i), la_f4_loadu(b + i)));
+    for (; i < n; ++i) dst[i] = a[i] * b[i];
+}
+
+static inline void la_span_scale_add(float *dst, const float *a, const float *b, float s, size_t n)
+{
+    size_t i = 0;
+#ifdef LA_SIMD
+    La_F4 s4 = la_f4_set1(s);
+#endif // LA_SIMD
+    LA_SPAN_SIMD(la_f4_add(la_f4_loadu(a + i), la_f4_mul(la_f4_loadu(b + i), s4)));
+    for (; i < n; ++i) dst[i] = a[i] + b[i]*s;
+}
+
+static inline void la_span_lerp(float *dst, const float *a, const float *b, float t, size_t n)
+{
+    size_t i = 0;
+#ifdef LA_SIMD
+    La_F4 t4 = la_f4_set1(t);
+#endif // LA_SIMD
+    LA_SPAN_SIMD(la_f4_lerp(la_f4_loadu(a + i), la_f4_loadu(b + i), t4));
+    for (; i < n; ++i) dst[i] = lerpf(a[i], b[i], t);
+}
+
+static inline void la_span_min(float *dst, const float *a, const float *b, size_t n)
+{
+    size_t i = 0;
+    LA_SPAN_SIMD(la_f4_min(la_f4_loadu(a + i), la_f4_loadu(b + i)));
+    for (; i < n; ++i) dst[i] = fminf(a[i], b[i]);
+}
+
+static inline void la_span_max(float *dst, const float *a, const float *b, size_t n)
+{
+    size_t i = 0;
+    LA_SPAN_SIMD(la_f4_max(la_f4_loadu(a + i), la_f4_loadu(b + i)));
+    for (; i < n; ++i) dst[i] = fmaxf(a[i], b[i]);
+}
+
+// i is a multiple of 4 after the SIMD loop, so i%4 still lines up with the period
+static inline void la_span_clamp(float *dst, const float *x, const float a[4], const float b[4], size_t n)
+{
+    size_t i = 0;
+#ifdef LA_SIMD
+    La_F4 a4 = la_f4_loadu(a);
+    La_F4 b4 = la_f4_loadu(b);
+#endif // LA_SIMD
+    LA_SPAN_SIMD(la_f4_clamp(la_f4_loadu(x + i), a4, b4));
+    for (; i < n; ++i) dst[i] = clampf(x[i], a[i%4], b[i%4]);
+}
+
+LADEF void spanf_sum(float *dst, const float *a, const float *b, size_t n)
+{
+    la_span_sum(dst, a, b, n);
+}
+
+LADEF void spanf_sub(float *dst, const float *a, const float *b, size_t n)
+{
+    la_span_sub(dst, a, b, n);
+}
+
+LADEF void spanf_mul(float *dst, const float *a, const float *b, size_t n)
+{
+    la_span_mul(dst, a, b, n);
+}
+
+LADEF void spanf_scale_add(float *dst, const float *a, const float *b, float s, size_t n)
+{
+    la_span_scale_add(dst, a, b, s, n);
+}
+
+LADEF void spanf_lerp(float *dst, const float *a, const float *b, float t, size_t n)
+{
+    la_span_lerp(dst, a, b, t, n);
+}
+
+LADEF void spanf_min(float *dst, const float *a, const float *b, size_t n)
+{
+    la_span_min(dst, a, b, n);
+}
+
+LADEF void spanf_max(float *dst, const float *a, const float *b, size_t n)
+{
+    la_span_max(dst, a, b, n);
+}
+
+LADEF void spanf_clamp(float *dst, const float *x, float a, float b, size_t n)
+{
+    const float a4[4] = {a, a, a, a};
+    const float b4[4] = {b, b, b, b};
+    la_span_clamp(dst, x, a4, b4, n);
+}
+
+LADEF void span2f_sum(V2f *dst, const V2f *a, const V2f *b, size_t n)
+{
+    la_span_sum(&dst->x, &a->x, &b->x, n*2);
+}
+
+LADEF void span2f_sub(V2f *dst, const V2f *a, const V2f *b, size_t n)
+{
+    la_span_sub(&dst->x, &a->x, &b->x, n*2);
+}
+
+LADEF void span2f_mul(V2f *dst, const V2f *a, const V2f *b, size_t n)
+{
+    la_span_mul(&dst->x, &a->x, &b->x, n*2);
+}
+
+LADEF void span2f_min(V2f *dst, const V2f *a, const V2f *b, size_t n)
+{
+    la_span_min(&dst->x, &a->x, &b->x, n*2);
+}
+
+LADEF void span2f_max(V2f *dst, const V2f *a, const V2f *b, size_t n)
+{
+    la_span_max(&dst->x, &a->x, &b->x, n*2);
+}
+
+LADEF void span2f_scale_add(V2f *dst, const V2f *a, const V2f *b, float s, size_t n)
+{
+    la_span_scale_add(&dst->x, &a->x, &b->x, s, n*2);
+}
+
+LADEF void span2f_lerp(V2f *dst, const V2f *a, const V2f *b, float t, size_t n)
+{
+    la_span_lerp(&dst->x, &a->x, &b->x, t, n*2);
+}
+
+LADEF void span2f_clamp(V2f *dst, const V2f *x, V2f a, V2f b, size_t n)
+{
+    const float a4[4] = {a.x, a.y, a.x, a.y};
+    const float b4[4] = {b.x, b.y, b.x, b.y};
+    la_span_clamp(&dst->x, &x->x, a4, b4, n*2);
+}
+
+LADEF void span4f_sum(V4f *dst, const V4f *a, const V4f *b, size_t n)
+{
+    la_span_sum(&dst->x, &a->x, &b->x, n*4);
+}
+
+LADEF void span4f_sub(V4f *dst, const V4f *a, const V4f *b, size_t n)
+{
+    la_span_sub(&dst->x, &a->x, &b->x, n*4);
+}
+
+LADEF void span4f_mul(V4f *dst, const V4f *a, const V4f *b, size_t n)
+{
+    la_span_mul(&dst->x, &a->x, &b->x, n*4);
+}
+
+LADEF void span4f_min(V4f *dst, const V4f *a, const V4f *b, size_t n)
+{
+    la_span_min(&dst->x, &a->x, &b->x, n*4);
+}
+
+LADEF void span4f_max(V4f *dst, const V4f *a, const V4f *b, size_t n)
+{
+    la_span_max(&dst->x, &a->x, &b->x, n*4);
+}
+
+LADEF void span4f_scale_add(V4f *dst, const V4f *a, const V4f *b, float s, size_t n)
+{
+    la_span_scale_add(&dst->x, &a->x, &b->x, s, n*4);
+}
+
+LADEF void span4f_lerp(V4f *dst, const V4f *a, const V4f *b, float t, size_t n)
+{
+    la_span_lerp(&dst->x, &a->x, &b->x, t, n*4);
+}
+
+LADEF void span4f_clamp(V4f *dst, const V4f *x, V4f a, V4f b, size_t n)
+{
+    const float a4[4] = {a.x, a.y, a.z, a.w};
+    const float b4[4] = {b.x, b.y, b.z, b.w};
+    la_span_clamp(&dst->x, &x->x, a4, b4, n*4);
+}
+
+// sin and cos reduce x by k*pi, k rounded to the nearest integer by adding and subtracting
+// 1.5*2^23, with pi split in two so that k*LA_FAST_PI_HI is exact. sin(r) on [-pi/2, pi/2]
+// is its Taylor polynomial up to r^11, the parity of k flips the sign. cos(x) = sin(x + pi/2)
+// uses k - 1/2 instead of k, adding pi/2 to x would lose the low bits of large x.
+#define LA_FAST_ROUND  12582912.0f
+#define LA_FAST_INV_PI 0.318309886183790672f
+#define LA_FAST_PI_HI  3.140625f
+#define LA_FAST_PI_LO  9.67653589793238462e-4f
+#define LA_FAST_SIN_3  -1.66666666666666667e-1f
+#define LA_FAST_SIN_5  8.33333333333333333e-3f
+#define LA_FAST_SIN_7  -1.98412698412698413e-4f
+#define LA_FAST_SIN_9  2.75573192239858907e-6f
+#define LA_FAST_SIN_11 -2.50521083854417188e-8f
+// 2^f = e^(f*ln2) on [-1/2, 1/2], Taylor up to f^6
+#define LA_FAST_EXP2_1 6.93147180559945309e-1f
+#define LA_FAST_EXP2_2 2.40226506959100712e-1f
+#define LA_FAST_EXP2_3 5.55041086648215800e-2f
+#define LA_FAST_EXP2_4 9.61812910762847716e-3f
+#define LA_FAST_EXP2_5 1.33335581464284434e-3f
+#define LA_FAST_EXP2_6 1.54035303933816099e-4f
+// log2(m) = 2/ln2*atanh(t) with t = (m - 1)/(m + 1), m in [sqrt(1/2), sqrt(2)], up to t^7
+#define LA_FAST_SQRT2  1.41421356237309505f
+#define LA_FAST_LOG2_1 2.88539008177792681f
+#define LA_FAST_LOG2_3 9.61796693925975604e-1f
+#define LA_FAST_LOG2_5 5.77078016355585363e-1f
+#define LA_FAST_LOG2_7 4.12198583111132402e-1f
+
+typedef union {
+    float f;
+    unsigned int u;
+} La_Bits;
+
+// r in [-pi/2, pi/2], k is an integer
+static inline float la_fast_sin_reduced(float r, float k)
+{
+    float r2 = r*r;
+    float p = ((((LA_FAST_SIN_11*r2 + LA_FAST_SIN_9)*r2 + LA_FAST_SIN_7)*r2 + LA_FAST_SIN_5)*r2 + LA_FAST_SIN_3)*r2;
+    La_Bits s = {r + r*p};
+    s.u ^= (unsigned int) (int) k << 31;
+    return s.f;
+}
+
+LADEF float sinf_fast(float x)
+{
+    float k = (x*LA_FAST_INV_PI + LA_FAST_ROUND) - LA_FAST_ROUND;
+    float r = (x - k*LA_FAST_PI_HI) - k*LA_FAST_PI_LO;
+    return la_fast_sin_reduced(r, k);
+}
+
+LADEF float cosf_fast(float x)
+{
+    float k = ((x*LA_FAST_INV_PI + 0.5f) + LA_FAST_ROUND) - LA_FAST_ROUND;
+    float h = k - 0.5f;
+    float r = (x - h*LA_FAST_PI_HI) - h*LA_FAST_PI_LO;
+    return la_fast_sin_reduced(r, k);
+}
+
+LADEF float exp2f_fast(float x)
+{
+    x = clampf(x, -126.0f, 127.0f);
+    float k = (x + LA_FAST_ROUND) - LA_FAST_ROUND;
+    float f = x - k;
+    float p = 1.0f + f*(LA_FAST_EXP2_1 + f*(LA_FAST_EXP2_2 + f*(LA_FAST_EXP2_3 + f*(LA_FAST_EXP2_4 + f*(LA_FAST_EXP2_5 + f*LA_FAST_EXP2_6)))));
+    La_Bits scale;
+    scale.u = (unsigned int) ((int) k + 127) << 23;
+    return p*scale.f;
+}
+
+LADEF float log2f_fast(float x)
+{
+    La_Bits m = {x};
+    int e = (int) (m.u >> 23) - 127;
+    m.u = (m.u & 0x007fffff) | 0x3f800000;
+    if (m.f > LA_FAST_SQRT2) {
+        m.u -= 0x00800000;
+        e += 1;
+    }
+    float t = (m.f - 1.0f)/(m.f + 1.0f);
+    float t2 = t*t;
+    return (float) e + t*(LA_FAST_LOG2_1 + t2*(LA_FAST_LOG2_3 + t2*(LA_FAST_LOG2_5 + t2*LA_FAST_LOG2_7)));
+}
+
+LADEF float powf_fast(float base, float exp)
+{
+    return exp2f_fast(exp*log2f_fast(base));
+}
+
+#ifdef LA_SIMD
+// The same operations as the scalar versions in the same order, so the bits match
+static inline La_F4 la_f4_sin_reduced(La_F4 r, La_F4 k)
+{
+    La_F4 r2 = la_f4_mul(r, r);
+    La_F4 p = la_f4_add(la_f4_mul(la_f4_set1(LA_FAST_SIN_11), r2), la_f4_set1(LA_FAST_SIN_9));
+    p = la_f4_add(la_f4_mul(p, r2), la_f4_set1(LA_FAST_SIN_7));
+    p = la_f4_add(la_f4_mul(p, r2), la_f4_set1(LA_FAST_SIN_5));
+    p = la_f4_add(la_f4_mul(p, r2), la_f4_set1(LA_FAST_SIN_3));
+    p = la_f4_mul(p, r2);
+    La_F4 s = la_f4_add(r, la_f4_mul(r, p));
+    return la_i4_as_f4(la_i4_xor(la_f4_as_i4(s), la_i4_shl(la_i4_from_f4(k), 31)));
+}
+
+static inline La_F4 la_f4_sin_fast(La_F4 x)
+{
+    const La_F4 round = la_f4_set1(LA_FAST_ROUND);
+    La_F4 k = la_f4_sub(la_f4_add(la_f4_mul(x, la_f4_set1(LA_FAST_INV_PI)), round), round);
+    La_F4 r = la_f4_sub(la_f4_sub(x, la_f4_mul(k, la_f4_set1(LA_FAST_PI_HI))), la_f4_mul(k, la_f4_set1(LA_FAST_PI_LO)));
+    return la_f4_sin_reduced(r, k);
+}
+
+static inline La_F4 la_f4_cos_fast(La_F4 x)
+{
+    const La_F4 round = la_f4_set1(LA_FAST_ROUND);
+    const La_F4 half = la_f4_set1(0.5f);
+    La_F4 k = la_f4_add(la_f4_mul(x, la_f4_set1(LA_FAST_INV_PI)), half);
+    k = la_f4_sub(la_f4_add(k, round), round);
+    La_F4 h = la_f4_sub(k, half);
+    La_F4 r = la_f4_sub(la_f4_sub(x, la_f4_mul(h, la_f4_set1(LA_FAST_PI_HI))), la_f4_mul(h, la_f4_set1(LA_FAST_PI_LO)));
+    return la_f4_sin_reduced(r, k);
+}
+
+static inline La_F4 la_f4_exp2_fast(La_F4 x)
+{
+    const La_F4 round = la_f4_set1(LA_FAST_ROUND);
+    x = la_f4_clamp(x, la_f4_set1(-126.0f), la_f4_set1(127.0f));
+    La_F4 k = la_f4_sub(la_f4_add(x, round), round);
+    La_F4 f = la_f4_sub(x, k);
+    La_F4 p = la_f4_add(la_f4_set1(LA_FAST_EXP2_5), la_f4_mul(f, la_f4_set1(LA_FAST_EXP2_6)));
+    p = la_f4_add(la_f4_set1(LA_FAST_EXP2_4), la_f4_mul(f, p));
+    p = la_f4_add(la_f4_set1(LA_FAST_EXP2_3), la_f4_mul(f, p));
+    p = la_f4_add(la_f4_set1(LA_FAST_EXP2_2), la_f4_mul(f, p));
+    p = la_f4_add(la_f4_set1(LA_FAST_EXP2_1), la_f4_mul(f, p));
+    p = la_f4_add(la_f4_set1(1.0f), la_f4_mul(f, p));
+    La_I4 scale = la_i4_shl(la_i4_add(la_i4_from_f4(k), la_i4_set1(127)), 23);
+    return la_f4_mul(p, la_i4_as_f4(scale));
+}
+
+static inline La_F4 la_f4_log2_fast(La_F4 x)
+{
+    La_I4 bits = la_f4_as_i4(x);
+    La_I4 e = la_i4_sub(la_i4_shr(bits, 23), la_i4_set1(127));
+    La_F4 m = la_i4_as_f4(la_i4_or(la_i4_and(bits, la_i4_set1(0x007fffff)), la_i4_set1(0x3f800000)));
+    // Lanes above sqrt(2) halve m and increment e, the mask is -1 there
+    La_I4 above = la_f4_gt(m, la_f4_set1(LA_FAST_SQRT2));
+    m = la_i4_as_f4(la_i4_sub(la_f4_as_i4(m), la_i4_and(above, la_i4_set1(0x00800000))));
+    e = la_i4_sub(e, above);
+    const La_F4 one = la_f4_set1(1.0f);
+    La_F4 t = la_f4_div(la_f4_sub(m, one), la_f4_add(m, one));
+    La_F4 t2 = la_f4_mul(t, t);
+    La_F4 p = la_f4_add(la_f4_set1(LA_FAST_LOG2_5), la_f4_mul(t2, la_f4_set1(LA_FAST_LOG2_7)));
+    p = la_f4_add(la_f4_set1(LA_FAST_LOG2_3), la_f4_mul(t2, p));
+    p = la_f4_add(la_f4_set1(LA_FAST_LOG2_1), la_f4_mul(t2, p));
+    return la_f4_add(la_f4_from_i4(e), la_f4_mul(t, p));
+}
+
+static inline La_F4 la_f4_pow_fast(La_F4 base, La_F4 exp)
+{
+    return la_f4_exp2_fast(la_f4_mul(exp, la_f4_log2_fast(base)));
+}
+#endif // LA_SIMD
+
+LADEF V2f v2f_sin_fast(V2f a)
+{
+#ifdef LA_SIMD
+    return la_f4_to_v2f(la_f4_sin_fast(la_f4_2f(a)));
+#else
+    return v2f(sinf_fast(a.x), sinf_fast(a.y));
+#endif // LA_SIMD
+}
+
+LADEF V2f v2f_cos_fast(V2f a)
+{
+#ifdef LA_SIMD
+    return la_f4_to_v2f(la_f4_cos_fast(la_f4_2f(a)));
+#else
+    return v2f(cosf_fast(a.x), cosf_fast(a.y));
+#endif // LA_SIMD
+}
+
+LADEF V2f v2f_pow_fast(V2f base, V2f exp)
+{
+#ifdef LA_SIMD
+    return la_f4_to_v2f(la_f4_pow_fast(la_f4_2f(base), la_f4_2f(exp)));
+#else
+    return v2f(powf_fast(base.x, exp.x), powf_fast(base.y, exp.y));
+#endif // LA_SIMD
+}
+
+LADEF V3f v3f_sin_fast(V3f a)
+{
+#ifdef LA_SIMD
+    return la_f4_to_v3f(la_f4_sin_fast(la_f4_3f(a)));
+#else
+    return v3f(sinf_fast(a.x), sinf_fast(a.y), sinf_fast(a.z));
+#endif // LA_SIMD
+}
+
+LADEF V3f v3f_cos_fast(V3f a)
+{
+#ifdef LA_SIMD
+    return la_f4_to_v3f(la_f4_cos_fast(la_f4_3f(a)));
+#else
+    return v3f(cosf_fast(a.x), cosf_fast(a.y), cosf_fast(a.z));
+#endif // LA_SIMD
+}
+
+LADEF V3f v3f_pow_fast(V3f base, V3f exp)
+{
+#ifdef LA_SIMD
+    return la_f4_to_v3f(la_f4_pow_fast(la_f4_3f(base), la_f4_3f(exp)));
+#else
+    return v3f(powf_fast(base.x, exp.x), powf_fast(base.y, exp.y), powf_fast(base.z, exp.z));
+#endif // LA_SIMD
+}
+
+LADEF V4f v4f_sin_fast(V4f a)
+{
+#ifdef LA_SIMD
+    return la_f4_to_v4f(la_f4_sin_fast(la_f4_4f(a)));
+#else
+    return v4f(sinf_fast(a.x), sinf_fast(a.y), sinf_fast(a.z), sinf_fast(a.w));
+#endif // LA_SIMD
+}
+
+LADEF V4f v4f_cos_fast(V4f a)
+{
+#ifdef LA_SIMD
+    return la_f4_to_v4f(la_f4_cos_fast(la_f4_4f(a)));
+#else
+    return v4f(cosf_fast(a.x), cosf_fast(a.y), cosf_fast(a.z), cosf_fast(a.w));
+#endif // LA_SIMD
+}
+
+LADEF V4f v4f_pow_fast(V4f base, V4f exp)
+{
+#ifdef LA_SIMD
+    return la_f4_to_v4f(la_f4_pow_fast(la_f4_4f(base), la_f4_4f(exp)));
+#else
+    return v4f(powf_fast(base.x, exp.x), powf_fast(base.y, exp.y), powf_fast(base.z, exp.z), powf_fast(base.w, exp.w));
+#endif // LA_SIMD
+}
+
+LADEF void spanf_sin_fast(float *dst, const float *a, size_t n)
+{
+    size_t i = 0;
+    LA_SPAN_SIMD(la_f4_sin_fast(la_f4_loadu(a + i)));
+    for (; i < n; ++i) dst[i] = sinf_fast(a[i]);
+}
+
+LADEF void spanf_cos_fast(float *dst, const float *a, size_t n)
+{
+    size_t i = 0;
+    LA_SPAN_SIMD(la_f4_cos_fast(la_f4_loadu(a + i)));
+    for (; i < n; ++i) dst[i] = cosf_fast(a[i]);
+}
+
+LADEF void spanf_exp2_fast(float *dst, const float *a, size_t n)
+{
+    size_t i = 0;
+    LA_SPAN_SIMD(la_f4_exp2_fast(la_f4_loadu(a + i)));
+    for (; i < n; ++i) dst[i] = exp2f_fast(a[i]);
+}
+
+LADEF void spanf_log2_fast(float *dst, const float *a, size_t n)
+{
+    size_t i = 0;
+    LA_SPAN_SIMD(la_f4_log2_fast(la_f4_loadu(a + i)));
+    for (; i < n; ++i) dst[i] = log2f_fast(a[i]);
+}
+
+LADEF void spanf_pow_fast(float *dst, const float *base, const float *exp, size_t n)
+{
+    size_t i = 0;
+    LA_SPAN_SIMD(la_f4_pow_fast(la_f4_loadu(base + i), la_f4_loadu(exp + i)));
+    for (; i < n; ++i) dst[i] = powf_fast(base[i], exp[i]);
+}
+
+// Half conversions after Fabian Giesen's float_to_half_fast3_rtne and half_to_float.
+// Floats from 65520 up round to infinity, below 2^-14 the half is subnormal: adding 0.5
+// lines the 10 mantissa bits up at the bottom of the float and rounds them to nearest even.
+#define LA_HALF_OVERFLOW     (143u << 23)
+#define LA_HALF_NORMAL_MIN   (113u << 23)
+#define LA_HALF_DENORM_MAGIC (126u << 23)
+#define LA_HALF_REBIAS       (112u << 23)
+#define LA_HALF_EXP          (0x7c00u << 13)
+
+LADEF unsigned short f2h(float x)
+{
+    La_Bits f = {x};
+    unsigned int sign = f.u & 0x80000000u;
+    f.u ^= sign;
+    unsigned int h;
+    if (f.u >= LA_HALF_OVERFLOW) {
+        h = f.u > 0x7f800000u ? 0x7e00 : 0x7c00;
+    } else if (f.u < LA_HALF_NORMAL_MIN) {
+        La_Bits magic;
+        magic.u = LA_HALF_DENORM_MAGIC;
+        f.f += magic.f;
+        h = f.u - magic.u;
+    } else {
+        unsigned int odd = (f.u >> 13) & 1;
+        h = (f.u - LA_HALF_REBIAS + 0xfff + odd) >> 13;
+    }
+    return (unsigned short) (h | sign >> 16);
+}
+
+LADEF float h2f(unsigned short h)
+{
+    La_Bits f;
+    f.u = (unsigned int) (h & 0x7fff) << 13;
+    unsigned int exp = f.u & LA_HALF_EXP;
+    f.u += LA_HALF_REBIAS;
+    if (exp == LA_HALF_EXP) {
+        f.u += LA_HALF_REBIAS;
+    } else if (exp == 0) {
+        La_Bits magic;
+        magic.u = LA_HALF_NORMAL_MIN;
+        f.u += 1u << 23;
+        f.f -= magic.f;
+    }
+    f.u |= (unsigned int) (h & 0x8000) << 16;
+    return f.f;
+}
+
+LADEF unsigned short f2unorm16(float x)
+{
+    // In float the product can round across the halfway point, in double it is exact
+    return (unsigned short) ((double) clampf(x, 0.0f, 1.0f)*65535.0 + 0.5);
+}
+
+LADEF float unorm162f(unsigned short u)
+{
+    return (float) u/65535.0f;
+}
+
+LADEF unsigned char f2unorm8(float x)
+{
+    return (unsigned char) (clampf(x, 0.0f, 1.0f)*255.0f + 0.5f);
+}
+
+LADEF float unorm82f(unsigned char u)
+{
+    return (float) u/255.0f;
+}
+
+#define LA_SRGB_LINEAR_MAX 0.0031308f
+#define LA_SRGB_ENCODED_MAX 0.04045f
+
+LADEF float linear2srgb(float x)
+{
+    x = clampf(x, 0.0f, 1.0f);
+    if (x > LA_SRGB_LINEAR_MAX) return 1.055f*powf_fast(x, 1.0f/2.4f) - 0.055f;
+    return x*12.92f;
+}
+
+LADEF float srgb2linear(float x)
+{
+    if (x > LA_SRGB_ENCODED_MAX) return powf_fast((x + 0.055f)/1.055f, 2.4f);
+    return x/12.92f;
+}
+
+LADEF V2h v2h2f(V2f a)
+{
+    V2h r = {f2h(a.x), f2h(a.y)};
+    return r;
+}
+
+LADEF V2f v2f2h(V2h a)
+{
+    return v2f(h2f(a.x), h2f(a.y));
+}
+
+LADEF V4h v4h4f(V4f a)
+{
+    V4h r = {f2h(a.x), f2h(a.y), f2h(a.z), f2h(a.w)};
+    return r;
+}
+
+LADEF V4f v4f4h(V4h a)
+{
+    return v4f(h2f(a.x), h2f(a.y), h2f(a.z), h2f(a.w));
+}
+
+LADEF V2n v2n2f(V2f a)
+{
+    V2n r = {f2unorm16(a.x), f2unorm16(a.y)};
+    return r;
+}
+
+LADEF V2f v2f2n(V2n a)
+{
+    return v2f(unorm162f(a.x), unorm162f(a.y));
+}
+
+LADEF Rgba8 rgba8_from_v4f(V4f a)
+{
+    Rgba8 r = {f2unorm8(a.x), f2unorm8(a.y), f2unorm8(a.z), f2unorm8(a.w)};
+    return r;
+}
+
+LADEF Rgba8 rgba8_from_v4f_srgb(V4f a)
+{
+    Rgba8 r = {f2unorm8(linear2srgb(a.x)), f2unorm8(linear2srgb(a.y)), f2unorm8(linear2srgb(a.z)), f2unorm8(a.w)};
+    return r;
+}
+
+LADEF V4f v4f_from_rgba8(Rgba8 a)
+{
+    return v4f(unorm82f(a.r), unorm82f(a.g), unorm82f(a.b), unorm82f(a.a));
+}
+
+LADEF V4f v4f_from_rgba8_srgb(Rgba8 a)
+{
+    return v4f(srgb2linear(unorm82f(a.r)), srgb2linear(unorm82f(a.g)), srgb2linear(unorm82f(a.b)), unorm82f(a.a));
+}
+
+#ifdef LA_SIMD
+// The lanes hold the half bits, or the floats are built from them
+static inline La_I4 la_f4_to_half(La_F4 x)
+{
+    La_I4 f = la_f4_as_i4(x);
+    La_I4 sign = la_i4_and(f, la_i4_set1(INT_MIN));
+    f = la_i4_xor(f, sign);
+    La_I4 inf_nan = la_i4_select(la_i4_gt(f, la_i4_set1(0x7f800000)), la_i4_set1(0x7e00), la_i4_set1(0x7c00));
+    La_F4 magic = la_i4_as_f4(la_i4_set1(LA_HALF_DENORM_MAGIC));
+    La_I4 denorm = la_i4_sub(la_f4_as_i4(la_f4_add(la_i4_as_f4(f), magic)), la_f4_as_i4(magic));
+    La_I4 odd = la_i4_and(la_i4_shr(f, 13), la_i4_set1(1));
+    La_I4 normal = la_i4_shr(la_i4_add(la_i4_add(la_i4_sub(f, la_i4_set1(LA_HALF_REBIAS)), la_i4_set1(0xfff)), odd), 13);
+    La_I4 h = la_i4_select(la_i4_gt(la_i4_set1(LA_HALF_NORMAL_MIN), f), denorm, normal);
+    h = la_i4_select(la_i4_gt(f, la_i4_set1(LA_HALF_OVERFLOW - 1)), inf_nan, h);
+    return la_i4_or(h, la_i4_shr(sign, 16));
+}
+
+static inline La_F4 la_f4_from_half(La_I4 h)
+{
+    La_I4 f = la_i4_shl(la_i4_and(h, la_i4_set1(0x7fff)), 13);
+    La_I4 exp = la_i4_and(f, la_i4_set1(LA_HALF_EXP));
+    f = la_i4_add(f, la_i4_set1(LA_HALF_REBIAS));
+    La_I4 inf_nan = la_i4_add(f, la_i4_set1(LA_HALF_REBIAS));
+    La_F4 magic = la_i4_as_f4(la_i4_set1(LA_HALF_NORMAL_MIN));
+    La_I4 denorm = la_f4_as_i4(la_f4_sub(la_i4_as_f4(la_i4_add(f, la_i4_set1(1 << 23))), magic));
+    f = la_i4_select(la_i4_eq(exp, la_i4_set1(LA_HALF_EXP)), inf_nan, f);
+    f = la_i4_select(la_i4_eq(exp, la_i4_set1(0)), denorm, f);
+    return la_i4_as_f4(la_i4_or(f, la_i4_shl(la_i4_and(h, la_i4_set1(0x8000)), 16)));
+}
+
+static inline La_I4 la_f4_to_unorm(La_F4 x, float max)
+{
+    La_F4 c = la_f4_clamp(x, la_f4_set1(0.0f), la_f4_set1(1.0f));
+    return la_i4_from_f4(la_f4_add(la_f4_mul(c, la_f4_set1(max)), la_f4_set1(0.5f)));
+}
+
+static inline La_I4 la_f4_to_unorm16(La_F4 x)
+{
+    return la_i4_round_f4_wide(la_f4_clamp(x, la_f4_set1(0.0f), la_f4_set1(1.0f)), 65535.0);
+}
+
+static inline La_F4 la_f4_from_unorm(La_I4 u, float max)
+{
+    return la_f4_div(la_f4_from_i4(u), la_f4_set1(max));
+}
+
+// Only the lanes set in mask are converted, the rest passes through
+static inline La_F4 la_f4_linear2srgb(La_F4 x, La_I4 mask)
+{
+    La_F4 c = la_f4_clamp(x, la_f4_set1(0.0f), la_f4_set1(1.0f));
+    La_F4 curve = la_f4_pow_fast(c, la_f4_set1(1.0f/2.4f));
+    curve = la_f4_sub(la_f4_mul(la_f4_set1(1.055f), curve), la_f4_set1(0.055f));
+    La_F4 srgb = la_f4_select(la_f4_gt(c, la_f4_set1(LA_SRGB_LINEAR_MAX)), curve, la_f4_mul(c, la_f4_set1(12.92f)));
+    return la_f4_select(mask, srgb, x);
+}
+
+static inline La_F4 la_f4_srgb2linear(La_F4 x, La_I4 mask)
+{
+    La_F4 curve = la_f4_pow_fast(la_f4_div(la_f4_add(x, la_f4_set1(0.055f)), la_f4_set1(1.055f)), la_f4_set1(2.4f));
+    La_F4 linear = la_f4_select(la_f4_gt(x, la_f4_set1(LA_SRGB_ENCODED_MAX)), curve, la_f4_div(x, la_f4_set1(12.92f)));
+    return la_f4_select(mask, linear, x);
+}
+
+// Lanes x, y and z of a color
+static inline La_I4 la_i4_rgb_mask(void)
+{
+    return la_f4_gt(la_f4_load(1.0f, 1.0f, 1.0f, 0.0f), la_f4_set1(0.0f));
+}
+#endif // LA_SIMD
+
+LADEF void spanf_to_half(unsigned short *dst, const float *src, size_t n)
+{
+    size_t i = 0;
+#ifdef LA_SIMD
+    for (; i + 4 <= n; i += 4) la_i4_store_u16(dst + i, la_f4_to_half(la_f4_loadu(src + i)));
+#endif // LA_SIMD
+    for (; i < n; ++i) dst[i] = f2h(src[i]);
+}
+
+LADEF void spanf_from_half(float *dst, const unsigned short *src, size_t n)
+{
+    size_t i = 0;
+    LA_SPAN_SIMD(la_f4_from_half(la_i4_load_u16(src + i)));
+    for (; i < n; ++i) dst[i] = h2f(src[i]);
+}
+
+LADEF void spanf_to_unorm16(unsigned short *dst, const float *src, size_t n)
+{
+    size_t i = 0;
+#ifdef LA_SIMD
+    for (; i + 4 <= n; i += 4) la_i4_store_u16(dst + i, la_f4_to_unorm16(la_f4_loadu(src + i)));
+#endif // LA_SIMD
+    for (; i < n; ++i) dst[i] = f2unorm16(src[i]);
+}
+
+LADEF void spanf_from_unorm16(float *dst, const unsigned short *src, size_t n)
+{
+    size_t i = 0;
+    LA_SPAN_SIMD(la_f4_from_unorm(la_i4_load_u16(src + i), 65535.0f));
+    for (; i < n; ++i) dst[i] = unorm162f(src[i]);
+}
+
+LADEF void span4f_to_rgba8(Rgba8 *dst, const V4f *src, size_t n)
+{
+#ifdef LA_SIMD
+    for (size_t i = 0; i < n; ++i) la_i4_store_u8(&dst[i].r, la_f4_to_unorm(la_f4_loadu(&src[i].x), 255.0f));
+#else
+    for (size_t i = 0; i < n; ++i) dst[i] = rgba8_from_v4f(src[i]);
+#endif // LA_SIMD
+}
+
+LADEF void span4f_to_rgba8_srgb(Rgba8 *dst, const V4f *src, size_t n)
+{
+#ifdef LA_SIMD
+    La_I4 rgb = la_i4_rgb_mask();
+    for (size_t i = 0; i < n; ++i) {
+        La_F4 c = la_f4_linear2srgb(la_f4_loadu(&src[i].x), rgb);
+        la_i4_store_u8(&dst[i].r, la_f4_to_unorm(c, 255.0f));
+    }
+#else
+    for (size_t i = 0; i < n; ++i) dst[i] = rgba8_from_v4f_srgb(src[i]);
+#endif // LA_SIMD
+}
+
+LADEF void span4f_from_rgba8(V4f *dst, const Rgba8 *src, size_t n)
+{
+#ifdef LA_SIMD
+    for (size_t i = 0; i < n; ++i) la_f4_store(&dst[i].x, la_f4_from_unorm(la_i4_load_u8(&src[i].r), 255.0f));
+#else
+    for (size_t i = 0; i < n; ++i) dst[i] = v4f_from_rgba8(src[i]);
+#endif // LA_SIMD
+}
+
+LADEF void span4f_from_rgba8_srgb(V4f *dst, const Rgba8 *src, size_t n)
+{
+#ifdef LA_SIMD
+    La_I4 rgb = la_i4_rgb_mask();
+    for (size_t i = 0; i < n; ++i) {
+        La_F4 c = la_f4_from_unorm(la_i4_load_u8(&src[i].r), 255.0f);
+        la_f4_store(&dst[i].x, la_f4_srgb2linear(c, rgb));
+    }
+#else
+    for (size_t i = 0; i < n; ++i) dst[i] = v4f_from_rgba8_srgb(src[i]);
+#endif // LA_SIMD
+}
+
+LADEF M3f m3f_identity(void)
+{
+    M3f m = {{
+        {1.0f, 0.0f, 0.0f, 0.0f},
+        {0.0f, 1.0f, 0.0f, 0.0f},
+        {0.0f, 0.0f, 1.0f, 0.0f},
+    }};
+    return m;
+}
+
+LADEF M3f m3f_translate(V2f t)
+{
+    M3f m = m3f_identity();
+    m.c[2].x = t.x;
+    m.c[2].y = t.y;
+    return m;
+}
+
+LADEF M3f m3f_scale(V2f s)
+{
+    M3f m = m3f_identity();
+    m.c[0].x = s.x;
+    m.c[1].y = s.y;
+    return m;
+}
+
+LADEF M3f m3f_rotate(float angle)
+{
+    float c = cosf(angle);
+    float s = sinf(angle);
+    M3f m = m3f_identity();
+    m.c[0].x = c;
+    m.c[0].y = s;
+    m.c[1].x = -s;
+    m.c[1].y = c;
+    return m;
+}
+
+LADEF M3f m3f_mul(M3f a, M3f b)
+{
+    M3f r;
+    for (int j = 0; j < 3; ++j) {
+#ifdef LA_SIMD
+        La_F4 v = la_f4_4f(b.c[j]);
+        La_F4 sum = la_f4_add(la_f4_mul(la_f4_4f(a.c[0]), la_f4_splat(v, 0)),
+                              la_f4_mul(la_f4_4f(a.c[1]), la_f4_splat(v, 1)));
+        r.c[j] = la_f4_to_v4f(la_f4_add(sum, la_f4_mul(la_f4_4f(a.c[2]), la_f4_splat(v, 2))));
+#else
+        V4f v = b.c[j];
+        r.c[j] = v4f_sum(v4f_sum(v4f_mul(a.c[0], v4ff(v.x)), v4f_mul(a.c[1], v4ff(v.y))), v4f_mul(a.c[2], v4ff(v.z)));
+#endif // LA_SIMD
+    }
+    return r;
+}
+
+LADEF M3f m3f_inverse(M3f m)
+{
+    // Transposed cofactors divided by the determinant
+    float a = m.c[0].x, b = m.c[1].x, c = m.c[2].x;
+    float d = m.c[0].y, e = m.c[1].y, f = m.c[2].y;
+    float g = m.c[0].z, h = m.c[1].z, i = m.c[2].z;
+    float A = e*i - f*h, B = f*g - d*i, C = d*h - e*g;
+    float inv_det = 1.0f/(a*A + b*B + c*C);
+    M3f r = {{
+        {A*inv_det, B*inv_det, C*inv_det, 0.0f},
+        {(c*h - b*i)*inv_det, (a*i - c*g)*inv_det, (b*g - a*h)*inv_det, 0.0f},
+        {(b*f - c*e)*inv_det, (c*d - a*f)*inv_det, (a*e - b*d)*inv_det, 0.0f},
+    }};
+    return r;
+}
+
+LADEF V2f m3f_transform_point(M3f m, V2f p)
+{
+    return v2f(m.c[0].x*p.x + m.c[1].x*p.y + m.c[2].x,
+               m.c[0].y*p.x + m.c[1].y*p.y + m.c[2].y);
+}
+
+// Two points per register: (x0, x0, x1, x1)*(c0.x, c0.y, c0.x, c0.y) + (y0, y0, y1, y1)*c1...
+LADEF void m3f_transform_points(M3f m, V2f *dst, const V2f *src, size_t n)
+{
+    size_t i = 0;
+#ifdef LA_SIMD
+    La_F4 c0 = la_f4_load(m.c[0].x, m.c[0].y, m.c[0].x, m.c[0].y);
+    La_F4 c1 = la_f4_load(m.c[1].x, m.c[1].y, m.c[1].x, m.c[1].y);
+    La_F4 c2 = la_f4_load(m.c[2].x, m.c[2].y, m.c[2].x, m.c[2].y);
+    for (; i + 2 <= n; i += 2) {
+        La_F4 p = la_f4_loadu(&src[i].x);
+        La_F4 r = la_f4_add(la_f4_add(la_f4_mul(c0, la_f4_dup_even(p)), la_f4_mul(c1, la_f4_dup_odd(p))), c2);
+        la_f4_store(&dst[i].x, r);
+    }
+#endif // LA_SIMD
+    for (; i < n; ++i) dst[i] = m3f_transform_point(m, src[i]);
+}
+
+LADEF M4f m4f_identity(void)
+{
+    M4f m = {{
+        {1.0f, 0.0f, 0.0f, 0.0f},
+        {0.0f, 1.0f, 0.0f, 0.0f},
+        {0.0f, 0.0f, 1.0f, 0.0f},
+        {0.0f, 0.0f, 0.0f, 1.0f},
+    }};
+    return m;
+}
+
+LADEF M4f m4f_translate(V3f t)
+{
+    M4f m = m4f_identity();
+    m.c[3].x = t.x;
+    m.c[3].y = t.y;
+    m.c[3].z = t.z;
+    return m;
+}
+
+LADEF M4f m4f_scale(V3f s)
+{
+    M4f m = m4f_identity();
+    m.c[0].x = s.x;
+    m.c[1].y = s.y;
+    m.c[2].z = s.z;
+    return m;
+}
+
+LADEF M4f m4f_rotate_z(float angle)
+{
+    float c = cosf(angle);
+    float s = sinf(angle);
+    M4f m = m4f_identity();
+    m.c[0].x = c;
+    m.c[0].y = s;
+    m.c[1].x = -s;
+    m.c[1].y = c;
+    return m;
+}
+
+LADEF M4f m4f_ortho(float left, float right, float bottom, float top, float z_near, float z_far)
+{
+    M4f m = m4f_identity();
+    m.c[0].x = 2.0f/(right - left);
+    m.c[1].y = 2.0f/(top - bottom);
+    m.c[2].z = -2.0f/(z_far - z_near);
+    m.c[3].x = -(right + left)/(right - left);
+    m.c[3].y = -(top + bottom)/(top - bottom);
+    m.c[3].z = -(z_far + z_near)/(z_far - z_near);
+    return m;
+}
+
+LADEF V4f m4f_transform(M4f m, V4f v)
+{
+#ifdef LA_SIMD
+    La_F4 p = la_f4_4f(v);
+    La_F4 r = la_f4_add(la_f4_mul(la_f4_4f(m.c[0]), la_f4_splat(p, 0)), la_f4_mul(la_f4_4f(m.c[1]), la_f4_splat(p, 1)));
+    r = la_f4_add(r, la_f4_mul(la_f4_4f(m.c[2]), la_f4_splat(p, 2)));
+    r = la_f4_add(r, la_f4_mul(la_f4_4f(m.c[3]), la_f4_splat(p, 3)));
+    return la_f4_to_v4f(r);
+#else
+    V4f r = v4f_sum(v4f_mul(m.c[0], v4ff(v.x)), v4f_mul(m.c[1], v4ff(v.y)));
+    r = v4f_sum(r, v4f_mul(m.c[2], v4ff(v.z)));
+    return v4f_sum(r, v4f_mul(m.c[3], v4ff(v.w)));
+#endif // LA_SIMD
+}
+
+LADEF M4f m4f_mul(M4f a, M4f b)
+{
+    M4f r;
+    for (int j = 0; j < 4; ++j) r.c[j] = m4f_transform(a, b.c[j]);
+    return r;
+}
+
+LADEF M4f m4f_inverse(M4f m)
+{
+    // Cofactor expansion through the 2x2 minors of the upper and lower two rows
+    float a[16];
+    for (int j = 0; j < 4; ++j) {
+        a[j*4 + 0] = m.c[j].x;
+        a[j*4 + 1] = m.c[j].y;
+        a[j*4 + 2] = m.c[j].z;
+        a[j*4 + 3] = m.c[j].w;
+    }
+    // a[col*4 + row]
+#define LA_M(row, col) a[(col)*4 + (row)]
+    float s0 = LA_M(0, 0)*LA_M(1, 1) - LA_M(1, 0)*LA_M(0, 1);
+    float s1 = LA_M(0, 0)*LA_M(1, 2) - LA_M(1, 0)*LA_M(0, 2);
+    float s2 = LA_M(0, 0)*LA_M(1, 3) - LA_M(1, 0)*LA_M(0, 3);
+    float s3 = LA_M(0, 1)*LA_M(1, 2) - LA_M(1, 1)*LA_M(0, 2);
+    float s4 = LA_M(0, 1)*LA_M(1, 3) - LA_M(1, 1)*LA_M(0, 3);
+    float s5 = LA_M(0, 2)*LA_M(1, 3) - LA_M(1, 2)*LA_M(0, 3);
+    float c5 = LA_M(2, 2)*LA_M(3, 3) - LA_M(3, 2)*LA_M(2, 3);
+    float c4 = LA_M(2, 1)*LA_M(3, 3) - LA_M(3, 1)*LA_M(2, 3);
+    float c3 = LA_M(2, 1)*LA_M(3, 2) - LA_M(3, 1)*LA_M(2, 2);
+    float c2 = LA_M(2, 0)*LA_M(3, 3) - LA_M(3, 0)*LA_M(2, 3);
+    float c1 = LA_M(2, 0)*LA_M(3, 2) - LA_M(3, 0)*LA_M(2, 2);
+    float c0 = LA_M(2, 0)*LA_M(3, 1) - LA_M(3, 0)*LA_M(2, 1);
+    float inv_det = 1.0f/(s0*c5 - s1*c4 + s2*c3 + s3*c2 - s4*c1 + s5*c0);
+
+    M4f r;
+    r.c[0].x = ( LA_M(1, 1)*c5 - LA_M(1, 2)*c4 + LA_M(1, 3)*c3)*inv_det;
+    r.c[1].x = (-LA_M(0, 1)*c5 + LA_M(0, 2)*c4 - LA_M(0, 3)*c3)*inv_det;
+    r.c[2].x = ( LA_M(3, 1)*s5 - LA_M(3, 2)*s4 + LA_M(3, 3)*s3)*inv_det;
+    r.c[3].x = (-LA_M(2, 1)*s5 + LA_M(2, 2)*s4 - LA_M(2, 3)*s3)*inv_det;
+    r.c[0].y = (-LA_M(1, 0)*c5 + LA_M(1, 2)*c2 - LA_M(1, 3)*c1)*inv_det;
+    r.c[1].y = ( LA_M(0, 0)*c5 - LA_M(0, 2)*c2 + LA_M(0, 3)*c1)*inv_det;
+    r.c[2].y = (-LA_M(3, 0)*s5 + LA_M(3, 2)*s2 - LA_M(3, 3)*s1)*inv_det;
+    r.c[3].y = ( LA_M(2, 0)*s5 - LA_M(2, 2)*s2 + LA_M(2, 3)*s1)*inv_det;
+    r.c[0].z = ( LA_M(1, 0)*c4 - LA_M(1, 1)*c2 + LA_M(1, 3)*c0)*inv_det;
+    r.c[1].z = (-LA_M(0, 0)*c4 + LA_M(0, 1)*c2 - LA_M(0, 3)*c0)*inv_det;
+    r.c[2].z = ( LA_M(3, 0)*s4 - LA_M(3, 1)*s2 + LA_M(3, 3)*s0)*inv_det;
+    r.c[3].z = (-LA_M(2, 0)*s4 + LA_M(2, 1)*s2 - LA_M(2, 3)*s0)*inv_det;
+    r.c[0].w = (-LA_M(1, 0)*c3 + LA_M(1, 1)*c1 - LA_M(1, 2)*c0)*inv_det;
+    r.c[1].w = ( LA_M(0, 0)*c3 - LA_M(0, 1)*c1 + LA_M(0, 2)*c0)*inv_det;
+    r.c[2].w = (-LA_M(3, 0)*s3 + LA_M(3, 1)*s1 - LA_M(3, 2)*s0)*inv_det;
+    r.c[3].w = ( LA_M(2, 0)*s3 - LA_M(2, 1)*s1 + LA_M(2, 2)*s0)*inv_det;
+#undef LA_M
+    return r;
+}
+
+LADEF void m4f_transform_points(M4f m, V4f *dst, const V4f *src, size_t n)
+{
+#ifdef LA_SIMD
+    La_F4 c0 = la_f4_4f(m.c[0]);
+    La_F4 c1 = la_f4_4f(m.c[1]);
+    La_F4 c2 = la_f4_4f(m.c[2]);
+    La_F4 c3 = la_f4_4f(m.c[3]);
+    for (size_t i = 0; i < n; ++i) {
+        La_F4 p = la_f4_loadu(&src[i].x);
+        La_F4 r = la_f4_add(la_f4_mul(c0, la_f4_splat(p, 0)), la_f4_mul(c1, la_f4_splat(p, 1)));
+        r = la_f4_add(r, la_f4_mul(c2, la_f4_splat(p, 2)));
+        r = la_f4_add(r, la_f4_mul(c3, la_f4_splat(p, 3)));
+        la_f4_store(&dst[i].x, r);
+    }
+#else
+    for (size_t i = 0; i < n; ++i) dst[i] = m4f_transform(m, src[i]);
+#endif // LA_SIMD
+}
+
 #endif // LA_IMPLEMENTATION
@@ -0,0 +1,246 @@
+#include <assert.h>
+
+// Compiled a second time by la_bench_scalar.c with LA_NO_SIMD and the _scalar suffix
+#ifndef LA_BENCH_NAME
+#define LA_BENCH_NAME(name) name
+#endif
+#define LA_IMPLEMENTATION
+#include "la_bench.h"
+
+#ifndef LA_NO_SIMD
+static_assert(COUNT_LA_OPS == 11, "Update the names of the la operations accordingly");
+static const char *la_op_names[COUNT_LA_OPS] = {
+    [LA_OP_SUM]   = "sum",
+    [LA_OP_SUB]   = "sub",
+    [LA_OP_MUL]   = "mul",
+    [LA_OP_DIV]   = "div",
+    [LA_OP_SQRT]  = "sqrt",
+    [LA_OP_MIN]   = "min",
+    [LA_OP_MAX]   = "max",
+    [LA_OP_LERP]  = "lerp",
+    [LA_OP_FLOOR] = "floor",
+    [LA_OP_CEIL]  = "ceil",
+    [LA_OP_CLAMP] = "clamp",
+};
+
+const char *la_op_name(La_Op op)
+{
+    assert(op < COUNT_LA_OPS);
+    return la_op_names[op];
+}
+
+static_assert(COUNT_LA_FASTS == 5, "Update the names of the fast functions accordingly");
+static const char *la_fast_names[COUNT_LA_FASTS] = {
+    [LA_FAST_SIN]  = "sin",
+    [LA_FAST_COS]  = "cos",
+    [LA_FAST_EXP2] = "exp2",
+    [LA_FAST_LOG2] = "log2",
+    [LA_FAST_POW]  = "pow",
+};
+
+const char *la_fast_name(La_Fast f)
+{
+    assert(f < COUNT_LA_FASTS);
+    return la_fast_names[f];
+}
+
+static_assert(COUNT_LA_PACKS == 4, "Update the names of the packed types accordingly");
+static const char *la_pack_names[COUNT_LA_PACKS] = {
+    [LA_PACK_HALF]       = "half",
+    [LA_PACK_UNORM16]    = "unorm16",
+    [LA_PACK_RGBA8]      = "rgba8",
+    [LA_PACK_RGBA8_SRGB] = "rgba8_srgb",
+};
+
+const char *la_pack_name(La_Pack p)
+{
+    assert(p < COUNT_LA_PACKS);
+    return la_pack_names[p];
+}
+#endif // LA_NO_SIMD
+
+// The switch stays outside of the loops, so every loop inlines a single operation
+#define LA_BENCH_OPS(t)                                                                             \
+    switch (op) {                                                                                   \
+    case LA_OP_SUM:   for (size_t i = 0; i < n; ++i) out[i] = t##_sum(a[i], b[i]);           break; \
+    case LA_OP_SUB:   for (size_t i = 0; i < n; ++i) out[i] = t##_sub(a[i], b[i]);           break; \
+    case LA_OP_MUL:   for (size_t i = 0; i < n; ++i) out[i] = t##_mul(a[i], b[i]);           break; \
+    case LA_OP_DIV:   for (size_t i = 0; i < n; ++i) out[i] = t##_div(a[i], b[i]);           break; \
+    case LA_OP_SQRT:  for (size_t i = 0; i < n; ++i) out[i] = t##_sqrt(a[i]);                break; \
+    case LA_OP_MIN:   for (size_t i = 0; i < n; ++i) out[i] = t##_min(a[i], b[i]);           break; \
+    case LA_OP_MAX:   for (size_t i = 0; i < n; ++i) out[i] = t##_max(a[i], b[i]);           break; \
+    case LA_OP_LERP:  for (size_t i = 0; i < n; ++i) out[i] = t##_lerp(a[i], b[i], c[i]);    break; \
+    case LA_OP_FLOOR: for (size_t i = 0; i < n; ++i) out[i] = t##_floor(a[i]);               break; \
+    case LA_OP_CEIL:  for (size_t i = 0; i < n; ++i) out[i] = t##_ceil(a[i]);                break; \
+    case LA_OP_CLAMP: for (size_t i = 0; i < n; ++i) out[i] = t##_clamp(a[i], b[i], c[i]);   break; \
+    default: assert(0 && "unreachable");                                                            \
+    }
+
+void LA_BENCH_NAME(la_bench_v2f)(La_Op op, const V2f *a, const V2f *b, const V2f *c, V2f *out, size_t n)
+{
+    LA_BENCH_OPS(v2f)
+}
+
+void LA_BENCH_NAME(la_bench_v3f)(La_Op op, const V3f *a, const V3f *b, const V3f *c, V3f *out, size_t n)
+{
+    LA_BENCH_OPS(v3f)
+}
+
+void LA_BENCH_NAME(la_bench_v4f)(La_Op op, const V4f *a, const V4f *b, const V4f *c, V4f *out, size_t n)
+{
+    LA_BENCH_OPS(v4f)
+}
+
+void LA_BENCH_NAME(la_bench_fast)(La_Fast f, bool libm, const float *a, const float *b, float *out, size_t n)
+{
+    if (libm) {
+        switch (f) {
+        case LA_FAST_SIN:  for (size_t i = 0; i < n; ++i) out[i] = sinf(a[i]);       break;
+        case LA_FAST_COS:  for (size_t i = 0; i < n; ++i) out[i] = cosf(a[i]);       break;
+        case LA_FAST_EXP2: for (size_t i = 0; i < n; ++i) out[i] = exp2f(a[i]);      break;
+        case LA_FAST_LOG2: for (size_t i = 0; i < n; ++i) out[i] = log2f(a[i]);      break;
+        case LA_FAST_POW:  for (size_t i = 0; i < n; ++i) out[i] = powf(a[i], b[i]); break;
+        default: assert(0 && "unreachable");
+        }
+        return;
+    }
+    switch (f) {
+    case LA_FAST_SIN:  spanf_sin_fast(out, a, n);     break;
+    case LA_FAST_COS:  spanf_cos_fast(out, a, n);     break;
+    case LA_FAST_EXP2: spanf_exp2_fast(out, a, n);    break;
+    case LA_FAST_LOG2: spanf_log2_fast(out, a, n);    break;
+    case LA_FAST_POW:  spanf_pow_fast(out, a, b, n);  break;
+    default: assert(0 && "unreachable");
+    }
+}
+
+void LA_BENCH_NAME(la_bench_pack)(La_Pack p, bool unpack, float *floats, void *packed, size_t n)
+{
+    V4f *colors = (V4f *) floats;
+    switch (p) {
+    case LA_PACK_HALF:
+        if (unpack) spanf_from_half(floats, packed, n);
+        else spanf_to_half(packed, floats, n);
+        break;
+    case LA_PACK_UNORM16:
+        if (unpack) spanf_from_unorm16(floats, packed, n);
+        else spanf_to_unorm16(packed, floats, n);
+        break;
+    case LA_PACK_RGBA8:
+        if (unpack) span4f_from_rgba8(colors, packed, n/4);
+        else span4f_to_rgba8(packed, colors, n/4);
+        break;
+    case LA_PACK_RGBA8_SRGB:
+        if (unpack) span4f_from_rgba8_srgb(colors, packed, n/4);
+        else span4f_to_rgba8_srgb(packed, colors, n/4);
+        break;
+    default: assert(0 && "unreachable");
+    }
+}
+
+#ifndef LA_NO_SIMD
+#define LA_BENCH_T 0.25f
+
+static bool la_bench_spanf(La_Op op, bool per_element, const float *a, const float *b, float *out, size_t n)
+{
+    if (per_element) {
+        switch (op) {
+        case LA_OP_SUM:   for (size_t i = 0; i < n; ++i) out[i] = a[i] + b[i];             break;
+        case LA_OP_SUB:   for (size_t i = 0; i < n; ++i) out[i] = a[i] - b[i];             break;
+        case LA_OP_MUL:   for (size_t i = 0; i < n; ++i) out[i] = a[i] * b[i];             break;
+        case LA_OP_MIN:   for (size_t i = 0; i < n; ++i) out[i] = fminf(a[i], b[i]);       break;
+        case LA_OP_MAX:   for (size_t i = 0; i < n; ++i) out[i] = fmaxf(a[i], b[i]);       break;
+        case LA_OP_LERP:  for (size_t i = 0; i < n; ++i) out[i] = lerpf(a[i], b[i], LA_BENCH_T); break;
+        case LA_OP_CLAMP: for (size_t i = 0; i < n; ++i) out[i] = clampf(a[i], -10.0f, 10.0f); break;
+        default: return false;
+        }
+        return true;
+    }
+    switch (op) {
+    case LA_OP_SUM:   spanf_sum(out, a, b, n);               break;
+    case LA_OP_SUB:   spanf_sub(out, a, b, n);               break;
+    case LA_OP_MUL:   spanf_mul(out, a, b, n);               break;
+    case LA_OP_MIN:   spanf_min(out, a, b, n);               break;
+    case LA_OP_MAX:   spanf_max(out, a, b, n);               break;
+    case LA_OP_LERP:  spanf_lerp(out, a, b, LA_BENCH_T, n);  break;
+    case LA_OP_CLAMP: spanf_clamp(out, a, -10.0f, 10.0f, n); break;
+    default: return false;
+    }
+    return true;
+}
+
+// The span and the per element versions of op for V2f and V4f, t is the prefix of the single
+// value functions and span the one of the kernels
+#define LA_BENCH_SPAN(t, span, lo, hi)                                                                           \
+    if (per_element) {                                                                                           \
+        switch (op) {                                                                                            \
+        case LA_OP_SUM:   for (size_t i = 0; i < n; ++i) out[i] = t##_sum(a[i], b[i]);                    break; \
+        case LA_OP_SUB:   for (size_t i = 0; i < n; ++i) out[i] = t##_sub(a[i], b[i]);                    break; \
+        case LA_OP_MUL:   for (size_t i = 0; i < n; ++i) out[i] = t##_mul(a[i], b[i]);                    break; \
+        case LA_OP_MIN:   for (size_t i = 0; i < n; ++i) out[i] = t##_min(a[i], b[i]);                    break; \
+        case LA_OP_MAX:   for (size_t i = 0; i < n; ++i) out[i] = t##_max(a[i], b[i]);                    break; \
+        case LA_OP_LERP:  for (size_t i = 0; i < n; ++i) out[i] = t##_lerp(a[i], b[i], t##f(LA_BENCH_T)); break; \
+        case LA_OP_CLAMP: for (size_t i = 0; i < n; ++i) out[i] = t##_clamp(a[i], lo, hi);                break; \
+        default: return false;                                                                                   \
+        }                                                                                                        \
+        return true;                                                                                             \
+    }                                                                                                            \
+    switch (op) {                                                                                                \
+    case LA_OP_SUM:   span##_sum(out, a, b, n);                 break;                                           \
+    case LA_OP_SUB:   span##_sub(out, a, b, n);                 break;                                           \
+    case LA_OP_MUL:   span##_mul(out, a, b, n);                 break;                                           \
+    case LA_OP_MIN:   span##_min(out, a, b, n);                 break;                                           \
+    case LA_OP_MAX:   span##_max(out, a, b, n);                 break;                                           \
+    case LA_OP_LERP:  span##_lerp(out, a, b, LA_BENCH_T, n);    break;                                           \
+    case LA_OP_CLAMP: span##_clamp(out, a, lo, hi, n);          break;                                           \
+    default: return false;                                                                                       \
+    }                                                                                                            \
+    return true;
+
+static bool la_bench_span2f(La_Op op, bool per_element, const V2f *a, const V2f *b, V2f *out, size_t n)
+{
+    V2f lo = v2f(-10.0f, -20.0f);
+    V2f hi = v2f(10.0f, 20.0f);
+    LA_BENCH_SPAN(v2f, span2f, lo, hi)
+}
+
+static bool la_bench_span4f(La_Op op, bool per_element, const V4f *a, const V4f *b, V4f *out, size_t n)
+{
+    V4f lo = v4f(-10.0f, -20.0f, -30.0f, -40.0f);
+    V4f hi = v4f(10.0f, 20.0f, 30.0f, 40.0f);
+    LA_BENCH_SPAN(v4f, span4f, lo, hi)
+}
+
+bool la_bench_span(La_Op op, size_t components, bool per_element, const float *a, const float *b, float *out, size_t n)
+{
+    switch (components) {
+    case 1:  return la_bench_spanf(op, per_element, a, b, out, n);
+    case 2:  return la_bench_span2f(op, per_element, (const V2f *) a, (const V2f *) b, (V2f *) out, n);
+    case 4:  return la_bench_span4f(op, per_element, (const V4f *) a, (const V4f *) b, (V4f *) out, n);
+    default: return false;
+    }
+}
+
+void la_bench_transform(size_t components, bool per_element, const float *src, float *out, size_t n)
+{
+    if (components == 2) {
+        M3f m = m3f_mul(m3f_translate(v2f(400, 300)), m3f_mul(m3f_rotate(0.5f), m3f_scale(v2f(2, 3))));
+        const V2f *points = (const V2f *) src;
+        V2f *dst = (V2f *) out;
+        if (per_element) {
+            for (size_t i = 0; i < n; ++i) dst[i] = m3f_transform_point(m, points[i]);
+        } else {
+            m3f_transform_points(m, dst, points, n);
+        }
+    } else {
+        M4f m = m4f_mul(m4f_ortho(0, 800, 600, 0, -1, 1), m4f_rotate_z(0.5f));
+        const V4f *points = (const V4f *) src;
+        V4f *dst = (V4f *) out;
+        if (per_element) {
+            for (size_t i = 0; i < n; ++i) dst[i] = m4f_transform(m, points[i]);
+        } else {
+            m4f_transform_points(m, dst, points, n);
+        }
+    }
+}
+#endif // LA_NO_SIMD
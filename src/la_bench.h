@@ -0,0 +1,77 @@
+#ifndef LA_BENCH_H_
+#define LA_BENCH_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "la.h"
+
+// The float vector operations of la.h applied over arrays, so the benchmark can run them
+// through the backend la.h picked for the target (la_bench.c) and through the plain per
+// component code (la_bench_scalar.c, built with LA_NO_SIMD) and compare bits and speed.
+
+typedef enum {
+    LA_OP_SUM = 0,
+    LA_OP_SUB,
+    LA_OP_MUL,
+    LA_OP_DIV,
+    LA_OP_SQRT,
+    LA_OP_MIN,
+    LA_OP_MAX,
+    LA_OP_LERP,
+    LA_OP_FLOOR,
+    LA_OP_CEIL,
+    LA_OP_CLAMP,
+    COUNT_LA_OPS,
+} La_Op;
+
+const char *la_op_name(La_Op op);
+
+// out[i] = op(a[i], b[i], c[i]), unary operations only read a, binary ones a and b
+void la_bench_v2f(La_Op op, const V2f *a, const V2f *b, const V2f *c, V2f *out, size_t n);
+void la_bench_v3f(La_Op op, const V3f *a, const V3f *b, const V3f *c, V3f *out, size_t n);
+void la_bench_v4f(La_Op op, const V4f *a, const V4f *b, const V4f *c, V4f *out, size_t n);
+void la_bench_v2f_scalar(La_Op op, const V2f *a, const V2f *b, const V2f *c, V2f *out, size_t n);
+void la_bench_v3f_scalar(La_Op op, const V3f *a, const V3f *b, const V3f *c, V3f *out, size_t n);
+void la_bench_v4f_scalar(La_Op op, const V4f *a, const V4f *b, const V4f *c, V4f *out, size_t n);
+
+// Runs the span kernel of op over n elements of 1 (spanf), 2 or 4 floats, or with
+// per_element the loop over the single value functions the span replaces. Lerp uses a fixed
+// t and clamp fixed bounds. Returns false when op has no span kernel.
+bool la_bench_span(La_Op op, size_t components, bool per_element, const float *a, const float *b, float *out, size_t n);
+// Transforms n V2f (components 2, M3f) or V4f (components 4, M4f) points with a fixed
+// matrix through the batched kernel or a loop over the single point function
+void la_bench_transform(size_t components, bool per_element, const float *src, float *out, size_t n);
+
+typedef enum {
+    LA_FAST_SIN = 0,
+    LA_FAST_COS,
+    LA_FAST_EXP2,
+    LA_FAST_LOG2,
+    LA_FAST_POW,
+    COUNT_LA_FASTS,
+} La_Fast;
+
+const char *la_fast_name(La_Fast f);
+
+// out[i] = f(a[i]) through the span of the _fast approximation or with libm through the
+// float function it replaces. pow also reads the exponents from b.
+void la_bench_fast(La_Fast f, bool libm, const float *a, const float *b, float *out, size_t n);
+void la_bench_fast_scalar(La_Fast f, bool libm, const float *a, const float *b, float *out, size_t n);
+
+typedef enum {
+    LA_PACK_HALF = 0,
+    LA_PACK_UNORM16,
+    LA_PACK_RGBA8,
+    LA_PACK_RGBA8_SRGB,
+    COUNT_LA_PACKS,
+} La_Pack;
+
+const char *la_pack_name(La_Pack p);
+
+// Converts n floats to the packed type of p or, with unpack, back. For RGBA8 n is a
+// multiple of 4 and packed points to n/4 Rgba8, otherwise to n unsigned shorts.
+void la_bench_pack(La_Pack p, bool unpack, float *floats, void *packed, size_t n);
+void la_bench_pack_scalar(La_Pack p, bool unpack, float *floats, void *packed, size_t n);
+
+#endif // LA_BENCH_H_
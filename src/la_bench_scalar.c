@@ -0,0 +1,4 @@
+// The plain per component reference of la_bench.c
+#define LA_NO_SIMD
+#define LA_BENCH_NAME(name) name##_scalar
+#include "la_bench.c"
@@ -1,4 +1,6 @@
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 
 #include <GL/glew.h>
 #define GLFW_INCLUDE_NONE
@@ -7,6 +9,20 @@
 #include "common.h"
 #include "renderer.h"
 #include "glyph.h"
+#include "app.h"
+#include "gpu_memory.h"
+#include "profiler.h"
+#include "trace.h"
+#include "replay.h"
+#include "timestep.h"
+#include "pacing.h"
+#include "render_list.h"
+#include "render_thread.h"
+#include "redraw.h"
+#include "damage.h"
+#include "present.h"
+#include "atlas_builder.h"
+#include "entities.h"
 
 static void debug_callback(GLenum source, GLenum type, GLuint id, GLenum severity, GLsizei length, const GLchar *message, const void *userParam)
 {
@@ -25,20 +41,177 @@ static void glfw_error_callback(int error, const char *desc)
     fprintf(stderr, "ERROR: %s\n", desc);
 }
 
-static void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods)
+static Free_Glyph_Atlas atlas = {0};
+static Atlas_Builder atlas_builder = {0};
+static Renderer renderer = {0};
+// Records the frames into command lists when the render thread draws them
+static Renderer recorder = {0};
+static Render_Thread render_thread = {0};
+// Or into a single command list for the damage tracking
+static Render_List damage_list = {0};
+static Damage damage = {0};
+static Present present = {0};
+static Replay replay = {0};
+static Pacing pacing = {0};
+static Redraw redraw = {0};
+static Entities entities = {0};
+static bool pause_requested = false;
+
+static void handle_key(GLFWwindow *window, int key, int action, int mods)
 {
-    (void) scancode;
     (void) mods;
     if (key == GLFW_KEY_ESCAPE && action == GLFW_PRESS)
         glfwSetWindowShouldClose(window, GLFW_TRUE);
+    if (key == GLFW_KEY_F1 && action == GLFW_PRESS)
+        profiler.hud = !profiler.hud;
+    if (key == GLFW_KEY_SPACE && action == GLFW_PRESS)
+        pause_requested = !pause_requested;
 }
 
-static Free_Glyph_Atlas atlas = {0};
-static Renderer renderer = {0};
+// While a replay is playing only the recorded keys are handled, Escape still quits
+static void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods)
+{
+    (void) scancode;
+    if (replay.mode == REPLAY_PLAY) {
+        if (key == GLFW_KEY_ESCAPE) handle_key(window, key, action, mods);
+        return;
+    }
+    replay_key(&replay, key, action, mods);
+    handle_key(window, key, action, mods);
+    redraw_request(&redraw);
+}
+
+// The window was exposed or resized and its content is lost
+static void refresh_callback(GLFWwindow *window)
+{
+    (void) window;
+    redraw_request(&redraw);
+}
 
-int main()
+static void framebuffer_size_callback(GLFWwindow *window, int width, int height)
+{
+    (void) window;
+    (void) width;
+    (void) height;
+    redraw_request(&redraw);
+}
+
+// E.g. the window moved to a monitor with another DPI
+static void content_scale_callback(GLFWwindow *window, float xscale, float yscale)
+{
+    (void) window;
+    (void) xscale;
+    (void) yscale;
+    redraw_request(&redraw);
+}
+
+static void usage(const char *program)
+{
+    fprintf(stderr, "Usage: %s [OPTIONS]\n", program);
+    fprintf(stderr, "    --uber                   draw color, text and rainbow content with a single combined shader\n");
+    fprintf(stderr, "    --profile                measure frame timings, F1 toggles the overlay\n");
+    fprintf(stderr, "    --sim-hz <hz>            simulation steps per second, independent of the frame rate (default: %.0f)\n", TIMESTEP_DEFAULT_HZ);
+    fprintf(stderr, "    --pacing <mode>          vsync, adaptive, uncapped or limit (default: vsync)\n");
+    fprintf(stderr, "    --fps-limit <fps>        frame rate of the limit mode (default: %.0f)\n", PACING_DEFAULT_LIMIT_FPS);
+    fprintf(stderr, "    --low-latency            wait for the previous frame on the GPU before sampling input\n");
+    fprintf(stderr, "    --render-thread          submit and swap frames on a separate thread while the next one is built\n");
+    fprintf(stderr, "    --on-demand              only redraw on input, animation and timers, Space pauses the scene\n");
+    fprintf(stderr, "    --damage                 only redraw the regions that changed since the previous frame\n");
+    fprintf(stderr, "    --entities <n>           simulate and draw n bouncing rects on top of the scene (default: 0)\n");
+    fprintf(stderr, "    --gpu-budget <MiB>       warn when buffers and textures exceed this size (default: %d)\n", GPU_MEMORY_DEFAULT_BUDGET/(1024*1024));
+    fprintf(stderr, "    --trace <path.json>      record a Chrome trace of the frames\n");
+    fprintf(stderr, "    --trace-csv <path.csv>   write per frame statistics\n");
+    fprintf(stderr, "    --record <path>          record the time and input of every frame\n");
+    fprintf(stderr, "    --replay <path>          play a recording back with vsync off and print the frame times\n");
+    fprintf(stderr, "    --replay-speed <x>       pace the replay at x times the recorded speed (default: 0, unthrottled)\n");
+}
+
+int main(int argc, char **argv)
 {
     int result = 0;
+    bool profile = false;
+    const char *trace_file_path = NULL;
+    const char *trace_csv_file_path = NULL;
+    const char *record_file_path = NULL;
+    const char *replay_file_path = NULL;
+    double replay_speed = 0.0;
+    double sim_hz = TIMESTEP_DEFAULT_HZ;
+    Pacing_Mode pacing_mode = PACING_VSYNC;
+    double fps_limit = PACING_DEFAULT_LIMIT_FPS;
+    bool low_latency = false;
+    bool threaded = false;
+    bool on_demand = false;
+    bool damaged = false;
+    size_t entities_count = 0;
+
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--uber") == 0) {
+            renderer.uber = true;
+        } else if (strcmp(argv[i], "--profile") == 0) {
+            profile = true;
+        } else if (strcmp(argv[i], "--sim-hz") == 0 && i + 1 < argc) {
+            sim_hz = atof(argv[++i]);
+            if (sim_hz <= 0.0) {
+                usage(argv[0]);
+                fprintf(stderr, "ERROR: invalid simulation rate %s\n", argv[i]);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--pacing") == 0 && i + 1 < argc) {
+            if (!pacing_mode_by_name(argv[++i], &pacing_mode)) {
+                usage(argv[0]);
+                fprintf(stderr, "ERROR: unknown pacing mode %s\n", argv[i]);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--fps-limit") == 0 && i + 1 < argc) {
+            fps_limit = atof(argv[++i]);
+            if (fps_limit <= 0.0) {
+                usage(argv[0]);
+                fprintf(stderr, "ERROR: invalid frame rate %s\n", argv[i]);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--low-latency") == 0) {
+            low_latency = true;
+        } else if (strcmp(argv[i], "--render-thread") == 0) {
+            threaded = true;
+        } else if (strcmp(argv[i], "--on-demand") == 0) {
+            on_demand = true;
+        } else if (strcmp(argv[i], "--damage") == 0) {
+            damaged = true;
+        } else if (strcmp(argv[i], "--entities") == 0 && i + 1 < argc) {
+            entities_count = strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--gpu-budget") == 0 && i + 1 < argc) {
+            gpu_memory_set_budget((size_t) (atof(argv[++i])*1024*1024));
+        } else if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc) {
+            trace_file_path = argv[++i];
+        } else if (strcmp(argv[i], "--trace-csv") == 0 && i + 1 < argc) {
+            trace_csv_file_path = argv[++i];
+        } else if (strcmp(argv[i], "--record") == 0 && i + 1 < argc) {
+            record_file_path = argv[++i];
+        } else if (strcmp(argv[i], "--replay") == 0 && i + 1 < argc) {
+            replay_file_path = argv[++i];
+        } else if (strcmp(argv[i], "--replay-speed") == 0 && i + 1 < argc) {
+            replay_speed = atof(argv[++i]);
+        } else {
+            usage(argv[0]);
+            fprintf(stderr, "ERROR: unknown flag %s\n", argv[i]);
+            return 1;
+        }
+    }
+    if (record_file_path && replay_file_path) {
+        usage(argv[0]);
+        fprintf(stderr, "ERROR: --record and --replay can not be combined\n");
+        return 1;
+    }
+    if (low_latency && threaded) {
+        usage(argv[0]);
+        fprintf(stderr, "ERROR: --low-latency waits for every frame, which defeats --render-thread\n");
+        return 1;
+    }
+    if (damaged && threaded) {
+        usage(argv[0]);
+        fprintf(stderr, "ERROR: --damage can not be combined with --render-thread\n");
+        return 1;
+    }
 
     glfwSetErrorCallback(glfw_error_callback);
 
@@ -48,34 +221,14 @@ int main()
         return_defer(1);
     }
 
-    FT_Library library = {0};
-
-    FT_Error error = FT_Init_FreeType(&library);
-    if (error) {
-        fprintf(stderr, "ERROR: Could not initialize FreeType2 library\n");
-        return_defer(1);
-    }
-
-    const char *const font_file_path = "./assets/Poly-Regular.ttf";
-
     FT_Face face;
-    error = FT_New_Face(library, font_file_path, 0, &face);
-    if (error == FT_Err_Unknown_File_Format) {
-        fprintf(stderr, "ERROR: %s has an unkown format\n", font_file_path);
-        return_defer(1);
-    } else if (error) {
-        fprintf(stderr, "ERROR: Could not load file %s\n", font_file_path);
-        return_defer(1);
-    }
-
-    FT_UInt pixel_size = FREE_GLYPH_FONT_SIZE;
-    error = FT_Set_Pixel_Sizes(face, 0, pixel_size);
-    if (error) {
-        fprintf(stderr, "ERROR: Could not set pixel size to %u\n", pixel_size);
+    if (!app_load_face(APP_FONT_FILE_PATH, FREE_GLYPH_FONT_SIZE, &face)) {
         return_defer(1);
     }
 
-    glfwWindowHint(GLFW_RESIZABLE, GLFW_FALSE); // Doesn't work for some reason
+    glfwWindowHint(GLFW_RESIZABLE, GLFW_TRUE);
+    // The size is in logical units, platforms that size windows in pixels scale it
+    glfwWindowHint(GLFW_SCALE_TO_MONITOR, GLFW_TRUE);
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
     window = glfwCreateWindow(SCREEN_WIDTH, SCREEN_HEIGHT, "App", 0, 0);
@@ -100,46 +253,215 @@ int main()
     printf("OpenGL version: %s\n", glGetString(GL_VERSION));
 
     renderer_init(&renderer);
+    // The first atlas is built right away at the scale of the window, later scale changes
+    // rebuild it in the background
+    float scale = 1.0f;
+    glfwGetWindowContentScale(window, &scale, NULL);
+    FT_UInt pixel_size = free_glyph_atlas_pixel_size(scale);
+    if (FT_Set_Pixel_Sizes(face, 0, pixel_size)) {
+        fprintf(stderr, "ERROR: Could not set pixel size to %u\n", pixel_size);
+        return_defer(1);
+    }
     free_glyph_atlas_init(&atlas, face);
+    if (!atlas_builder_start(&atlas_builder, face)) return_defer(1);
+    // The queries would have to be issued and collected on the render thread, and with
+    // damage tracking the recorded batches are drawn after the scopes ended
+    profiler_init(profile, !threaded && !damaged);
+    profiler.hud = profile;
+    if ((trace_file_path || trace_csv_file_path) && !trace_init(trace_file_path, trace_csv_file_path)) {
+        return_defer(1);
+    }
 
-    V2f rect_pos  = v2f(SCREEN_WIDTH/2, SCREEN_HEIGHT/2);
-    V2f rect_vel  = v2f(1, 1);
-    V2f rect_size = v2f(100, 100);
-    float rect_speed = 1;
+    if (record_file_path && !replay_record(&replay, record_file_path)) return_defer(1);
+    if (replay_file_path && !replay_play(&replay, replay_file_path)) return_defer(1);
 
-    V2f text_pos;
+    App app = {0};
+    app_init(&app);
+    // Outside of App, so the final state of a replay is compared without them
+    if (entities_count > 0) {
+        if (!entities_init(&entities, 0)) return_defer(1);
+        if (!entities_spawn(&entities, entities_count, app.size, 1)) return_defer(1);
+    }
+    Timestep timestep;
+    timestep_init(&timestep, sim_hz);
 
     glClearColor(0, 0, 0, 1);
     glfwSetKeyCallback(window, key_callback);
-    glfwSwapInterval(1);
+    glfwSetWindowRefreshCallback(window, refresh_callback);
+    glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+    glfwSetWindowContentScaleCallback(window, content_scale_callback);
+    // Replays measure how fast the frames can be rendered
+    if (replay.mode == REPLAY_PLAY) pacing_mode = PACING_UNCAPPED;
+    pacing_init(&pacing, pacing_mode, fps_limit, low_latency);
+    // The frames are built with the recorder instead, renderer draws the recorded lists
+    Renderer *r = &renderer;
+    if (threaded || damaged) {
+        recorder.uber = renderer.uber;
+        renderer_init_recording(&recorder, NULL);
+        r = &recorder;
+    }
+    if (damaged) present_init(&present, window);
+    if (threaded) {
+        glfwMakeContextCurrent(NULL);
+        if (!render_thread_start(&render_thread, window, &renderer)) {
+            glfwMakeContextCurrent(window);
+            return_defer(1);
+        }
+    }
+    // Replays draw every recorded frame
+    redraw_init(&redraw, on_demand && replay.mode != REPLAY_PLAY);
+    double replay_secs = 0.0, replay_min = INFINITY, replay_max = 0.0;
+    double scene_time = 0.0, prev_frame_time = NAN;
     while (!glfwWindowShouldClose(window)) {
-        renderer.time = glfwGetTime();
-
-        int cur_width, cur_height;
-        glfwGetFramebufferSize(window, &cur_width, &cur_height);
-        renderer.resolution = v2f(cur_width, cur_height);
-        glViewport(0, 0, cur_width, cur_height);
-        glClear(GL_COLOR_BUFFER_BIT);
-
-        renderer_set_shader(&renderer, SHADER_TEXT);
-        text_pos = v2f(0, SCREEN_HEIGHT-FREE_GLYPH_FONT_SIZE);
-        free_glyph_atlas_render_line_sized(&atlas, &renderer, APP_TITLE, APP_TITLE_LEN, &text_pos, v4f(1, 1, 1, 1));
-        renderer_flush(&renderer);
-
-        renderer_set_shader(&renderer, SHADER_RAINBOW);
-        renderer_rect_center(&renderer, rect_pos, v4f(0, 0, 0, 1), rect_size);
-        rect_pos = v2f_sum(rect_pos, v2f(rect_speed * rect_vel.x, rect_speed * rect_vel.y));
-        if (rect_pos.x + rect_size.x/2 >= SCREEN_WIDTH) rect_vel = v2f_mul(rect_vel, v2f(-1, 1));
-        if (rect_pos.y + rect_size.y/2 >= SCREEN_HEIGHT) rect_vel = v2f_mul(rect_vel, v2f(1, -1));
-        if (rect_pos.x - rect_size.x/2 <= 0) rect_vel = v2f_mul(rect_vel, v2f(-1, 1));
-        if (rect_pos.y - rect_size.y/2 <= 0) rect_vel = v2f_mul(rect_vel, v2f(1, -1));
-
-        renderer_flush(&renderer);
-        glfwSwapBuffers(window);
+        // Before the frame starts, so the profiler does not count the idle time
+        redraw_wait(&redraw, window);
+        if (glfwWindowShouldClose(window)) break;
+
+        profiler_begin_frame();
+        PROFILER_BEGIN(PROFILER_SCOPE_PACING);
+        pacing_wait(&pacing);
+        PROFILER_END(PROFILER_SCOPE_PACING);
+        // Input is sampled right before the frame is built from it
+        PROFILER_BEGIN(PROFILER_SCOPE_POLL);
         glfwPollEvents();
+        PROFILER_END(PROFILER_SCOPE_POLL);
+        pacing_input_sampled(&pacing);
+
+        Replay_Frame frame = {0};
+        frame.time = glfwGetTime();
+        glfwGetFramebufferSize(window, &frame.width, &frame.height);
+        glfwGetWindowContentScale(window, &frame.scale, NULL);
+        if (!replay_frame(&replay, &frame)) {
+            profiler_end_frame();
+            break;
+        }
+        app_resize(&app, frame.width, frame.height, frame.scale);
+        atlas_builder_request(&atlas_builder, free_glyph_atlas_pixel_size(frame.scale), &atlas);
+        if (replay.mode == REPLAY_PLAY) {
+            for (size_t i = 0; i < frame.keys_count; ++i) {
+                handle_key(window, frame.keys[i].key, frame.keys[i].action, frame.keys[i].mods);
+            }
+            replay_wait(&replay, &frame, replay_speed);
+        }
+        double frame_start = glfwGetTime();
+
+        Render_List *list = NULL;
+        if (threaded) {
+            PROFILER_BEGIN(PROFILER_SCOPE_HANDOFF);
+            list = render_thread_acquire(&render_thread);
+            PROFILER_END(PROFILER_SCOPE_HANDOFF);
+            // The frame this list carried before was presented in the meantime
+            if (list->present_time > 0.0) {
+                double latency = list->present_time - list->input_time;
+                pacing_record_present(&pacing, latency);
+                profiler_record(PROFILER_SCOPE_LATENCY, latency);
+            }
+            render_list_reset(list, frame.width, frame.height);
+            list->input_time = pacing.input_time;
+            recorder.record = list;
+        } else if (damaged) {
+            render_list_reset(&damage_list, frame.width, frame.height);
+            recorder.record = &damage_list;
+        } else {
+            glViewport(0, 0, frame.width, frame.height);
+            glClear(GL_COLOR_BUFFER_BIT);
+        }
+        // Nothing of this frame references the atlas yet
+        if (atlas_builder_poll(&atlas_builder, &atlas)) {
+            if (threaded) {
+                render_list_update_atlas(list, &atlas);
+            } else {
+                free_glyph_atlas_update(&atlas);
+            }
+            damage_invalidate(&damage);
+        }
+        // The shaders stop with the scene as well
+        if (!isnan(prev_frame_time) && !app.paused) scene_time += frame.time - prev_frame_time;
+        prev_frame_time = frame.time;
+        r->time = scene_time;
+        r->resolution = v2f(frame.width, frame.height);
+
+        // The recorded frame times drive the steps, so replays simulate the same states
+        size_t steps = timestep_advance(&timestep, frame.time);
+        for (size_t i = 0; i < steps; ++i) {
+            app_update(&app);
+            if (entities_count > 0) entities_update(&entities, app.size, app.paused);
+        }
+        // Only after the steps: when a key resumes the scene after an idle wait, the slept
+        // time still passes paused instead of moving the scene all at once
+        if (pause_requested) {
+            app.paused = !app.paused;
+            pause_requested = false;
+        }
+        app_render(&app, r, &atlas, timestep_alpha(&timestep));
+        if (entities_count > 0) {
+            renderer_set_shader(r, SHADER_COLOR);
+            entities_render(&entities, r, timestep_alpha(&timestep), app.scale);
+            renderer_flush(r);
+        }
+        profiler_draw_hud(r, &atlas, app.scale);
+
+        if (threaded) {
+            render_thread_submit(&render_thread, list);
+        } else if (damaged && frame.width > 0 && frame.height > 0) {
+            // A minimized window has no framebuffer to retain
+            if (!present_begin(&present, &damage, frame.width, frame.height)) return_defer(1);
+            damage_compute(&damage, &damage_list);
+            damage_draw(&damage, &damage_list, &renderer, v4f(0, 0, 0, 1));
+            PROFILER_BEGIN(PROFILER_SCOPE_SWAP);
+            present_end(&present, &damage);
+            PROFILER_END(PROFILER_SCOPE_SWAP);
+            profiler_record(PROFILER_SCOPE_LATENCY, pacing_presented(&pacing));
+        } else {
+            PROFILER_BEGIN(PROFILER_SCOPE_SWAP);
+            glfwSwapBuffers(window);
+            PROFILER_END(PROFILER_SCOPE_SWAP);
+            profiler_record(PROFILER_SCOPE_LATENCY, pacing_presented(&pacing));
+        }
+        profiler_end_frame();
+        renderer_end_frame(r);
+        trace_frame(&r->last_frame);
+        trace_flush();
+
+        redraw_drawn(&redraw);
+        if (!app.paused) {
+            redraw_request(&redraw);
+        } else if (profiler.enabled && profiler.hud) {
+            redraw_request_at(&redraw, glfwGetTime() + REDRAW_HUD_PERIOD);
+        }
+        // A still scene picks up the rebuilt atlas as well
+        if (atlas_builder_busy(&atlas_builder)) {
+            redraw_request_at(&redraw, glfwGetTime() + ATLAS_BUILDER_POLL_PERIOD);
+        }
+
+        double frame_secs = glfwGetTime() - frame_start;
+        replay_secs += frame_secs;
+        if (frame_secs < replay_min) replay_min = frame_secs;
+        if (frame_secs > replay_max) replay_max = frame_secs;
+    }
+    render_thread_stop(&render_thread);
+
+    if (replay.mode == REPLAY_PLAY && replay.frames > 0) {
+        printf("Replayed %zu frames in %.3f s: min %.3f avg %.3f max %.3f ms\n",
+               replay.frames, replay_secs, replay_min*1000.0, replay_secs/replay.frames*1000.0, replay_max*1000.0);
+    }
+    if (profile) {
+        renderer_print_stats(r, stdout);
+        gpu_memory_report(stdout);
+        pacing_report(&pacing, stdout);
+        redraw_report(&redraw, stdout);
+        if (damaged) damage_report(&damage, stdout);
     }
+    if (!replay_finish(&replay, app_hash(&app))) return_defer(1);
 
 defer:
+    atlas_builder_stop(&atlas_builder);
+    if (entities.threads) entities_destroy(&entities);
+    present_destroy(&present);
+    damage_destroy(&damage);
+    render_list_destroy(&damage_list);
+    pacing_destroy(&pacing);
+    trace_shutdown();
     if (window) glfwDestroyWindow(window);
     return result;
 }
@@ -0,0 +1,177 @@
+#define _POSIX_C_SOURCE 200809L
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define GLFW_INCLUDE_NONE
+#include <GLFW/glfw3.h>
+
+#include "pacing.h"
+
+static_assert(COUNT_PACING_MODES == 4, "Update the names of the pacing modes accordingly");
+static const char *pacing_mode_names[COUNT_PACING_MODES] = {
+    [PACING_VSYNC]    = "vsync",
+    [PACING_ADAPTIVE] = "adaptive",
+    [PACING_UNCAPPED] = "uncapped",
+    [PACING_LIMIT]    = "limit",
+};
+
+const char *pacing_mode_name(Pacing_Mode mode)
+{
+    assert(mode < COUNT_PACING_MODES);
+    return pacing_mode_names[mode];
+}
+
+bool pacing_mode_by_name(const char *name, Pacing_Mode *mode)
+{
+    for (Pacing_Mode m = 0; m < COUNT_PACING_MODES; ++m) {
+        if (strcmp(pacing_mode_names[m], name) == 0) {
+            *mode = m;
+            return true;
+        }
+    }
+    return false;
+}
+
+void pacing_init(Pacing *p, Pacing_Mode mode, double limit_fps, bool low_latency)
+{
+    memset(p, 0, sizeof(*p));
+    p->mode = mode;
+    p->low_latency = low_latency;
+    p->limit_period = 1.0/limit_fps;
+
+    int interval = 0;
+    switch (mode) {
+    case PACING_VSYNC:
+        interval = 1;
+        break;
+    case PACING_ADAPTIVE:
+        if (glfwExtensionSupported("GLX_EXT_swap_control_tear") || glfwExtensionSupported("WGL_EXT_swap_control_tear")) {
+            interval = -1;
+        } else {
+            fprintf(stderr, "WARNING: adaptive vsync is not supported by the driver, using vsync\n");
+            p->mode = PACING_VSYNC;
+            interval = 1;
+        }
+        break;
+    case PACING_UNCAPPED:
+    case PACING_LIMIT:
+        interval = 0;
+        break;
+    default: assert(0 && "unreachable");
+    }
+    glfwSwapInterval(interval);
+    if (low_latency) glGenQueries(1, &p->gpu_done);
+}
+
+void pacing_destroy(Pacing *p)
+{
+    if (p->fence) glDeleteSync(p->fence);
+    p->fence = NULL;
+    if (p->gpu_done) glDeleteQueries(1, &p->gpu_done);
+    p->gpu_done = 0;
+}
+
+static void pacing_sample(Pacing_Latency *l, double secs)
+{
+    l->samples[l->next] = secs;
+    l->next = (l->next + 1) % PACING_HISTORY;
+    if (l->count < PACING_HISTORY) l->count += 1;
+}
+
+static void pacing_sleep(double secs)
+{
+    struct timespec ts = {
+        .tv_sec = (time_t) secs,
+        .tv_nsec = (long) ((secs - floor(secs))*1e9),
+    };
+    nanosleep(&ts, NULL);
+}
+
+void pacing_wait(Pacing *p)
+{
+    if (p->fence) {
+        GLenum status = glClientWaitSync(p->fence, GL_SYNC_FLUSH_COMMANDS_BIT, PACING_FENCE_TIMEOUT_NS);
+        if (status == GL_ALREADY_SIGNALED || status == GL_CONDITION_SATISFIED) {
+            // The query was issued before the fence, so it has its result by now
+            GLuint64 done = 0;
+            glGetQueryObjectui64v(p->gpu_done, GL_QUERY_RESULT, &done);
+            pacing_sample(&p->gpu, (double) ((GLint64) done - p->fence_input)*1e-9);
+        } else {
+            p->fence_timeouts += 1;
+        }
+        glDeleteSync(p->fence);
+        p->fence = NULL;
+    }
+
+    if (p->mode == PACING_LIMIT) {
+        double now = glfwGetTime();
+        // Start over instead of rushing frames after a stall
+        if (p->deadline == 0.0 || now - p->deadline > p->limit_period) p->deadline = now;
+        // The OS wakes up late, the last part is spent spinning
+        if (p->deadline - now > PACING_SPIN_SECS) pacing_sleep(p->deadline - now - PACING_SPIN_SECS);
+        while (glfwGetTime() < p->deadline) {}
+        p->deadline += p->limit_period;
+    }
+}
+
+void pacing_input_sampled(Pacing *p)
+{
+    p->input_time = glfwGetTime();
+    if (p->low_latency) glGetInteger64v(GL_TIMESTAMP, &p->gpu_input_time);
+}
+
+double pacing_presented(Pacing *p)
+{
+    double latency = glfwGetTime() - p->input_time;
+    pacing_record_present(p, latency);
+    if (p->low_latency) {
+        glQueryCounter(p->gpu_done, GL_TIMESTAMP);
+        p->fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        p->fence_input = p->gpu_input_time;
+    }
+    return latency;
+}
+
+void pacing_record_present(Pacing *p, double latency)
+{
+    pacing_sample(&p->present, latency);
+}
+
+static int compare_doubles(const void *a, const void *b)
+{
+    double x = *(const double *) a;
+    double y = *(const double *) b;
+    return (x > y) - (x < y);
+}
+
+static void pacing_report_latency(const Pacing_Latency *l, const char *name, FILE *stream)
+{
+    if (l->count == 0) return;
+    static double sorted[PACING_HISTORY];
+    double sum = 0.0;
+    for (size_t i = 0; i < l->count; ++i) {
+        sorted[i] = l->samples[i];
+        sum += sorted[i];
+    }
+    qsort(sorted, l->count, sizeof(sorted[0]), compare_doubles);
+    size_t rank = (size_t) (0.99*l->count + 0.5);
+    if (rank < 1) rank = 1;
+    fprintf(stream, "  input to %-8s min %8.3f avg %8.3f p99 %8.3f ms over %zu frames\n",
+            name, sorted[0]*1000.0, sum/l->count*1000.0, sorted[rank - 1]*1000.0, l->count);
+}
+
+void pacing_report(const Pacing *p, FILE *stream)
+{
+    fprintf(stream, "Pacing: %s", pacing_mode_name(p->mode));
+    if (p->mode == PACING_LIMIT) fprintf(stream, " at %.1f FPS", 1.0/p->limit_period);
+    fprintf(stream, "%s\n", p->low_latency ? ", low latency" : "");
+    pacing_report_latency(&p->present, "present", stream);
+    pacing_report_latency(&p->gpu, "gpu done", stream);
+    if (p->fence_timeouts > 0) {
+        fprintf(stream, "  %zu frames not done on the GPU within %d ms are not counted\n",
+                p->fence_timeouts, PACING_FENCE_TIMEOUT_NS/1000000);
+    }
+}
@@ -0,0 +1,72 @@
+#ifndef PACING_H_
+#define PACING_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+
+#include <GL/glew.h>
+
+// Frame pacing of the windowed app. The modes pick the swap interval, the limiter caps the
+// frame rate on the CPU by sleeping and then spinning for the last PACING_SPIN_SECS. With
+// low_latency every frame first waits on a fence for the previous one to finish on the
+// GPU, so input is sampled and geometry built as late as possible instead of queueing
+// frames behind the driver.
+//
+// Latency is measured from sampling input (pacing_input_sampled, right after polling) to
+// glfwSwapBuffers returning on the CPU clock. With low_latency also to the GPU finishing
+// the frame: a GL_TIMESTAMP query after the swap against the GL time read when input was
+// sampled, so it is as precise as the GPU timer no matter when the CPU reads it. Frames
+// whose fence times out are counted separately instead of sampled.
+
+typedef enum {
+    PACING_VSYNC = 0,
+    PACING_ADAPTIVE, // Swap interval -1: tears instead of waiting another frame when late
+    PACING_UNCAPPED,
+    PACING_LIMIT,    // Uncapped swaps plus the CPU limiter
+    COUNT_PACING_MODES,
+} Pacing_Mode;
+
+#define PACING_DEFAULT_LIMIT_FPS 60.0
+#define PACING_SPIN_SECS 0.002
+#define PACING_HISTORY 1024
+#define PACING_FENCE_TIMEOUT_NS 100000000
+
+typedef struct {
+    double samples[PACING_HISTORY]; // Ring buffer of seconds
+    size_t count;
+    size_t next;
+} Pacing_Latency;
+
+typedef struct {
+    Pacing_Mode mode;
+    bool low_latency;
+    double limit_period;
+    double deadline;
+    GLsync fence;          // Of the previous frame
+    GLuint gpu_done;       // Timestamp query written right before the fence
+    GLint64 fence_input;   // GL time of the input of the frame the fence belongs to
+    GLint64 gpu_input_time;
+    double input_time;
+    size_t fence_timeouts;
+    Pacing_Latency present;
+    Pacing_Latency gpu;
+} Pacing;
+
+const char *pacing_mode_name(Pacing_Mode mode);
+bool pacing_mode_by_name(const char *name, Pacing_Mode *mode);
+
+// Sets the swap interval of the current context, adaptive falls back to vsync when the
+// driver lacks EXT_swap_control_tear
+void pacing_init(Pacing *p, Pacing_Mode mode, double limit_fps, bool low_latency);
+void pacing_destroy(Pacing *p);
+// Blocks until the frame may start: the fence of the previous frame and the limiter
+void pacing_wait(Pacing *p);
+void pacing_input_sampled(Pacing *p);
+// Right after glfwSwapBuffers, returns the input to present latency of the frame
+double pacing_presented(Pacing *p);
+// For frames that were presented by another thread (see render_thread.h)
+void pacing_record_present(Pacing *p, double latency);
+void pacing_report(const Pacing *p, FILE *stream);
+
+#endif  // PACING_H_
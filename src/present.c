@@ -0,0 +1,81 @@
+#include <stdio.h>
+#include <string.h>
+
+#include <GL/glew.h>
+#define GLFW_INCLUDE_NONE
+#include <GLFW/glfw3.h>
+#define GLFW_EXPOSE_NATIVE_EGL
+#include <GLFW/glfw3native.h>
+
+#include "present.h"
+
+static bool present_has_extension(const char *extensions, const char *name)
+{
+    size_t n = strlen(name);
+    for (const char *s = extensions; s && (s = strstr(s, name)) != NULL; s += n) {
+        bool starts = s == extensions || s[-1] == ' ';
+        bool ends = s[n] == ' ' || s[n] == '\0';
+        if (starts && ends) return true;
+    }
+    return false;
+}
+
+void present_init(Present *p, GLFWwindow *window)
+{
+    memset(p, 0, sizeof(*p));
+    p->window = window;
+    if (glfwGetWindowAttrib(window, GLFW_CONTEXT_CREATION_API) != GLFW_EGL_CONTEXT_API) {
+        printf("Swap with damage: not available without an EGL context\n");
+        return;
+    }
+    p->display = glfwGetEGLDisplay();
+    p->surface = glfwGetEGLSurface(window);
+    const char *extensions = eglQueryString(p->display, EGL_EXTENSIONS);
+    if (present_has_extension(extensions, "EGL_KHR_swap_buffers_with_damage")) {
+        p->swap_with_damage = (PFNEGLSWAPBUFFERSWITHDAMAGEKHRPROC) eglGetProcAddress("eglSwapBuffersWithDamageKHR");
+    } else if (present_has_extension(extensions, "EGL_EXT_swap_buffers_with_damage")) {
+        // Same signature as the KHR entry point
+        p->swap_with_damage = (PFNEGLSWAPBUFFERSWITHDAMAGEKHRPROC) eglGetProcAddress("eglSwapBuffersWithDamageEXT");
+    }
+    printf("Swap with damage: %s\n", p->swap_with_damage ? "yes" : "not supported by the driver");
+}
+
+void present_destroy(Present *p)
+{
+    if (p->retained.fbo) framebuffer_destroy(&p->retained);
+}
+
+bool present_begin(Present *p, Damage *d, int width, int height)
+{
+    if (p->retained.fbo == 0 || p->retained.width != width || p->retained.height != height) {
+        if (p->retained.fbo) framebuffer_destroy(&p->retained);
+        if (!framebuffer_init(&p->retained, width, height)) return false;
+        damage_invalidate(d);
+    }
+    framebuffer_bind(&p->retained);
+    return true;
+}
+
+void present_end(Present *p, const Damage *d)
+{
+    // The back buffer is undefined after a swap, so all of it is copied
+    int w = p->retained.width;
+    int h = p->retained.height;
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, p->retained.fbo);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+    glBlitFramebuffer(0, 0, w, h, 0, 0, w, h, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    // Without any damage the whole surface would count as damaged
+    if (p->swap_with_damage && d->rects_count > 0) {
+        EGLint rects[4*DAMAGE_RECTS_CAP];
+        for (size_t i = 0; i < d->rects_count; ++i) {
+            rects[i*4 + 0] = d->rects[i].x0;
+            rects[i*4 + 1] = d->rects[i].y0;
+            rects[i*4 + 2] = d->rects[i].x1 - d->rects[i].x0;
+            rects[i*4 + 3] = d->rects[i].y1 - d->rects[i].y0;
+        }
+        if (p->swap_with_damage(p->display, p->surface, rects, (EGLint) d->rects_count)) return;
+    }
+    glfwSwapBuffers(p->window);
+}
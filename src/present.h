@@ -0,0 +1,36 @@
+#ifndef PRESENT_H_
+#define PRESENT_H_
+
+#include <stdbool.h>
+
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+
+#include "damage.h"
+#include "framebuffer.h"
+
+// Presentation of the damage tracking mode of the windowed app. The frames are drawn into a
+// retained framebuffer, which is copied into the back buffer of the window before the swap.
+// The damaged rects are passed to the swap as a hint, so the compositor only has to update
+// those. The hint needs an EGL context (GLFW on Wayland, or with GLFW_EGL_CONTEXT_API) and
+// EGL_KHR_swap_buffers_with_damage or EGL_EXT_swap_buffers_with_damage, otherwise the
+// window is swapped as usual.
+
+typedef struct GLFWwindow GLFWwindow;
+
+typedef struct {
+    GLFWwindow *window;
+    Framebuffer retained;
+    EGLDisplay display;
+    EGLSurface surface;
+    PFNEGLSWAPBUFFERSWITHDAMAGEKHRPROC swap_with_damage; // NULL when the hint is not available
+} Present;
+
+void present_init(Present *p, GLFWwindow *window);
+void present_destroy(Present *p);
+// Binds the retained framebuffer, it is recreated and d invalidated when the size changed
+bool present_begin(Present *p, Damage *d, int width, int height);
+// Copies the retained framebuffer to the window and swaps
+void present_end(Present *p, const Damage *d);
+
+#endif  // PRESENT_H_
@@ -0,0 +1,228 @@
+#define _POSIX_C_SOURCE 200809L
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "gpu_memory.h"
+#include "profiler.h"
+
+Profiler profiler = {0};
+
+static_assert(COUNT_PROFILER_SCOPES == 9, "Update the names of the profiler scopes accordingly");
+static const char *profiler_scope_names[COUNT_PROFILER_SCOPES] = {
+    [PROFILER_SCOPE_FRAME]     = "frame",
+    [PROFILER_SCOPE_TEXT]      = "text",
+    [PROFILER_SCOPE_FLUSH]     = "flush",
+    [PROFILER_SCOPE_SWAP]      = "swap",
+    [PROFILER_SCOPE_POLL]      = "poll",
+    [PROFILER_SCOPE_PACING]    = "pacing",
+    [PROFILER_SCOPE_LATENCY]   = "latency",
+    [PROFILER_SCOPE_HANDOFF]   = "handoff",
+    [PROFILER_SCOPE_GPU_FLUSH] = "gpu flush",
+};
+
+const char *profiler_scope_name(Profiler_Scope scope)
+{
+    return profiler_scope_names[scope];
+}
+
+static double profiler_now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double) ts.tv_sec + (double) ts.tv_nsec * 1e-9;
+}
+
+void profiler_init(bool enabled, bool gpu_timers)
+{
+    profiler.enabled = enabled;
+    profiler.gpu_timers = gpu_timers;
+    if (!enabled || !gpu_timers) return;
+    // Timer queries are core since OpenGL 3.3
+    glGenQueries(PROFILER_GPU_QUERIES_CAP, profiler.gpu_queries[0]);
+    glGenQueries(PROFILER_GPU_QUERIES_CAP, profiler.gpu_queries[1]);
+}
+
+void profiler_begin_frame(void)
+{
+    TRACE_BEGIN(profiler_scope_name(PROFILER_SCOPE_FRAME));
+    if (!profiler.enabled) return;
+    profiler.frame_start = profiler_now();
+    for (Profiler_Scope s = 0; s < COUNT_PROFILER_SCOPES; ++s) {
+        if (s != PROFILER_SCOPE_GPU_FLUSH) profiler.scope_time[s] = 0.0;
+    }
+}
+
+// Collects the queries of the previous frame, which by now most likely finished on the GPU.
+// Waiting for the result would stall the pipeline that is measured, so when one of them is
+// not available yet the queries are dropped and the previous value is kept.
+static void profiler_collect_gpu_queries(size_t buffer)
+{
+    GLuint64 total = 0;
+    bool available = true;
+    for (size_t i = 0; i < profiler.gpu_queries_count[buffer] && available; ++i) {
+        GLuint64 ready = 0;
+        glGetQueryObjectui64v(profiler.gpu_queries[buffer][i], GL_QUERY_RESULT_AVAILABLE, &ready);
+        available = ready != 0;
+    }
+    for (size_t i = 0; i < profiler.gpu_queries_count[buffer] && available; ++i) {
+        GLuint64 elapsed = 0;
+        glGetQueryObjectui64v(profiler.gpu_queries[buffer][i], GL_QUERY_RESULT, &elapsed);
+        total += elapsed;
+    }
+    profiler.gpu_queries_count[buffer] = 0;
+    if (available) profiler.scope_time[PROFILER_SCOPE_GPU_FLUSH] = (double) total * 1e-9;
+}
+
+void profiler_end_frame(void)
+{
+    TRACE_END(profiler_scope_name(PROFILER_SCOPE_FRAME));
+    if (!profiler.enabled) return;
+    profiler.scope_time[PROFILER_SCOPE_FRAME] = profiler_now() - profiler.frame_start;
+
+    profiler.gpu_queries_current = 1 - profiler.gpu_queries_current;
+    profiler_collect_gpu_queries(profiler.gpu_queries_current);
+
+    size_t index = (profiler.history_begin + profiler.history_count) % PROFILER_HISTORY;
+    if (profiler.history_count < PROFILER_HISTORY) {
+        profiler.history_count += 1;
+    } else {
+        profiler.history_begin = (profiler.history_begin + 1) % PROFILER_HISTORY;
+    }
+    for (Profiler_Scope s = 0; s < COUNT_PROFILER_SCOPES; ++s) {
+        profiler.history[s][index] = profiler.scope_time[s];
+    }
+}
+
+void profiler_scope_begin(Profiler_Scope scope)
+{
+    profiler.scope_start[scope] = profiler_now();
+}
+
+void profiler_scope_end(Profiler_Scope scope)
+{
+    profiler.scope_time[scope] += profiler_now() - profiler.scope_start[scope];
+}
+
+void profiler_record(Profiler_Scope scope, double secs)
+{
+    if (!profiler.enabled) return;
+    profiler.scope_time[scope] += secs;
+}
+
+void profiler_gpu_begin(void)
+{
+    if (!profiler.gpu_timers) return;
+    size_t buffer = profiler.gpu_queries_current;
+    if (profiler.gpu_queries_count[buffer] >= PROFILER_GPU_QUERIES_CAP) return;
+    glBeginQuery(GL_TIME_ELAPSED, profiler.gpu_queries[buffer][profiler.gpu_queries_count[buffer]]);
+    profiler.gpu_query_active = true;
+}
+
+void profiler_gpu_end(void)
+{
+    if (!profiler.gpu_query_active) return;
+    glEndQuery(GL_TIME_ELAPSED);
+    profiler.gpu_queries_count[profiler.gpu_queries_current] += 1;
+    profiler.gpu_query_active = false;
+}
+
+static int compare_doubles(const void *a, const void *b)
+{
+    double x = *(const double *) a;
+    double y = *(const double *) b;
+    return (x > y) - (x < y);
+}
+
+Profiler_Stats profiler_stats(Profiler_Scope scope)
+{
+    Profiler_Stats stats = {0};
+    size_t n = profiler.history_count;
+    if (n == 0) return stats;
+
+    static double sorted[PROFILER_HISTORY];
+    double sum = 0.0;
+    for (size_t i = 0; i < n; ++i) {
+        sorted[i] = profiler.history[scope][(profiler.history_begin + i) % PROFILER_HISTORY];
+        sum += sorted[i];
+    }
+    stats.last = sorted[n - 1];
+    qsort(sorted, n, sizeof(sorted[0]), compare_doubles);
+    stats.min = sorted[0];
+    stats.avg = sum / n;
+    size_t rank = (size_t) (0.99 * n + 0.5);
+    if (rank < 1) rank = 1;
+    stats.p99 = sorted[rank - 1];
+    return stats;
+}
+
+#define HUD_TEXT_SCALE   0.18f
+#define HUD_LINE_HEIGHT  (FREE_GLYPH_FONT_SIZE*HUD_TEXT_SCALE)
+#define HUD_PADDING      8.0f
+#define HUD_GRAPH_HEIGHT 80.0f
+// Frame time that reaches the top of the graph
+#define HUD_GRAPH_MAX_SECS (1.0/30.0)
+
+// Frame time graph, per scope counters, the renderer stats of the last frame and the GPU
+// memory in the bottom left corner
+void profiler_draw_hud(Renderer *r, Free_Glyph_Atlas *atlas, float scale)
+{
+    if (!profiler.enabled || !profiler.hud) return;
+    // The overlay is not part of the frame it measures, the flush of the scene still counts
+    // but the one of the overlay is neither timed nor queried
+    renderer_flush(r);
+    profiler.enabled = false;
+
+    float x = HUD_PADDING*scale;
+    float y = HUD_PADDING*scale;
+    float graph_height = HUD_GRAPH_HEIGHT*scale;
+    float line_height = HUD_LINE_HEIGHT*scale;
+    float text_scale = HUD_TEXT_SCALE*(FREE_GLYPH_FONT_SIZE*scale/atlas->pixel_size);
+
+    renderer_set_shader(r, SHADER_COLOR);
+    renderer_rect(r, v2f(x, y), v4f(0, 0, 0, 0.6f), v2f(PROFILER_HISTORY*scale, graph_height));
+    // 60 FPS budget
+    renderer_rect(r, v2f(x, y + graph_height*(1.0/60.0)/HUD_GRAPH_MAX_SECS), v4f(1, 1, 1, 0.3f), v2f(PROFILER_HISTORY*scale, scale));
+    for (size_t i = 0; i < profiler.history_count; ++i) {
+        double secs = profiler.history[PROFILER_SCOPE_FRAME][(profiler.history_begin + i) % PROFILER_HISTORY];
+        float h = (float) (secs / HUD_GRAPH_MAX_SECS) * graph_height;
+        if (h > graph_height) h = graph_height;
+        V4f color = secs > 1.0/60.0 ? v4f(1, 0.3f, 0.2f, 1) : v4f(0.3f, 1, 0.4f, 1);
+        renderer_rect(r, v2f(x + i*scale, y), color, v2f(scale, h));
+    }
+    y += graph_height + HUD_PADDING*scale;
+
+    renderer_set_shader(r, SHADER_TEXT);
+    {
+        char line[128];
+        int n = snprintf(line, sizeof(line), "gpu memory: %.2f of %.0f MiB in %zu resources",
+                         gpu_memory.total_bytes/(1024.0*1024.0), gpu_memory.budget_bytes/(1024.0*1024.0), gpu_memory.count);
+        V2f pos = v2f(x, y);
+        V4f color = gpu_memory.over_budget ? v4f(1, 0.3f, 0.2f, 1) : v4f(1, 1, 1, 1);
+        free_glyph_atlas_render_line_scaled(atlas, r, line, n, &pos, color, text_scale);
+        y += line_height;
+    }
+    {
+        const size_t *stats = r->last_frame.values;
+        char line[128];
+        int n = snprintf(line, sizeof(line), "batches: %zu flushes %zu forced %zu verts %zu peak",
+                         stats[RENDERER_STAT_FLUSHES], stats[RENDERER_STAT_FORCED_FLUSHES],
+                         stats[RENDERER_STAT_VERTICES], stats[RENDERER_STAT_PEAK_BATCH_FILL]);
+        V2f pos = v2f(x, y);
+        free_glyph_atlas_render_line_scaled(atlas, r, line, n, &pos, v4f(1, 1, 1, 1), text_scale);
+        y += line_height;
+    }
+    for (Profiler_Scope s = COUNT_PROFILER_SCOPES; s-- > 0;) {
+        Profiler_Stats stats = profiler_stats(s);
+        char line[128];
+        int n = snprintf(line, sizeof(line), "%s: min %.2f avg %.2f p99 %.2f ms",
+                         profiler_scope_name(s), stats.min*1000.0, stats.avg*1000.0, stats.p99*1000.0);
+        V2f pos = v2f(x, y);
+        free_glyph_atlas_render_line_scaled(atlas, r, line, n, &pos, v4f(1, 1, 1, 1), text_scale);
+        y += line_height;
+    }
+    renderer_flush(r);
+    profiler.enabled = true;
+}
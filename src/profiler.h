@@ -0,0 +1,90 @@
+#ifndef PROFILER_H_
+#define PROFILER_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "renderer.h"
+#include "glyph.h"
+#include "trace.h"
+
+// Frame profiler: named CPU scopes, GPU timer queries around every renderer_flush and
+// rolling statistics over the last PROFILER_HISTORY frames. When it is disabled every
+// scope costs a single branch. Building with PROFILER_DISABLE compiles the scopes out.
+// The CPU scopes are also recorded as trace events (see trace.h).
+
+typedef enum {
+    PROFILER_SCOPE_FRAME = 0,
+    PROFILER_SCOPE_TEXT,
+    PROFILER_SCOPE_FLUSH,
+    PROFILER_SCOPE_SWAP,
+    PROFILER_SCOPE_POLL,
+    PROFILER_SCOPE_PACING,  // Waiting for the previous frame or the frame limiter
+    PROFILER_SCOPE_LATENCY, // Input to present, recorded with profiler_record
+    PROFILER_SCOPE_HANDOFF, // Waiting for the render thread to return a command list
+    // Measured with GL_TIME_ELAPSED queries around renderer_flush instead of the CPU clock.
+    // Lags one frame behind the CPU scopes because the queries are double buffered, keeps
+    // the previous value when the queries of that frame did not finish yet.
+    PROFILER_SCOPE_GPU_FLUSH,
+    COUNT_PROFILER_SCOPES,
+} Profiler_Scope;
+
+#define PROFILER_HISTORY 240
+#define PROFILER_GPU_QUERIES_CAP 64
+
+typedef struct {
+    double min;
+    double avg;
+    double p99;
+    double last;
+} Profiler_Stats;
+
+typedef struct {
+    bool enabled;
+    bool hud;
+    bool gpu_timers; // False without an OpenGL context (software rasterizer)
+
+    double frame_start;
+    double scope_start[COUNT_PROFILER_SCOPES];
+    double scope_time[COUNT_PROFILER_SCOPES]; // Accumulated during the current frame
+
+    // Seconds per scope of the last PROFILER_HISTORY frames, used as a ring buffer
+    double history[COUNT_PROFILER_SCOPES][PROFILER_HISTORY];
+    size_t history_begin;
+    size_t history_count;
+
+    GLuint gpu_queries[2][PROFILER_GPU_QUERIES_CAP];
+    size_t gpu_queries_count[2];
+    size_t gpu_queries_current;
+    bool gpu_query_active;
+} Profiler;
+
+extern Profiler profiler;
+
+void profiler_init(bool enabled, bool gpu_timers);
+void profiler_begin_frame(void);
+void profiler_end_frame(void);
+void profiler_scope_begin(Profiler_Scope scope);
+void profiler_scope_end(Profiler_Scope scope);
+// Adds a value measured outside of a scope to the current frame
+void profiler_record(Profiler_Scope scope, double secs);
+void profiler_gpu_begin(void);
+void profiler_gpu_end(void);
+Profiler_Stats profiler_stats(Profiler_Scope scope);
+const char *profiler_scope_name(Profiler_Scope scope);
+// scale is the content scale, framebuffer pixels per logical unit
+void profiler_draw_hud(Renderer *r, Free_Glyph_Atlas *atlas, float scale);
+
+#ifdef PROFILER_DISABLE
+#define PROFILER_BEGIN(scope) TRACE_BEGIN(profiler_scope_name(scope))
+#define PROFILER_END(scope)   TRACE_END(profiler_scope_name(scope))
+#define PROFILER_GPU_BEGIN()  ((void) 0)
+#define PROFILER_GPU_END()    ((void) 0)
+#else
+#define PROFILER_BEGIN(scope) do { if (profiler.enabled) profiler_scope_begin(scope); TRACE_BEGIN(profiler_scope_name(scope)); } while (0)
+#define PROFILER_END(scope)   do { if (profiler.enabled) profiler_scope_end(scope); TRACE_END(profiler_scope_name(scope)); } while (0)
+#define PROFILER_GPU_BEGIN()  do { if (profiler.enabled) profiler_gpu_begin(); } while (0)
+#define PROFILER_GPU_END()    do { if (profiler.enabled) profiler_gpu_end(); } while (0)
+#endif // PROFILER_DISABLE
+
+#endif  // PROFILER_H_
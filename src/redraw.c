@@ -0,0 +1,71 @@
+#define _POSIX_C_SOURCE 200809L
+#include <math.h>
+#include <time.h>
+
+#define GLFW_INCLUDE_NONE
+#include <GLFW/glfw3.h>
+
+#include "redraw.h"
+
+// CPU time of all threads of the process, the render and rasterizer threads included
+static double redraw_cpu_time(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    return (double) ts.tv_sec + (double) ts.tv_nsec * 1e-9;
+}
+
+void redraw_init(Redraw *rd, bool on_demand)
+{
+    rd->on_demand = on_demand;
+    rd->dirty = true;
+    rd->deadline = INFINITY;
+    rd->start_time = glfwGetTime();
+    rd->start_cpu = redraw_cpu_time();
+    rd->frames = 0;
+    rd->wakeups = 0;
+}
+
+void redraw_request(Redraw *rd)
+{
+    rd->dirty = true;
+}
+
+void redraw_request_at(Redraw *rd, double time)
+{
+    if (time < rd->deadline) rd->deadline = time;
+}
+
+void redraw_wait(Redraw *rd, GLFWwindow *window)
+{
+    if (!rd->on_demand) return;
+    // Events that request nothing (e.g. focus changes) go back to sleep
+    while (!rd->dirty && !glfwWindowShouldClose(window)) {
+        double timeout = rd->deadline - glfwGetTime();
+        if (timeout <= 0.0) return;
+        if (isinf(timeout)) {
+            glfwWaitEvents();
+        } else {
+            glfwWaitEventsTimeout(timeout);
+        }
+        rd->wakeups += 1;
+    }
+}
+
+void redraw_drawn(Redraw *rd)
+{
+    rd->dirty = false;
+    rd->deadline = INFINITY;
+    rd->frames += 1;
+}
+
+void redraw_report(const Redraw *rd, FILE *stream)
+{
+    double secs = glfwGetTime() - rd->start_time;
+    double cpu = redraw_cpu_time() - rd->start_cpu;
+    if (secs <= 0.0) return;
+    fprintf(stream, "Redraw: %s, %zu frames in %.1f s (%.1f FPS), CPU %.1f%% of one core",
+            rd->on_demand ? "on demand" : "continuous", rd->frames, secs, rd->frames/secs, cpu/secs*100.0);
+    if (rd->on_demand) fprintf(stream, ", %zu wakeups", rd->wakeups);
+    fprintf(stream, "\n");
+}
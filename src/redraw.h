@@ -0,0 +1,40 @@
+#ifndef REDRAW_H_
+#define REDRAW_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+
+// On demand redrawing of the windowed app. Input, animation and timers request the next
+// frame, redraw_wait blocks in glfwWaitEventsTimeout until one of them did, so a window
+// that shows a still scene costs no CPU or GPU time at all. The frame and CPU time
+// accounting runs in both modes, which makes the continuous loop comparable with it.
+
+typedef struct GLFWwindow GLFWwindow;
+
+#define REDRAW_HUD_PERIOD 0.5 // Seconds between two refreshes of a still profiler overlay
+
+typedef struct {
+    bool on_demand;
+    bool dirty;
+    double deadline; // Earliest requested timer, INFINITY when none is armed
+
+    double start_time;
+    double start_cpu;
+    size_t frames;
+    size_t wakeups;  // Returns of glfwWaitEvents and glfwWaitEventsTimeout
+} Redraw;
+
+void redraw_init(Redraw *rd, bool on_demand);
+// Something changed, the next frame has to be drawn
+void redraw_request(Redraw *rd);
+// Draws a frame at the given glfwGetTime() at the latest
+void redraw_request_at(Redraw *rd, double time);
+// Processes events until a frame was requested, a timer is due or the window should close.
+// Returns right away in continuous mode.
+void redraw_wait(Redraw *rd, GLFWwindow *window);
+// After every drawn frame, the requests so far are handled by it
+void redraw_drawn(Redraw *rd);
+void redraw_report(const Redraw *rd, FILE *stream);
+
+#endif  // REDRAW_H_
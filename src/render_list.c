@@ -0,0 +1,108 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "render_list.h"
+
+void render_list_destroy(Render_List *list)
+{
+    free(list->vertices);
+    free(list->materials);
+    free(list->batches);
+    free(list->atlas_update.pixels);
+    memset(list, 0, sizeof(*list));
+}
+
+void render_list_reset(Render_List *list, int width, int height)
+{
+    list->width = width;
+    list->height = height;
+    list->input_time = 0.0;
+    list->present_time = 0.0;
+    list->vertices_count = 0;
+    list->materials_count = 0;
+    list->batches_count = 0;
+    free(list->atlas_update.pixels);
+    list->atlas_update.pixels = NULL;
+}
+
+// Doubles the capacity until count more items fit
+static void *render_list_reserve(void *items, size_t size, size_t *capacity, size_t used, size_t count, size_t initial)
+{
+    if (used + count <= *capacity) return items;
+    size_t new_capacity = *capacity == 0 ? initial : *capacity;
+    while (used + count > new_capacity) new_capacity *= 2;
+    items = realloc(items, size*new_capacity);
+    if (items == NULL) {
+        fprintf(stderr, "ERROR: Could not grow render list to %zu items of %zu bytes\n", new_capacity, size);
+        exit(1);
+    }
+    *capacity = new_capacity;
+    return items;
+}
+
+void render_list_update_atlas(Render_List *list, const Free_Glyph_Atlas *atlas)
+{
+    size_t size = (size_t) atlas->atlas_width*atlas->atlas_height;
+    free(list->atlas_update.pixels);
+    list->atlas_update = *atlas;
+    list->atlas_update.pixels = malloc(size);
+    if (list->atlas_update.pixels == NULL) {
+        fprintf(stderr, "ERROR: Could not copy glyph atlas of %ux%u\n", atlas->atlas_width, atlas->atlas_height);
+        exit(1);
+    }
+    memcpy(list->atlas_update.pixels, atlas->pixels, size);
+}
+
+void render_list_push(Render_List *list, const Renderer *r)
+{
+    list->vertices = render_list_reserve(list->vertices, sizeof(Vertex), &list->vertices_capacity,
+                                         list->vertices_count, r->vertices_count, VERTICES_CAP);
+    list->materials = render_list_reserve(list->materials, sizeof(Material), &list->materials_capacity,
+                                          list->materials_count, r->materials_count, MATERIALS_CAP);
+    list->batches = render_list_reserve(list->batches, sizeof(Render_Batch), &list->batches_capacity,
+                                        list->batches_count, 1, 64);
+
+    list->batches[list->batches_count++] = (Render_Batch) {
+        .shader = r->current_shader,
+        .texture = r->current_texture,
+        .time = r->time,
+        .resolution = r->resolution,
+        .vertices_begin = list->vertices_count,
+        .vertices_count = r->vertices_count,
+        .materials_begin = list->materials_count,
+        .materials_count = r->materials_count,
+    };
+    memcpy(&list->vertices[list->vertices_count], r->vertices, sizeof(Vertex)*r->vertices_count);
+    list->vertices_count += r->vertices_count;
+    memcpy(&list->materials[list->materials_count], r->materials, sizeof(Material)*r->materials_count);
+    list->materials_count += r->materials_count;
+}
+
+void render_list_draw_batch(const Render_List *list, size_t index, Renderer *r)
+{
+    const Render_Batch *batch = &list->batches[index];
+    r->time = batch->time;
+    r->resolution = batch->resolution;
+    renderer_set_shader(r, batch->shader);
+    renderer_set_texture(r, batch->texture);
+    renderer_draw_batch(r,
+                        &list->vertices[batch->vertices_begin], batch->vertices_count,
+                        &list->materials[batch->materials_begin], batch->materials_count);
+}
+
+void render_list_draw(const Render_List *list, Renderer *r)
+{
+    for (size_t i = 0; i < list->batches_count; ++i) {
+        render_list_draw_batch(list, i, r);
+    }
+}
+
+void render_list_submit(const Render_List *list, Renderer *r)
+{
+    if (list->atlas_update.pixels) free_glyph_atlas_update(&list->atlas_update);
+    glViewport(0, 0, list->width, list->height);
+    glClear(GL_COLOR_BUFFER_BIT);
+    render_list_draw(list, r);
+    renderer_end_frame(r);
+}
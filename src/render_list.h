@@ -0,0 +1,62 @@
+#ifndef RENDER_LIST_H_
+#define RENDER_LIST_H_
+
+#include <stddef.h>
+
+#include "renderer.h"
+#include "glyph.h"
+
+// Command list of one frame. A renderer with Renderer.record set appends every batch it
+// would draw to the list together with the state the batch depends on, render_list_submit
+// draws them later with a renderer that owns the OpenGL context (see render_thread.h).
+// The arrays grow to the largest frame seen and are kept by render_list_reset, so a warm
+// list records frames without allocating.
+
+typedef struct {
+    Shader shader;  // Renderer.current_shader, the program follows from Renderer.uber
+    GLuint texture;
+    double time;
+    V2f resolution;
+    size_t vertices_begin;
+    size_t vertices_count;
+    size_t materials_begin;
+    size_t materials_count;
+} Render_Batch;
+
+struct Render_List {
+    // Viewport of the frame, cleared before the first batch
+    int width;
+    int height;
+    double input_time;   // When the input the frame was built from was sampled
+    double present_time; // When the swap of the frame returned, 0 until it was presented
+
+    Vertex *vertices;
+    size_t vertices_count;
+    size_t vertices_capacity;
+    Material *materials;
+    size_t materials_count;
+    size_t materials_capacity;
+    Render_Batch *batches;
+    size_t batches_count;
+    size_t batches_capacity;
+
+    // Rebuilt glyph atlas whose pixels replace its texture before the batches are drawn,
+    // owned by the list. pixels is NULL while the atlas did not change.
+    Free_Glyph_Atlas atlas_update;
+};
+
+void render_list_destroy(Render_List *list);
+// Starts recording a new frame into the list
+void render_list_reset(Render_List *list, int width, int height);
+// The frame is the first one drawn with atlas, render_list_submit uploads a copy of it
+void render_list_update_atlas(Render_List *list, const Free_Glyph_Atlas *atlas);
+// Appends the pending batch of r, called by renderer_flush of a recording renderer
+void render_list_push(Render_List *list, const Renderer *r);
+// Draws the batch at index with r
+void render_list_draw_batch(const Render_List *list, size_t index, Renderer *r);
+// Draws the batches with r
+void render_list_draw(const Render_List *list, Renderer *r);
+// Updates the atlas, clears the viewport and draws the batches with r, then ends the frame of r
+void render_list_submit(const Render_List *list, Renderer *r);
+
+#endif  // RENDER_LIST_H_
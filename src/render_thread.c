@@ -0,0 +1,105 @@
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <GL/glew.h>
+#define GLFW_INCLUDE_NONE
+#include <GLFW/glfw3.h>
+
+#include "render_thread.h"
+#include "trace.h"
+
+static void *render_thread_main(void *arg)
+{
+    Render_Thread *rt = arg;
+    glfwMakeContextCurrent(rt->window);
+    for (;;) {
+        pthread_mutex_lock(&rt->mutex);
+        while (rt->states[rt->render_index] != RENDER_LIST_QUEUED && !rt->quit) {
+            pthread_cond_wait(&rt->cond, &rt->mutex);
+        }
+        // Quitting only once the queued frames are on the screen
+        if (rt->states[rt->render_index] != RENDER_LIST_QUEUED) {
+            pthread_mutex_unlock(&rt->mutex);
+            break;
+        }
+        size_t index = rt->render_index;
+        rt->states[index] = RENDER_LIST_RENDERING;
+        pthread_mutex_unlock(&rt->mutex);
+
+        Render_List *list = &rt->lists[index];
+        TRACE_BEGIN("submit");
+        render_list_submit(list, rt->renderer);
+        TRACE_END("submit");
+        TRACE_BEGIN("swap");
+        glfwSwapBuffers(rt->window);
+        TRACE_END("swap");
+        list->present_time = glfwGetTime();
+
+        pthread_mutex_lock(&rt->mutex);
+        rt->states[index] = RENDER_LIST_FREE;
+        rt->render_index = (index + 1) % RENDER_THREAD_LISTS;
+        pthread_cond_broadcast(&rt->cond);
+        pthread_mutex_unlock(&rt->mutex);
+    }
+    glfwMakeContextCurrent(NULL);
+    return NULL;
+}
+
+bool render_thread_start(Render_Thread *rt, GLFWwindow *window, Renderer *renderer)
+{
+    memset(rt, 0, sizeof(*rt));
+    rt->window = window;
+    rt->renderer = renderer;
+    pthread_mutex_init(&rt->mutex, NULL);
+    pthread_cond_init(&rt->cond, NULL);
+    if (pthread_create(&rt->thread, NULL, render_thread_main, rt) != 0) {
+        fprintf(stderr, "ERROR: Could not start the render thread\n");
+        pthread_cond_destroy(&rt->cond);
+        pthread_mutex_destroy(&rt->mutex);
+        return false;
+    }
+    rt->started = true;
+    return true;
+}
+
+void render_thread_stop(Render_Thread *rt)
+{
+    if (!rt->started) return;
+    pthread_mutex_lock(&rt->mutex);
+    rt->quit = true;
+    pthread_cond_broadcast(&rt->cond);
+    pthread_mutex_unlock(&rt->mutex);
+    pthread_join(rt->thread, NULL);
+    glfwMakeContextCurrent(rt->window);
+
+    pthread_cond_destroy(&rt->cond);
+    pthread_mutex_destroy(&rt->mutex);
+    for (size_t i = 0; i < RENDER_THREAD_LISTS; ++i) {
+        render_list_destroy(&rt->lists[i]);
+    }
+    rt->started = false;
+}
+
+Render_List *render_thread_acquire(Render_Thread *rt)
+{
+    size_t index = rt->record_index;
+    pthread_mutex_lock(&rt->mutex);
+    while (rt->states[index] != RENDER_LIST_FREE) {
+        pthread_cond_wait(&rt->cond, &rt->mutex);
+    }
+    pthread_mutex_unlock(&rt->mutex);
+    rt->record_index = (index + 1) % RENDER_THREAD_LISTS;
+    return &rt->lists[index];
+}
+
+void render_thread_submit(Render_Thread *rt, Render_List *list)
+{
+    size_t index = list - rt->lists;
+    assert(index < RENDER_THREAD_LISTS);
+    pthread_mutex_lock(&rt->mutex);
+    assert(rt->states[index] == RENDER_LIST_FREE);
+    rt->states[index] = RENDER_LIST_QUEUED;
+    pthread_cond_signal(&rt->cond);
+    pthread_mutex_unlock(&rt->mutex);
+}
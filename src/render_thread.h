@@ -0,0 +1,51 @@
+#ifndef RENDER_THREAD_H_
+#define RENDER_THREAD_H_
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "renderer.h"
+#include "render_list.h"
+
+// Pipelined rendering for the windowed app. The render thread owns the OpenGL context and
+// submits and swaps frame N while the main thread polls input, simulates and records frame
+// N+1 into the other of two Render_Lists. A list goes back to the main thread once its
+// frame was swapped, so at most one frame is queued behind the one on the render thread.
+
+#define RENDER_THREAD_LISTS 2
+
+typedef struct GLFWwindow GLFWwindow;
+
+typedef enum {
+    RENDER_LIST_FREE = 0, // Owned by the main thread
+    RENDER_LIST_QUEUED,
+    RENDER_LIST_RENDERING,
+} Render_List_State;
+
+typedef struct {
+    GLFWwindow *window;
+    Renderer *renderer; // Initialized with the context, only used by the render thread
+    Render_List lists[RENDER_THREAD_LISTS];
+    Render_List_State states[RENDER_THREAD_LISTS];
+    size_t record_index; // Next list the main thread records into
+    size_t render_index; // Next list the render thread submits, lists are submitted in order
+
+    pthread_t thread;
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    bool started;
+    bool quit;
+} Render_Thread;
+
+// The context of window has to be released by the calling thread before
+bool render_thread_start(Render_Thread *rt, GLFWwindow *window, Renderer *renderer);
+// Submits the queued lists, joins the thread and makes the context current on the calling
+// thread again
+void render_thread_stop(Render_Thread *rt);
+// Blocks until the render thread is done with the next list. The list still holds the
+// input and present time of the frame it carried before, until render_list_reset.
+Render_List *render_thread_acquire(Render_Thread *rt);
+void render_thread_submit(Render_Thread *rt, Render_List *list);
+
+#endif  // RENDER_THREAD_H_
@@ -7,14 +7,33 @@
 #include <stdbool.h>
 
 #include "common.h"
+#include "gpu_memory.h"
+#include "profiler.h"
+#include "render_list.h"
+#include "softrast.h"
 
 #define vert_shader_file_path "./shaders/simple.vert"
 
-static_assert(COUNT_SHADERS == 3, "The amount of fragment shaders has changed");
+#define PI 3.14159265358979323846f
+
+static_assert(COUNT_RENDERER_STATS == 8, "Update the names of the renderer stats accordingly");
+static const char *renderer_stat_names[COUNT_RENDERER_STATS] = {
+    [RENDERER_STAT_FLUSHES]         = "flushes",
+    [RENDERER_STAT_DRAW_CALLS]      = "draw_calls",
+    [RENDERER_STAT_VERTICES]        = "vertices",
+    [RENDERER_STAT_BYTES_UPLOADED]  = "bytes_uploaded",
+    [RENDERER_STAT_SHADER_SWITCHES] = "shader_switches",
+    [RENDERER_STAT_TEXTURE_BINDS]   = "texture_binds",
+    [RENDERER_STAT_PEAK_BATCH_FILL] = "peak_batch_fill",
+    [RENDERER_STAT_FORCED_FLUSHES]  = "forced_flushes",
+};
+
+static_assert(COUNT_SHADERS == 4, "The amount of fragment shaders has changed");
 const char *frag_shader_file_paths[COUNT_SHADERS] = {
     [SHADER_COLOR] = "./shaders/color.frag",
     [SHADER_TEXT] = "./shaders/text.frag",
     [SHADER_RAINBOW] = "./shaders/rainbow.frag",
+    [SHADER_UBER] = "./shaders/uber.frag",
 };
 
 static Errno read_entire_file(const char *file_path, char **buffer, size_t *buffer_size)
@@ -105,25 +124,179 @@ static bool link_program(GLuint program)
 typedef struct {
     Uniform uniform;
     const char *name;
+    GLenum type;
 } Uniform_Def;
 
-static_assert(COUNT_UNIFORMS == 2, "Update definition table for uniforms accordingly");
+static_assert(COUNT_UNIFORMS == 4, "Update definition table for uniforms accordingly");
 static const Uniform_Def uniform_defs[COUNT_UNIFORMS] = {
     [UNIFORM_TIME] = {
         .uniform = UNIFORM_TIME,
         .name = "time",
+        .type = GL_FLOAT,
     },
     [UNIFORM_RESOLUTION] = {
         .uniform = UNIFORM_RESOLUTION,
         .name = "resolution",
+        .type = GL_FLOAT_VEC2,
+    },
+    [UNIFORM_CELLS] = {
+        .uniform = UNIFORM_CELLS,
+        .name = "cells",
+        .type = GL_FLOAT_VEC2,
+    },
+    [UNIFORM_IMAGE] = {
+        .uniform = UNIFORM_IMAGE,
+        .name = "image",
+        .type = GL_SAMPLER_2D,
+    },
+};
+
+typedef enum {
+    VERTEX_ATTRIB_POSITION = 0,
+    VERTEX_ATTRIB_COLOR,
+    VERTEX_ATTRIB_UV,
+    VERTEX_ATTRIB_MODE,
+    VERTEX_ATTRIB_MATERIAL,
+    COUNT_VERTEX_ATTRIBS,
+} Vertex_Attrib;
+
+typedef struct {
+    const char *name;
+    GLint size;
+    GLenum component_type;
+    GLenum glsl_type;
+    size_t offset;
+} Vertex_Attrib_Def;
+
+// The index into this table is the location of the attribute in the vertex shader
+static_assert(COUNT_VERTEX_ATTRIBS == 5, "Update definition table for vertex attributes accordingly");
+static const Vertex_Attrib_Def vertex_attrib_defs[COUNT_VERTEX_ATTRIBS] = {
+    [VERTEX_ATTRIB_POSITION] = {
+        .name = "position",
+        .size = 2,
+        .component_type = GL_FLOAT,
+        .glsl_type = GL_FLOAT_VEC2,
+        .offset = offsetof(Vertex, position),
+    },
+    [VERTEX_ATTRIB_COLOR] = {
+        .name = "color",
+        .size = 4,
+        .component_type = GL_FLOAT,
+        .glsl_type = GL_FLOAT_VEC4,
+        .offset = offsetof(Vertex, color),
+    },
+    [VERTEX_ATTRIB_UV] = {
+        .name = "uv",
+        .size = 2,
+        .component_type = GL_FLOAT,
+        .glsl_type = GL_FLOAT_VEC2,
+        .offset = offsetof(Vertex, uv),
+    },
+    [VERTEX_ATTRIB_MODE] = {
+        .name = "mode",
+        .size = 1,
+        .component_type = GL_UNSIGNED_INT,
+        .glsl_type = GL_UNSIGNED_INT,
+        .offset = offsetof(Vertex, mode),
+    },
+    [VERTEX_ATTRIB_MATERIAL] = {
+        .name = "material",
+        .size = 1,
+        .component_type = GL_UNSIGNED_INT,
+        .glsl_type = GL_UNSIGNED_INT,
+        .offset = offsetof(Vertex, material),
     },
 };
 
-static void get_uniform_locations(GLuint program, Uniform locations[COUNT_UNIFORMS])
+static void bind_vertex_attrib_locations(GLuint program)
+{
+    for (Vertex_Attrib a = 0; a < COUNT_VERTEX_ATTRIBS; ++a) {
+        glBindAttribLocation(program, a, vertex_attrib_defs[a].name);
+    }
+}
+
+// Checks the active attributes of a linked program against the Vertex layout
+static bool reflect_vertex_attribs(GLuint program, const char *program_name)
+{
+    bool ok = true;
+    GLint count = 0;
+    glGetProgramiv(program, GL_ACTIVE_ATTRIBUTES, &count);
+    for (GLint i = 0; i < count; ++i) {
+        GLchar name[256];
+        GLint size = 0;
+        GLenum type = 0;
+        glGetActiveAttrib(program, i, sizeof(name), NULL, &size, &type, name);
+        if (strncmp(name, "gl_", 3) == 0) continue;
+
+        GLint location = glGetAttribLocation(program, name);
+        if (location < 0 || location >= COUNT_VERTEX_ATTRIBS || strcmp(vertex_attrib_defs[location].name, name) != 0) {
+            fprintf(stderr, "ERROR: %s: attribute %s is not part of the Vertex layout\n", program_name, name);
+            ok = false;
+        } else if (vertex_attrib_defs[location].glsl_type != type) {
+            fprintf(stderr, "ERROR: %s: attribute %s has a type that does not match the Vertex layout\n", program_name, name);
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+// Builds the uniform location table of a linked program from its active uniforms.
+// Uniforms the program does not have keep the location -1 and are never uploaded.
+static bool reflect_uniforms(GLuint program, const char *program_name, GLint locations[COUNT_UNIFORMS])
 {
     for (Uniform u = 0; u < COUNT_UNIFORMS; ++u) {
-        locations[u] = glGetUniformLocation(program, uniform_defs[u].name);
+        locations[u] = -1;
+    }
+
+    bool ok = true;
+    GLint count = 0;
+    glGetProgramiv(program, GL_ACTIVE_UNIFORMS, &count);
+    for (GLint i = 0; i < count; ++i) {
+        GLuint index = i;
+        GLint block = -1;
+        glGetActiveUniformsiv(program, 1, &index, GL_UNIFORM_BLOCK_INDEX, &block);
+        // Members of uniform blocks (Materials) are bound through their buffer
+        if (block >= 0) continue;
+
+        GLchar name[256];
+        GLsizei name_size = 0;
+        GLint size = 0;
+        GLenum type = 0;
+        glGetActiveUniform(program, i, sizeof(name), &name_size, &size, &type, name);
+        // Arrays are reported as `name[0]`
+        char *bracket = strchr(name, '[');
+        if (bracket) *bracket = '\0';
+
+        Uniform u = 0;
+        while (u < COUNT_UNIFORMS && strcmp(uniform_defs[u].name, name) != 0) ++u;
+        if (u >= COUNT_UNIFORMS) {
+            fprintf(stderr, "ERROR: %s: uniform %s has no definition in uniform_defs\n", program_name, name);
+            ok = false;
+        } else if (uniform_defs[u].type != type) {
+            fprintf(stderr, "ERROR: %s: uniform %s has a type that does not match its definition\n", program_name, name);
+            ok = false;
+        } else {
+            locations[u] = glGetUniformLocation(program, uniform_defs[u].name);
+        }
+    }
+    return ok;
+}
+
+static void renderer_init_state(Renderer *r)
+{
+    r->materials[0] = renderer_default_material();
+    r->materials_count = 1;
+    r->current_material = 0;
+    r->rainbow_cells_time = NAN;
+    // No program yet, so the first renderer_set_shader counts as a switch
+    r->current_program = COUNT_SHADERS;
+    r->bound_program = COUNT_SHADERS;
+    for (Shader i = 0; i < COUNT_SHADERS; ++i) {
+        r->uniforms_time[i] = NAN;
+        r->uniforms_resolution[i] = v2f(NAN, NAN);
     }
+    r->transforms[0] = m3f_identity();
+    r->transforms_count = 1;
 }
 
 void renderer_init(Renderer *r)
@@ -135,33 +308,25 @@ void renderer_init(Renderer *r)
         glGenBuffers(1, &r->vbo);
         glBindBuffer(GL_ARRAY_BUFFER, r->vbo);
         glBufferData(GL_ARRAY_BUFFER, sizeof(r->vertices), r->vertices, GL_DYNAMIC_DRAW);
+        gpu_memory_track_buffer(r->vbo, "vertex buffer", sizeof(r->vertices));
+
+        for (Vertex_Attrib a = 0; a < COUNT_VERTEX_ATTRIBS; ++a) {
+            const Vertex_Attrib_Def *def = &vertex_attrib_defs[a];
+            glEnableVertexAttribArray(a);
+            if (def->component_type == GL_FLOAT) {
+                glVertexAttribPointer(a, def->size, def->component_type, GL_FALSE, sizeof(Vertex), (GLvoid *) def->offset);
+            } else {
+                glVertexAttribIPointer(a, def->size, def->component_type, sizeof(Vertex), (GLvoid *) def->offset);
+            }
+        }
+    }
 
-        // Position
-        glEnableVertexAttribArray(0);
-        glVertexAttribPointer(0,
-                              2,
-                              GL_FLOAT,
-                              GL_FALSE,
-                              sizeof(Vertex),
-                              (GLvoid *) offsetof(Vertex, position));
-
-        // Color
-        glEnableVertexAttribArray(1);
-        glVertexAttribPointer(1,
-                              4,
-                              GL_FLOAT,
-                              GL_FALSE,
-                              sizeof(Vertex),
-                              (GLvoid *) offsetof(Vertex, color));
-
-        // UV
-        glEnableVertexAttribArray(2);
-        glVertexAttribPointer(2,
-                              2,
-                              GL_FLOAT,
-                              GL_FALSE,
-                              sizeof(Vertex),
-                              (GLvoid *) offsetof(Vertex, uv));
+    {
+        glGenBuffers(1, &r->materials_ubo);
+        glBindBuffer(GL_UNIFORM_BUFFER, r->materials_ubo);
+        glBufferData(GL_UNIFORM_BUFFER, sizeof(r->materials), NULL, GL_DYNAMIC_DRAW);
+        gpu_memory_track_buffer(r->materials_ubo, "materials", sizeof(r->materials));
+        glBindBufferBase(GL_UNIFORM_BUFFER, MATERIALS_BINDING, r->materials_ubo);
     }
 
     // GLuint vertex_shader = glCreateShader(GL_VERTEX_SHADER);
@@ -189,30 +354,211 @@ void renderer_init(Renderer *r)
         if (!compile_shader_file(&shaders[1], GL_FRAGMENT_SHADER, frag_shader_file_paths[i])) exit(1);
         r->programs[i] = glCreateProgram();
         attach_shaders_to_program(shaders, sizeof(shaders) / sizeof(shaders[0]), r->programs[i]);
+        bind_vertex_attrib_locations(r->programs[i]);
         if (!link_program(r->programs[i])) exit(1);
+        if (!reflect_vertex_attribs(r->programs[i], frag_shader_file_paths[i])) exit(1);
+        if (!reflect_uniforms(r->programs[i], frag_shader_file_paths[i], r->uniforms[i])) exit(1);
+        if (r->uniforms[i][UNIFORM_IMAGE] >= 0) {
+            glUseProgram(r->programs[i]);
+            glUniform1i(r->uniforms[i][UNIFORM_IMAGE], 0);
+        }
+        GLuint materials_block = glGetUniformBlockIndex(r->programs[i], "Materials");
+        if (materials_block != GL_INVALID_INDEX) {
+            glUniformBlockBinding(r->programs[i], materials_block, MATERIALS_BINDING);
+        }
         glDetachShader(r->programs[i], shaders[1]);
         glDetachShader(r->programs[i], shaders[0]);
         glDeleteShader(shaders[1]);
     }
     glDeleteShader(shaders[0]);
+
+    for (Uniform u = 0; u < COUNT_UNIFORMS; ++u) {
+        bool used = false;
+        for (Shader i = 0; i < COUNT_SHADERS && !used; ++i) {
+            used = r->uniforms[i][u] >= 0;
+        }
+        if (!used) {
+            fprintf(stderr, "WARNING: uniform %s is not used by any shader\n", uniform_defs[u].name);
+        }
+    }
+
+    renderer_init_state(r);
+}
+
+void renderer_init_software(Renderer *r, Softrast *softrast)
+{
+    r->softrast = softrast;
+    renderer_init_state(r);
+}
+
+void renderer_init_recording(Renderer *r, Render_List *list)
+{
+    r->record = list;
+    renderer_init_state(r);
+}
+
+// Same pseudo random number generator as the one the rainbow shader used to run per pixel
+static float rainbow_hash(float n)
+{
+    float x = sinf(n)*43758.5453123f;
+    return x - floorf(x);
 }
 
+static void renderer_update_rainbow_cells(Renderer *r)
+{
+    if (r->rainbow_cells_time == r->time) return;
+    r->rainbow_cells_time = r->time;
+
+    float time = (float) r->time;
+    V2f center = v2f(sinf(time), cosf(time*0.5f));
+    float spin = sinf(time*PI*0.00001f);
+    for (size_t i = 0; i < RAINBOW_CELLS_COUNT; ++i) {
+        float an = spin - rainbow_hash((float) i)*PI*2.0f;
+        float ra = sqrtf(rainbow_hash(an))*0.5f;
+        r->rainbow_cells[i] = v2f(center.x + cosf(an)*ra, center.y + sinf(an)*ra);
+    }
+}
+
+// In uber mode switching between the color, text and rainbow shaders only changes the mode
+// that is written into the following vertices, no OpenGL call is made. Otherwise the
+// pending vertices are flushed with the previous program first.
 void renderer_set_shader(Renderer *r, Shader shader)
 {
+    assert(shader != SHADER_UBER);
+    Shader program = r->uber ? SHADER_UBER : shader;
+    if (r->vertices_count > 0 && program != r->current_program) renderer_flush(r);
+    if (program != r->current_program) r->stats.values[RENDERER_STAT_SHADER_SWITCHES] += 1;
+
     r->current_shader = shader;
-    glUseProgram(r->programs[r->current_shader]);
-    get_uniform_locations(r->programs[r->current_shader], r->uniforms);
-    glUniform2f(r->uniforms[UNIFORM_RESOLUTION], V2f_Arg(r->resolution));
-    glUniform1f(r->uniforms[UNIFORM_TIME], (float)r->time);
+    r->current_program = program;
+    // The software rasterizer and the render list read the uniforms from the renderer when
+    // they draw
+    if (r->softrast || r->record) return;
+    if (program != r->bound_program) {
+        glUseProgram(r->programs[program]);
+        r->bound_program = program;
+    }
+
+    const GLint *locations = r->uniforms[program];
+    V2f *resolution = &r->uniforms_resolution[program];
+    if (resolution->x != r->resolution.x || resolution->y != r->resolution.y) {
+        *resolution = r->resolution;
+        if (locations[UNIFORM_RESOLUTION] >= 0) {
+            glUniform2f(locations[UNIFORM_RESOLUTION], V2f_Arg(r->resolution));
+        }
+    }
+    if (r->uniforms_time[program] != r->time) {
+        r->uniforms_time[program] = r->time;
+        if (locations[UNIFORM_TIME] >= 0) {
+            glUniform1f(locations[UNIFORM_TIME], (float)r->time);
+        }
+        if (locations[UNIFORM_CELLS] >= 0) {
+            renderer_update_rainbow_cells(r);
+            glUniform2fv(locations[UNIFORM_CELLS], RAINBOW_CELLS_COUNT, (const GLfloat *) r->rainbow_cells);
+        }
+    }
+}
+
+void renderer_set_texture(Renderer *r, GLuint texture)
+{
+    if (texture == r->current_texture) return;
+    renderer_flush(r);
+    r->current_texture = texture;
+    r->stats.values[RENDERER_STAT_TEXTURE_BINDS] += 1;
+    if (r->softrast || r->record) return;
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, texture);
+}
+
+Material renderer_default_material(void)
+{
+    return (Material) {
+        .tint = v4f(1, 1, 1, 1),
+        .params = v4f(0, 0, 0, 0),
+    };
+}
+
+// The batch ran out of space before the content asked for a flush
+static void renderer_flush_forced(Renderer *r)
+{
+    if (r->vertices_count > 0) r->stats.values[RENDERER_STAT_FORCED_FLUSHES] += 1;
+    renderer_flush(r);
+}
+
+// Materials are appended to the block of the current batch, so differently parameterized
+// draws of the same program still end up in a single draw call
+void renderer_set_material(Renderer *r, Material material)
+{
+    Material *current = &r->materials[r->current_material];
+    if (memcmp(current, &material, sizeof(material)) == 0) return;
+
+    if (r->materials_count >= MATERIALS_CAP) renderer_flush_forced(r);
+    // Flushing an empty batch does not reset the materials
+    if (r->materials_count >= MATERIALS_CAP) r->materials_count = 0;
+
+    r->materials[r->materials_count] = material;
+    r->current_material = r->materials_count;
+    r->materials_count += 1;
+}
+
+void renderer_set_scissor(Renderer *r, int x, int y, int w, int h)
+{
+    assert(!r->record);
+    renderer_flush(r);
+    if (r->softrast) {
+        softrast_set_clip(r->softrast, x, y, x + w, y + h);
+        return;
+    }
+    glEnable(GL_SCISSOR_TEST);
+    glScissor(x, y, w, h);
+}
+
+void renderer_reset_scissor(Renderer *r)
+{
+    assert(!r->record);
+    renderer_flush(r);
+    if (r->softrast) {
+        softrast_set_clip(r->softrast, 0, 0, r->softrast->width, r->softrast->height);
+        return;
+    }
+    glDisable(GL_SCISSOR_TEST);
+}
+
+void renderer_clear(Renderer *r, V4f color)
+{
+    assert(!r->record);
+    renderer_flush(r);
+    if (r->softrast) {
+        softrast_clear(r->softrast, color);
+        return;
+    }
+    glClearColor(V4f_Arg(color));
+    glClear(GL_COLOR_BUFFER_BIT);
+}
+
+void renderer_push_transform(Renderer *r, M3f m)
+{
+    assert(r->transforms_count < TRANSFORMS_CAP);
+    r->transforms[r->transforms_count] = m3f_mul(r->transforms[r->transforms_count - 1], m);
+    r->transforms_count += 1;
+}
+
+void renderer_pop_transform(Renderer *r)
+{
+    assert(r->transforms_count > 1);
+    r->transforms_count -= 1;
 }
 
 static void renderer_vertex(Renderer *r, V2f p, V4f c, V2f uv)
 {
     assert(r->vertices_count < VERTICES_CAP);
     Vertex *last = &r->vertices[r->vertices_count];
+    if (r->transforms_count > 1) p = m3f_transform_point(r->transforms[r->transforms_count - 1], p);
     last->position = p;
     last->color    = c;
     last->uv       = uv;
+    last->mode     = r->current_shader;
+    last->material = r->current_material;
     r->vertices_count += 1;
 }
 
@@ -221,6 +567,7 @@ void renderer_triangle(Renderer *r,
                        V4f c0, V4f c1, V4f c2,
                        V2f uv0, V2f uv1, V2f uv2)
 {
+    if (r->vertices_count + 3 > VERTICES_CAP) renderer_flush_forced(r);
     renderer_vertex(r, p0, c0, uv0);
     renderer_vertex(r, p1, c1, uv1);
     renderer_vertex(r, p2, c2, uv2);
@@ -278,22 +625,123 @@ void renderer_image_rect(Renderer *r, V2f p0, V4f c0, V2f size, V2f uvp, V2f uvs
                   uvp, v2f_sum(uvp, v2f(uvs.x, 0)), v2f_sum(uvp, v2f(0, uvs.y)), v2f_sum(uvp, uvs));
 }
 
-static void renderer_sync(Renderer *r)
+Vertex *renderer_reserve(Renderer *r, size_t count)
+{
+    assert(count <= VERTICES_CAP);
+    if (r->vertices_count + count > VERTICES_CAP) renderer_flush_forced(r);
+    Vertex *vertices = &r->vertices[r->vertices_count];
+    r->vertices_count += count;
+    return vertices;
+}
+
+static void renderer_upload(Renderer *r, const Vertex *vertices, size_t vertices_count, const Material *materials, size_t materials_count)
 {
     glBufferSubData(GL_ARRAY_BUFFER,
                     0,
-                    sizeof(Vertex) * r->vertices_count,
-                    r->vertices);
+                    sizeof(Vertex) * vertices_count,
+                    vertices);
+    glBindBuffer(GL_UNIFORM_BUFFER, r->materials_ubo);
+    glBufferSubData(GL_UNIFORM_BUFFER,
+                    0,
+                    sizeof(Material) * materials_count,
+                    materials);
+    r->stats.values[RENDERER_STAT_BYTES_UPLOADED] += sizeof(Vertex) * vertices_count + sizeof(Material) * materials_count;
+}
+
+static void renderer_sync(Renderer *r)
+{
+    if (r->softrast || r->record) return;
+    renderer_upload(r, r->vertices, r->vertices_count, r->materials, r->materials_count);
 }
 
 static void renderer_draw(Renderer *r)
 {
-    glDrawArrays(GL_TRIANGLES, 0, r->vertices_count);
+    if (r->record) {
+        render_list_push(r->record, r);
+    } else if (r->softrast) {
+        renderer_update_rainbow_cells(r);
+        softrast_draw(r->softrast, r);
+    } else {
+        glDrawArrays(GL_TRIANGLES, 0, r->vertices_count);
+    }
+    r->stats.values[RENDERER_STAT_DRAW_CALLS] += 1;
+    r->stats.values[RENDERER_STAT_VERTICES] += r->vertices_count;
 }
 
 void renderer_flush(Renderer *r)
 {
+    if (r->vertices_count == 0) return;
+    r->stats.values[RENDERER_STAT_FLUSHES] += 1;
+    if (r->vertices_count > r->stats.values[RENDERER_STAT_PEAK_BATCH_FILL]) {
+        r->stats.values[RENDERER_STAT_PEAK_BATCH_FILL] = r->vertices_count;
+    }
+    PROFILER_BEGIN(PROFILER_SCOPE_FLUSH);
+    PROFILER_GPU_BEGIN();
     renderer_sync(r);
     renderer_draw(r);
+    PROFILER_GPU_END();
+    PROFILER_END(PROFILER_SCOPE_FLUSH);
     r->vertices_count = 0;
+
+    // Only the current material carries over to the next batch
+    r->materials[0] = r->materials[r->current_material];
+    r->materials_count = 1;
+    r->current_material = 0;
+}
+
+void renderer_draw_batch(Renderer *r, const Vertex *vertices, size_t vertices_count, const Material *materials, size_t materials_count)
+{
+    assert(!r->record && r->vertices_count == 0);
+    assert(vertices_count <= VERTICES_CAP && materials_count <= MATERIALS_CAP);
+    if (vertices_count == 0) return;
+    r->stats.values[RENDERER_STAT_FLUSHES] += 1;
+    if (vertices_count > r->stats.values[RENDERER_STAT_PEAK_BATCH_FILL]) {
+        r->stats.values[RENDERER_STAT_PEAK_BATCH_FILL] = vertices_count;
+    }
+    if (r->softrast) {
+        // The software rasterizer draws the batch of the renderer
+        memcpy(r->vertices, vertices, sizeof(Vertex)*vertices_count);
+        memcpy(r->materials, materials, sizeof(Material)*materials_count);
+        r->vertices_count = vertices_count;
+        renderer_draw(r);
+        r->vertices_count = 0;
+        r->materials[0] = renderer_default_material();
+        r->materials_count = 1;
+        r->current_material = 0;
+        return;
+    }
+    renderer_upload(r, vertices, vertices_count, materials, materials_count);
+    glDrawArrays(GL_TRIANGLES, 0, vertices_count);
+    r->stats.values[RENDERER_STAT_DRAW_CALLS] += 1;
+    r->stats.values[RENDERER_STAT_VERTICES] += vertices_count;
+}
+
+void renderer_end_frame(Renderer *r)
+{
+    for (Renderer_Stat s = 0; s < COUNT_RENDERER_STATS; ++s) {
+        size_t value = r->stats.values[s];
+        if (s == RENDERER_STAT_PEAK_BATCH_FILL) {
+            if (value > r->total.values[s]) r->total.values[s] = value;
+        } else {
+            r->total.values[s] += value;
+        }
+    }
+    r->last_frame = r->stats;
+    memset(&r->stats, 0, sizeof(r->stats));
+    r->frames += 1;
+}
+
+const char *renderer_stat_name(Renderer_Stat stat)
+{
+    return renderer_stat_names[stat];
+}
+
+void renderer_print_stats(const Renderer *r, FILE *stream)
+{
+    fprintf(stream, "%-16s %12s %12s\n", "stat", "total", "per frame");
+    for (Renderer_Stat s = 0; s < COUNT_RENDERER_STATS; ++s) {
+        size_t total = r->total.values[s];
+        double per_frame = s == RENDERER_STAT_PEAK_BATCH_FILL || r->frames == 0 ? (double) total : (double) total / r->frames;
+        fprintf(stream, "%-16s %12zu %12.1f\n", renderer_stat_name(s), total, per_frame);
+    }
 }
@@ -4,44 +4,124 @@
 #define LA_IMPLEMENTATION
 #include "la.h"
 
-#include <GL/glew.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include "gl.h"
 
 typedef struct {
     V2f position;
     V4f color;
     V2f uv;
+    GLuint mode; // Shader the vertex is shaded with when the uber shader is used
+    GLuint material; // Index into Renderer.materials
 } Vertex;
 
+// Per draw parameters that do not require a flush to change. Has to match the std140
+// layout of the Materials block in shaders/simple.vert.
+typedef struct {
+    V4f tint;   // Multiplied with the final color of every shader
+    V4f params; // Shader specific, all zeros means default (see the fragment shaders)
+} Material;
+
+#define MATERIALS_CAP 256
+#define MATERIALS_BINDING 0
+
 typedef enum {
     SHADER_COLOR = 0,
     SHADER_TEXT,
     SHADER_RAINBOW,
+    // Combines all of the shaders above and branches on Vertex.mode, so mixed content
+    // can be drawn in one batch
+    SHADER_UBER,
     COUNT_SHADERS,
 } Shader;
 
 typedef enum {
     UNIFORM_TIME = 0,
     UNIFORM_RESOLUTION,
+    UNIFORM_CELLS,
+    UNIFORM_IMAGE,
     COUNT_UNIFORMS,
 } Uniform;
 
+typedef enum {
+    RENDERER_STAT_FLUSHES = 0,      // renderer_flush calls that had vertices to draw
+    RENDERER_STAT_DRAW_CALLS,
+    RENDERER_STAT_VERTICES,
+    RENDERER_STAT_BYTES_UPLOADED,   // Vertices and materials
+    RENDERER_STAT_SHADER_SWITCHES,  // Changes of the bound program
+    RENDERER_STAT_TEXTURE_BINDS,
+    RENDERER_STAT_PEAK_BATCH_FILL,  // Most vertices in a single batch, maximum instead of sum in the totals
+    RENDERER_STAT_FORCED_FLUSHES,   // Flushes because the vertex buffer or the materials block was full
+    COUNT_RENDERER_STATS,
+} Renderer_Stat;
+
+typedef struct Renderer_Stats {
+    size_t values[COUNT_RENDERER_STATS];
+} Renderer_Stats;
+
 #define VERTICES_CAP (3*5*1024)
+// Has to match the size of the `cells` array in shaders/rainbow.frag
+#define RAINBOW_CELLS_COUNT 100
+#define TRANSFORMS_CAP 16
+
+// See softrast.h
+typedef struct Softrast Softrast;
+// See render_list.h
+typedef struct Render_List Render_List;
 
 typedef struct {
     GLuint vao;
     GLuint vbo;
+    GLuint materials_ubo;
     GLuint programs[COUNT_SHADERS];
     Shader current_shader;
+    Shader current_program; // COUNT_SHADERS until the first renderer_set_shader
+    Shader bound_program; // Of glUseProgram, COUNT_SHADERS until the first renderer_set_shader
+    GLuint current_texture;
+    bool uber;
+    // When set the batches are rasterized on the CPU and no OpenGL call is made
+    Softrast *softrast;
+    // When set the batches are appended to the list and no OpenGL call is made, another
+    // renderer draws them later with render_list_submit
+    Render_List *record;
 
     double time;
     V2f resolution;
 
-    Uniform uniforms[COUNT_UNIFORMS];
+    // Maps the screen space positions of the following vertices before they are batched,
+    // so shaders and the software rasterizer see the transformed positions. The bottom
+    // entry is the identity and skipped.
+    M3f transforms[TRANSFORMS_CAP];
+    size_t transforms_count;
+
+    // Locations of the uniforms in every program, -1 if the program does not use it
+    GLint uniforms[COUNT_SHADERS][COUNT_UNIFORMS];
+    // Cell centers of the rainbow shader only depend on time, so they are computed
+    // once per frame on the CPU instead of once per pixel on the GPU
+    V2f rainbow_cells[RAINBOW_CELLS_COUNT];
+    double rainbow_cells_time;
+    // Uniforms keep their values while another program is bound, every program only gets
+    // time, resolution and cells uploaded when they changed since its last use
+    double uniforms_time[COUNT_SHADERS];
+    V2f uniforms_resolution[COUNT_SHADERS];
     Vertex vertices[VERTICES_CAP];
     size_t vertices_count;
+
+    // Materials referenced by the vertices of the current batch
+    Material materials[MATERIALS_CAP];
+    size_t materials_count;
+    GLuint current_material;
+
+    Renderer_Stats stats;      // Current frame
+    Renderer_Stats last_frame; // Last finished frame
+    Renderer_Stats total;      // All finished frames
+    size_t frames;
 } Renderer;
 
 void renderer_init(Renderer *r); // TODO: Use arena allocator later
+void renderer_init_software(Renderer *r, Softrast *softrast);
+void renderer_init_recording(Renderer *r, Render_List *list);
 void renderer_triangle(Renderer *r,
                        V2f p0, V2f p1, V2f p2,
                        V4f c0, V4f c1, V4f c2,
@@ -55,7 +135,31 @@ void renderer_rect_gradient_center(Renderer *r, V2f p0, V4f c0, V4f c1, V4f c2,
 void renderer_rect(Renderer *r, V2f p0, V4f c0, V2f size);
 void renderer_rect_center(Renderer *r, V2f p0, V4f c0, V2f size);
 void renderer_image_rect(Renderer *r, V2f p0, V4f c0, V2f size, V2f uvp, V2f uvs);
+// Appends count (at most VERTICES_CAP) vertices to the batch, flushing first when they do
+// not fit, and returns them for the caller to fill in completely: the transforms are not
+// applied, mode and material are usually current_shader and current_material
+Vertex *renderer_reserve(Renderer *r, size_t count);
 void renderer_set_shader(Renderer *r, Shader shader);
+// Binds the texture the following vertices sample from, flushing if it changes
+void renderer_set_texture(Renderer *r, GLuint texture);
+Material renderer_default_material(void);
+void renderer_set_material(Renderer *r, Material material);
+// Limits drawing and renderer_clear to w*h pixels at (x, y), with the origin in the bottom
+// left like glScissor. Flushes, not part of the recorded render lists.
+void renderer_set_scissor(Renderer *r, int x, int y, int w, int h);
+void renderer_reset_scissor(Renderer *r);
+void renderer_clear(Renderer *r, V4f color);
+// Composes m with the current transform, m applies to the positions first
+void renderer_push_transform(Renderer *r, M3f m);
+void renderer_pop_transform(Renderer *r);
 void renderer_flush(Renderer *r);
+// Uploads and draws vertices that were batched by another renderer with the current shader
+// and texture. Unlike renderer_flush it does not report to the profiler, so it may run on
+// the render thread.
+void renderer_draw_batch(Renderer *r, const Vertex *vertices, size_t vertices_count, const Material *materials, size_t materials_count);
+// Moves the stats of the current frame into last_frame and total
+void renderer_end_frame(Renderer *r);
+const char *renderer_stat_name(Renderer_Stat stat);
+void renderer_print_stats(const Renderer *r, FILE *stream);
 
 #endif  // RENDERER_H_
@@ -0,0 +1,230 @@
+#define _POSIX_C_SOURCE 200809L
+#include <errno.h>
+#include <string.h>
+#include <time.h>
+
+#include "replay.h"
+
+#define REPLAY_MAGIC "RPLY"
+
+typedef enum {
+    REPLAY_TAG_FRAME = 1,
+    REPLAY_TAG_END   = 2,
+} Replay_Tag;
+
+static double replay_now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double) ts.tv_sec + (double) ts.tv_nsec * 1e-9;
+}
+
+static bool replay_write(Replay *rp, const void *data, size_t size)
+{
+    if (fwrite(data, size, 1, rp->file) != 1) {
+        fprintf(stderr, "ERROR: Could not write replay %s: %s\n", rp->file_path, strerror(errno));
+        rp->failed = true;
+        return false;
+    }
+    return true;
+}
+
+static bool replay_read(Replay *rp, void *data, size_t size)
+{
+    if (fread(data, size, 1, rp->file) != 1) {
+        fprintf(stderr, "ERROR: Replay %s is truncated\n", rp->file_path);
+        rp->failed = true;
+        return false;
+    }
+    return true;
+}
+
+bool replay_record(Replay *rp, const char *file_path)
+{
+    memset(rp, 0, sizeof(*rp));
+    rp->file_path = file_path;
+    rp->file = fopen(file_path, "wb");
+    if (!rp->file) {
+        fprintf(stderr, "ERROR: Could not open replay %s: %s\n", file_path, strerror(errno));
+        return false;
+    }
+    rp->mode = REPLAY_RECORD;
+
+    uint32_t version = REPLAY_VERSION;
+    if (!replay_write(rp, REPLAY_MAGIC, 4) || !replay_write(rp, &version, sizeof(version))) {
+        fclose(rp->file);
+        rp->file = NULL;
+        rp->mode = REPLAY_OFF;
+        return false;
+    }
+    return true;
+}
+
+bool replay_play(Replay *rp, const char *file_path)
+{
+    memset(rp, 0, sizeof(*rp));
+    rp->file_path = file_path;
+    rp->file = fopen(file_path, "rb");
+    if (!rp->file) {
+        fprintf(stderr, "ERROR: Could not open replay %s: %s\n", file_path, strerror(errno));
+        return false;
+    }
+    rp->mode = REPLAY_PLAY;
+
+    char magic[4];
+    uint32_t version = 0;
+    bool ok = replay_read(rp, magic, sizeof(magic)) && replay_read(rp, &version, sizeof(version));
+    if (ok && (memcmp(magic, REPLAY_MAGIC, 4) != 0 || version != REPLAY_VERSION)) {
+        fprintf(stderr, "ERROR: %s is not a version %d replay\n", file_path, REPLAY_VERSION);
+        ok = false;
+    }
+    if (!ok) {
+        fclose(rp->file);
+        rp->file = NULL;
+        rp->mode = REPLAY_OFF;
+    }
+    return ok;
+}
+
+void replay_key(Replay *rp, int key, int action, int mods)
+{
+    if (rp->mode != REPLAY_RECORD) return;
+    if (rp->pending.keys_count >= REPLAY_KEYS_CAP) {
+        fprintf(stderr, "WARNING: More than %d key events in one frame, dropping the rest\n", REPLAY_KEYS_CAP);
+        return;
+    }
+    rp->pending.keys[rp->pending.keys_count++] = (Replay_Key) {key, action, mods};
+}
+
+static bool replay_write_frame(Replay *rp, Replay_Frame *frame)
+{
+    uint8_t tag = REPLAY_TAG_FRAME;
+    uint16_t width = (uint16_t) frame->width;
+    uint16_t height = (uint16_t) frame->height;
+    uint16_t keys_count = (uint16_t) rp->pending.keys_count;
+    if (!replay_write(rp, &tag, sizeof(tag))) return false;
+    if (!replay_write(rp, &frame->time, sizeof(frame->time))) return false;
+    if (!replay_write(rp, &width, sizeof(width))) return false;
+    if (!replay_write(rp, &height, sizeof(height))) return false;
+    if (!replay_write(rp, &frame->scale, sizeof(frame->scale))) return false;
+    if (!replay_write(rp, &keys_count, sizeof(keys_count))) return false;
+    for (size_t i = 0; i < rp->pending.keys_count; ++i) {
+        const Replay_Key *k = &rp->pending.keys[i];
+        int16_t key = (int16_t) k->key;
+        uint8_t action = (uint8_t) k->action;
+        uint8_t mods = (uint8_t) k->mods;
+        if (!replay_write(rp, &key, sizeof(key))) return false;
+        if (!replay_write(rp, &action, sizeof(action))) return false;
+        if (!replay_write(rp, &mods, sizeof(mods))) return false;
+    }
+
+    memcpy(frame->keys, rp->pending.keys, sizeof(Replay_Key)*rp->pending.keys_count);
+    frame->keys_count = rp->pending.keys_count;
+    rp->pending.keys_count = 0;
+    return true;
+}
+
+static bool replay_read_frame(Replay *rp, Replay_Frame *frame)
+{
+    uint8_t tag = 0;
+    if (!replay_read(rp, &tag, sizeof(tag))) return false;
+    if (tag == REPLAY_TAG_END) {
+        rp->ended = true;
+        return false;
+    }
+    if (tag != REPLAY_TAG_FRAME) {
+        fprintf(stderr, "ERROR: Replay %s is corrupted at frame %zu\n", rp->file_path, rp->frames);
+        rp->failed = true;
+        return false;
+    }
+
+    uint16_t width, height, keys_count;
+    if (!replay_read(rp, &frame->time, sizeof(frame->time))) return false;
+    if (!replay_read(rp, &width, sizeof(width))) return false;
+    if (!replay_read(rp, &height, sizeof(height))) return false;
+    if (!replay_read(rp, &frame->scale, sizeof(frame->scale))) return false;
+    if (!replay_read(rp, &keys_count, sizeof(keys_count))) return false;
+    if (keys_count > REPLAY_KEYS_CAP) {
+        fprintf(stderr, "ERROR: Replay %s is corrupted at frame %zu\n", rp->file_path, rp->frames);
+        rp->failed = true;
+        return false;
+    }
+    frame->width = width;
+    frame->height = height;
+    frame->keys_count = keys_count;
+    for (size_t i = 0; i < keys_count; ++i) {
+        int16_t key;
+        uint8_t action, mods;
+        if (!replay_read(rp, &key, sizeof(key))) return false;
+        if (!replay_read(rp, &action, sizeof(action))) return false;
+        if (!replay_read(rp, &mods, sizeof(mods))) return false;
+        frame->keys[i] = (Replay_Key) {key, action, mods};
+    }
+    return true;
+}
+
+bool replay_frame(Replay *rp, Replay_Frame *frame)
+{
+    bool ok = true;
+    switch (rp->mode) {
+    case REPLAY_RECORD: ok = replay_write_frame(rp, frame); break;
+    case REPLAY_PLAY:   ok = replay_read_frame(rp, frame);  break;
+    case REPLAY_OFF:    frame->keys_count = 0;              break;
+    }
+    if (!ok) return false;
+
+    if (rp->frames == 0) {
+        rp->first_time = frame->time;
+        rp->start_secs = replay_now();
+    }
+    rp->frames += 1;
+    return true;
+}
+
+void replay_wait(Replay *rp, const Replay_Frame *frame, double speed)
+{
+    if (rp->mode != REPLAY_PLAY || speed <= 0.0) return;
+    double due = rp->start_secs + (frame->time - rp->first_time)/speed;
+    double secs = due - replay_now();
+    if (secs <= 0.0) return;
+    struct timespec ts = {
+        .tv_sec = (time_t) secs,
+        .tv_nsec = (long) ((secs - (double) (time_t) secs)*1e9),
+    };
+    nanosleep(&ts, NULL);
+}
+
+bool replay_finish(Replay *rp, uint64_t state_hash)
+{
+    if (rp->mode == REPLAY_OFF) return true;
+
+    // Errors of earlier reads and writes were already reported
+    bool ok = !rp->failed;
+    uint64_t hash = state_hash;
+    if (ok && rp->mode == REPLAY_RECORD) {
+        uint8_t tag = REPLAY_TAG_END;
+        uint64_t frames = rp->frames;
+        ok = replay_write(rp, &tag, sizeof(tag)) &&
+             replay_write(rp, &frames, sizeof(frames)) &&
+             replay_write(rp, &hash, sizeof(hash));
+        if (ok) printf("Recorded %zu frames to %s\n", rp->frames, rp->file_path);
+    } else if (ok && !rp->ended) {
+        printf("Stopped the replay of %s after %zu frames\n", rp->file_path, rp->frames);
+    } else if (ok) {
+        // replay_frame already consumed the tag of the trailer
+        uint64_t frames = 0;
+        uint64_t expected = 0;
+        ok = replay_read(rp, &frames, sizeof(frames)) && replay_read(rp, &expected, sizeof(expected));
+        if (ok && (frames != rp->frames || hash != expected)) {
+            fprintf(stderr, "ERROR: Replay %s diverged: %zu of %llu frames, state %016llx instead of %016llx\n",
+                    rp->file_path, rp->frames, (unsigned long long) frames,
+                    (unsigned long long) hash, (unsigned long long) expected);
+            ok = false;
+        }
+    }
+
+    if (fclose(rp->file) != 0) ok = false;
+    rp->file = NULL;
+    rp->mode = REPLAY_OFF;
+    return ok;
+}
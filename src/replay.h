@@ -0,0 +1,70 @@
+#ifndef REPLAY_H_
+#define REPLAY_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+// Deterministic input recording. While recording, every frame stores the time, the
+// framebuffer size and the content scale the frame was rendered with plus the key events
+// that arrived since the previous frame. Playing the file back feeds exactly the same values into the main loop,
+// so two runs render identical frames and their frame times can be compared.
+//
+// File format (native endianness, not meant to be portable between machines):
+//   "RPLY" u32 version
+//   per frame: u8 REPLAY_TAG_FRAME f64 time u16 width u16 height f32 scale u16 keys_count
+//              keys_count * (i16 key u8 action u8 mods), 19 bytes plus 4 per key event
+//   trailer:   u8 REPLAY_TAG_END u64 frames u64 state hash (app_hash)
+
+#define REPLAY_VERSION  3
+#define REPLAY_KEYS_CAP 64
+
+typedef enum {
+    REPLAY_OFF = 0,
+    REPLAY_RECORD,
+    REPLAY_PLAY,
+} Replay_Mode;
+
+typedef struct {
+    int key;
+    int action;
+    int mods;
+} Replay_Key;
+
+typedef struct {
+    double time;
+    int width;
+    int height;
+    float scale;
+    Replay_Key keys[REPLAY_KEYS_CAP];
+    size_t keys_count;
+} Replay_Frame;
+
+typedef struct {
+    Replay_Mode mode;
+    FILE *file;
+    const char *file_path;
+    size_t frames;
+    Replay_Frame pending; // Keys recorded since the last frame
+    bool ended;  // The trailer was reached while playing
+    bool failed; // An I/O error or corrupted file was reported
+    double first_time;
+    double start_secs; // Wall clock at the first played frame, for replay_wait
+} Replay;
+
+bool replay_record(Replay *rp, const char *file_path);
+bool replay_play(Replay *rp, const char *file_path);
+// Records a key event into the next frame, does nothing unless recording
+void replay_key(Replay *rp, int key, int action, int mods);
+// Called at the start of every frame. While recording frame holds the live values and is
+// written out together with the pending keys. While playing frame is overwritten with the
+// recorded values. Returns false once the recording is exhausted or on an I/O error.
+bool replay_frame(Replay *rp, Replay_Frame *frame);
+// Sleeps until the frame is due at the recorded pace times speed, speed <= 0 never sleeps
+void replay_wait(Replay *rp, const Replay_Frame *frame, double speed);
+// Closes the file. While recording the hash of the final state is stored in the trailer,
+// while playing it is compared against it. Returns false on mismatch or I/O error.
+bool replay_finish(Replay *rp, uint64_t state_hash);
+
+#endif  // REPLAY_H_
@@ -0,0 +1,632 @@
+#define _POSIX_C_SOURCE 200809L
+#include <errno.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+#include "softrast.h"
+
+static void *softrast_worker(void *arg);
+
+bool softrast_init(Softrast *sr, int width, int height, size_t threads)
+{
+    memset(sr, 0, sizeof(*sr));
+    sr->width = width;
+    sr->height = height;
+    softrast_set_clip(sr, 0, 0, width, height);
+    sr->pixels = calloc((size_t) width * height, 4);
+    sr->tiles_x = (width + SOFTRAST_TILE_SIZE - 1) / SOFTRAST_TILE_SIZE;
+    sr->tiles_y = (height + SOFTRAST_TILE_SIZE - 1) / SOFTRAST_TILE_SIZE;
+    sr->bins = calloc((size_t) sr->tiles_x * sr->tiles_y, sizeof(*sr->bins));
+    sr->triangles = malloc(sizeof(*sr->triangles) * (VERTICES_CAP/3));
+    if (threads == 0) {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        threads = cpus > 0 ? (size_t) cpus : 1;
+    }
+    sr->threads = malloc(sizeof(*sr->threads) * threads);
+    if (!sr->pixels || !sr->bins || !sr->triangles || !sr->threads) {
+        if (!sr->threads) {
+            fprintf(stderr, "ERROR: Could not allocate %zu software rasterizer threads\n", threads);
+        } else {
+            fprintf(stderr, "ERROR: Could not allocate software framebuffer of %dx%d\n", width, height);
+        }
+        free(sr->threads);
+        free(sr->triangles);
+        free(sr->bins);
+        free(sr->pixels);
+        memset(sr, 0, sizeof(*sr));
+        return false;
+    }
+
+    pthread_mutex_init(&sr->mutex, NULL);
+    pthread_cond_init(&sr->work_cond, NULL);
+    pthread_cond_init(&sr->done_cond, NULL);
+    for (size_t i = 0; i + 1 < threads; ++i) {
+        if (pthread_create(&sr->threads[i], NULL, softrast_worker, sr) != 0) {
+            fprintf(stderr, "WARNING: Could only start %zu software rasterizer threads\n", i + 1);
+            break;
+        }
+        sr->threads_count += 1;
+    }
+
+    return true;
+}
+
+void softrast_destroy(Softrast *sr)
+{
+    pthread_mutex_lock(&sr->mutex);
+    sr->quit = true;
+    pthread_cond_broadcast(&sr->work_cond);
+    pthread_mutex_unlock(&sr->mutex);
+    for (size_t i = 0; i < sr->threads_count; ++i) {
+        pthread_join(sr->threads[i], NULL);
+    }
+    pthread_cond_destroy(&sr->done_cond);
+    pthread_cond_destroy(&sr->work_cond);
+    pthread_mutex_destroy(&sr->mutex);
+
+    for (int i = 0; i < sr->tiles_x*sr->tiles_y; ++i) {
+        free(sr->bins[i].items);
+    }
+    free(sr->bins);
+    free(sr->threads);
+    free(sr->triangles);
+    free(sr->pixels);
+    memset(sr, 0, sizeof(*sr));
+}
+
+void softrast_clear(Softrast *sr, V4f color)
+{
+    Rgba8 rgba = rgba8_from_v4f(color);
+    for (int y = sr->clip_y0; y < sr->clip_y1; ++y) {
+        unsigned char *row = sr->pixels + (size_t) y*sr->width*4;
+        for (int x = sr->clip_x0; x < sr->clip_x1; ++x) {
+            memcpy(row + x*4, &rgba, 4);
+        }
+    }
+}
+
+void softrast_set_clip(Softrast *sr, int x0, int y0, int x1, int y1)
+{
+    sr->clip_x0 = clampi(x0, 0, sr->width);
+    sr->clip_y0 = clampi(y0, 0, sr->height);
+    sr->clip_x1 = clampi(x1, sr->clip_x0, sr->width);
+    sr->clip_y1 = clampi(y1, sr->clip_y0, sr->height);
+}
+
+// The edge is evaluated relative to the smaller of its two vertices, so a shared edge of two
+// triangles produces exactly negated values and every pixel center lands in one of them
+static void softrast_setup_edge(Softrast_Triangle *t, int i, V2f p, V2f q, float sign)
+{
+    bool swap = p.x > q.x || (p.x == q.x && p.y > q.y);
+    V2f lo = swap ? q : p;
+    V2f hi = swap ? p : q;
+    if (swap) sign = -sign;
+    float a = -(hi.y - lo.y);
+    float b = hi.x - lo.x;
+    float c = -(a*lo.x + b*lo.y);
+    t->a[i] = a*sign;
+    t->b[i] = b*sign;
+    t->c[i] = c*sign;
+    t->top_left[i] = t->a[i] > 0.0f || (t->a[i] == 0.0f && t->b[i] > 0.0f);
+}
+
+static void softrast_setup_plane(float plane[3], V2f p0, V2f p1, V2f p2, float f0, float f1, float f2, float inv_area)
+{
+    float dfdx = ((f1 - f0)*(p2.y - p0.y) - (f2 - f0)*(p1.y - p0.y))*inv_area;
+    float dfdy = ((f2 - f0)*(p1.x - p0.x) - (f1 - f0)*(p2.x - p0.x))*inv_area;
+    plane[0] = f0 - dfdx*p0.x - dfdy*p0.y;
+    plane[1] = dfdx;
+    plane[2] = dfdy;
+}
+
+static bool softrast_setup_triangle(Softrast *sr, Softrast_Triangle *t, const Vertex *v)
+{
+    V2f p0 = v[0].position;
+    V2f p1 = v[1].position;
+    V2f p2 = v[2].position;
+    float area = (p1.x - p0.x)*(p2.y - p0.y) - (p2.x - p0.x)*(p1.y - p0.y);
+    if (area == 0.0f || isnan(area)) return false;
+
+    // Pixel (x, y) is covered when its center (x + 0.5, y + 0.5) is inside, the clip rectangle
+    // rejects the triangle before it is binned
+    float min_x = fminf(p0.x, fminf(p1.x, p2.x));
+    float min_y = fminf(p0.y, fminf(p1.y, p2.y));
+    float max_x = fmaxf(p0.x, fmaxf(p1.x, p2.x));
+    float max_y = fmaxf(p0.y, fmaxf(p1.y, p2.y));
+    t->x0 = (int) clampf(ceilf(min_x - 0.5f), sr->clip_x0, sr->clip_x1);
+    t->y0 = (int) clampf(ceilf(min_y - 0.5f), sr->clip_y0, sr->clip_y1);
+    t->x1 = (int) clampf(floorf(max_x - 0.5f) + 1.0f, sr->clip_x0, sr->clip_x1);
+    t->y1 = (int) clampf(floorf(max_y - 0.5f) + 1.0f, sr->clip_y0, sr->clip_y1);
+    if (t->x0 >= t->x1 || t->y0 >= t->y1) return false;
+
+    float sign = area > 0.0f ? 1.0f : -1.0f;
+    softrast_setup_edge(t, 0, p0, p1, sign);
+    softrast_setup_edge(t, 1, p1, p2, sign);
+    softrast_setup_edge(t, 2, p2, p0, sign);
+
+    float inv_area = 1.0f/area;
+    softrast_setup_plane(t->planes[0], p0, p1, p2, v[0].color.x, v[1].color.x, v[2].color.x, inv_area);
+    softrast_setup_plane(t->planes[1], p0, p1, p2, v[0].color.y, v[1].color.y, v[2].color.y, inv_area);
+    softrast_setup_plane(t->planes[2], p0, p1, p2, v[0].color.z, v[1].color.z, v[2].color.z, inv_area);
+    softrast_setup_plane(t->planes[3], p0, p1, p2, v[0].color.w, v[1].color.w, v[2].color.w, inv_area);
+    softrast_setup_plane(t->planes[4], p0, p1, p2, v[0].uv.x, v[1].uv.x, v[2].uv.x, inv_area);
+    softrast_setup_plane(t->planes[5], p0, p1, p2, v[0].uv.y, v[1].uv.y, v[2].uv.y, inv_area);
+
+    // Flat attributes come from the provoking vertex, which is the last one in OpenGL
+    t->rect = false;
+    t->mode = v[2].mode;
+    t->material = v[2].material;
+    return true;
+}
+
+// f2unorm8(clampf(x, 0, 1)) with NaN as 0 as well, without the calls of fminf and fmaxf
+static unsigned char softrast_unorm8(float x)
+{
+    if (!(x > 0.0f)) x = 0.0f;
+    if (x > 1.0f) x = 1.0f;
+    return (unsigned char) (x*255.0f + 0.5f);
+}
+
+// clampf(ceilf(x), lo, hi) for the x that is not NaN
+static int softrast_ceil_clamp(float x, int lo, int hi)
+{
+    if (x <= (float) lo) return lo;
+    if (x > (float) hi) return hi;
+    int i = (int) x;
+    return (float) i < x ? i + 1 : i;
+}
+
+// The quad of renderer_rect with a single color: p0 p1 p2 and p1 p2 p3 with the edges
+// parallel to the axes. The two triangles cover the pixel centers inside of the rectangle,
+// including the left and bottom edge and excluding the right and top one like the top-left
+// rule does for them, and the shared diagonal hands every pixel to exactly one of them.
+static bool softrast_setup_rect(Softrast *sr, Softrast_Triangle *t, const Vertex *v)
+{
+    if (v[2].mode != SHADER_COLOR || v[5].mode != SHADER_COLOR || v[2].material != v[5].material) return false;
+    V2f p0 = v[0].position;
+    V2f p1 = v[1].position;
+    V2f p2 = v[2].position;
+    V2f p3 = v[5].position;
+    if (v[3].position.x != p1.x || v[3].position.y != p1.y) return false;
+    if (v[4].position.x != p2.x || v[4].position.y != p2.y) return false;
+    if (p0.y != p1.y || p0.x != p2.x || p3.x != p1.x || p3.y != p2.y) return false;
+    for (int i = 1; i < 6; ++i) {
+        if (v[i].color.x != v[0].color.x || v[i].color.y != v[0].color.y ||
+            v[i].color.z != v[0].color.z || v[i].color.w != v[0].color.w) return false;
+    }
+    if (p0.x == p1.x || p0.y == p2.y || isnan(p0.x + p0.y + p3.x + p3.y)) {
+        return false;
+    }
+
+    float min_x = p0.x < p3.x ? p0.x : p3.x;
+    float min_y = p0.y < p3.y ? p0.y : p3.y;
+    float max_x = p0.x < p3.x ? p3.x : p0.x;
+    float max_y = p0.y < p3.y ? p3.y : p0.y;
+    t->x0 = softrast_ceil_clamp(min_x - 0.5f, sr->clip_x0, sr->clip_x1);
+    t->y0 = softrast_ceil_clamp(min_y - 0.5f, sr->clip_y0, sr->clip_y1);
+    t->x1 = softrast_ceil_clamp(max_x - 0.5f, sr->clip_x0, sr->clip_x1);
+    t->y1 = softrast_ceil_clamp(max_y - 0.5f, sr->clip_y0, sr->clip_y1);
+    t->rect = true;
+    t->mode = v[2].mode;
+    t->material = v[2].material;
+
+    // The color path of softrast_shade_block and softrast_blend, once per rect
+    const Material *m = &sr->materials[t->material];
+    const float color[4] = {v[0].color.x*m->tint.x, v[0].color.y*m->tint.y, v[0].color.z*m->tint.z, v[0].color.w*m->tint.w};
+    for (int i = 0; i < 4; ++i) {
+        t->planes[i][0] = color[i];
+        t->planes[i][1] = 0.0f;
+        t->planes[i][2] = 0.0f;
+    }
+    // Blending with zero alpha keeps every pixel, the rect is skipped like an empty one
+    if (!(color[3] > 0.0f)) t->x1 = t->x0;
+    // dst*(1 - a) vanishes, what is left of the blend is the clamped color
+    t->opaque = color[3] >= 1.0f;
+    unsigned char rgba[4];
+    for (int i = 0; i < 4; ++i) rgba[i] = softrast_unorm8(color[i]);
+    memcpy(&t->pixel, rgba, sizeof(t->pixel));
+    return true;
+}
+
+static float softrast_plane(const float plane[3], float x, float y)
+{
+    return plane[0] + plane[1]*x + plane[2]*y;
+}
+
+// GL_LINEAR with GL_CLAMP_TO_EDGE of the single channel atlas
+static float softrast_sample_atlas(const Free_Glyph_Atlas *atlas, float u, float v)
+{
+    int w = (int) atlas->atlas_width;
+    int h = (int) atlas->atlas_height;
+    float x = u*w - 0.5f;
+    float y = v*h - 0.5f;
+    float fx0 = floorf(x);
+    float fy0 = floorf(y);
+    float tx = x - fx0;
+    float ty = y - fy0;
+    int x0 = (int) clampf(fx0, 0, w - 1);
+    int y0 = (int) clampf(fy0, 0, h - 1);
+    int x1 = (int) clampf(fx0 + 1.0f, 0, w - 1);
+    int y1 = (int) clampf(fy0 + 1.0f, 0, h - 1);
+    const unsigned char *row0 = atlas->pixels + (size_t) y0*w;
+    const unsigned char *row1 = atlas->pixels + (size_t) y1*w;
+    float top    = row0[x0] + (row0[x1] - row0[x0])*tx;
+    float bottom = row1[x0] + (row1[x1] - row1[x0])*tx;
+    return (top + (bottom - top)*ty)*(1.0f/255.0f);
+}
+
+static float softrast_smoothstep(float edge0, float edge1, float x)
+{
+    if (edge1 <= edge0) return x < edge0 ? 0.0f : 1.0f;
+    float t = clampf((x - edge0)/(edge1 - edge0), 0.0f, 1.0f);
+    return t*t*(3.0f - 2.0f*t);
+}
+
+// text.frag, d is the distance sampled at this pixel, dx and dy its fine derivatives
+static V4f softrast_shade_text(const Softrast_Triangle *t, const Material *m, float x, float y, float d, float dx, float dy)
+{
+    float aaf = (fabsf(dx) + fabsf(dy))*(1.0f + m->params.y);
+    float edge = 0.5f + m->params.x;
+    float alpha = softrast_smoothstep(edge - aaf, edge + aaf, d);
+    return v4f(softrast_plane(t->planes[0], x, y)*m->tint.x,
+               softrast_plane(t->planes[1], x, y)*m->tint.y,
+               softrast_plane(t->planes[2], x, y)*m->tint.z,
+               alpha*m->tint.w);
+}
+
+// rainbow.frag
+static V4f softrast_shade_rainbow(const Softrast *sr, const Material *m, float x, float y)
+{
+    float scale = (1.0f + m->params.x)/sr->resolution.y;
+    float xy_x = (2.0f*x - sr->resolution.x)*scale;
+    float xy_y = (2.0f*y - sr->resolution.y)*scale;
+
+    // The nearest cell however far away it is, like rainbow.frag
+    int closest = 0;
+    float length = (xy_x - sr->cells[0].x)*(xy_x - sr->cells[0].x) + (xy_y - sr->cells[0].y)*(xy_y - sr->cells[0].y);
+    for (int i = 1; i < RAINBOW_CELLS_COUNT; ++i) {
+        float dx = xy_x - sr->cells[i].x;
+        float dy = xy_y - sr->cells[i].y;
+        float di = dx*dx + dy*dy;
+        if (di < length) {
+            length = di;
+            closest = i;
+        }
+    }
+
+    float px = sr->cells[closest].x;
+    float py = sr->cells[closest].y;
+    float pz = (float) closest/(float) RAINBOW_CELLS_COUNT*xy_x*xy_y;
+    float shade = 1.0f - fmaxf(0.0f, px*sr->light.x + py + pz*sr->light.y);
+    return v4f((px + shade)*m->tint.x, (py + shade)*m->tint.y, (pz + shade)*m->tint.z, m->tint.w);
+}
+
+// glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA) on a clamped RGBA8 target
+static void softrast_blend(const Softrast *sr, int px, int py, V4f src)
+{
+    float a = clampf(src.w, 0.0f, 1.0f);
+    // Most pixels of the glyph quads are fully transparent
+    if (a == 0.0f) return;
+    unsigned char *dst = sr->pixels + ((size_t) py*sr->width + px)*4;
+    float rgba[4] = {src.x, src.y, src.z, src.w};
+    for (int i = 0; i < 4; ++i) {
+        dst[i] = f2unorm8(clampf(rgba[i], 0.0f, 1.0f)*a + dst[i]*(1.0f/255.0f)*(1.0f - a));
+    }
+}
+
+// Shades the covered pixels of a 4x2 block made of two 2x2 quads. Like on the GPU, every
+// pixel of a touched quad samples the glyph atlas, so fwidth() in the text path is the
+// difference to the neighbour in the same quad row and column (fine derivatives).
+// Index of the lowest set bit, bits is not 0
+static int softrast_lowest_bit(unsigned bits)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctz(bits);
+#elif defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward(&index, bits);
+    return (int) index;
+#else
+    int i = 0;
+    while (!(bits & 1)) {
+        bits >>= 1;
+        i += 1;
+    }
+    return i;
+#endif
+}
+
+static void softrast_shade_block(const Softrast *sr, const Softrast_Triangle *t, int x, int y, const unsigned mask[2])
+{
+    const Material *m = &sr->materials[t->material];
+
+    float d[2][4] = {0};
+    if (t->mode == SHADER_TEXT) {
+        unsigned quads = mask[0] | mask[1];
+        for (int i = 0; i < 4; ++i) {
+            if (((quads >> (i & ~1)) & 3) == 0) continue;
+            for (int r = 0; r < 2; ++r) {
+                float fx = x + i + 0.5f;
+                float fy = y + r + 0.5f;
+                d[r][i] = softrast_sample_atlas(sr->atlas, softrast_plane(t->planes[4], fx, fy), softrast_plane(t->planes[5], fx, fy));
+            }
+        }
+    }
+
+    for (int r = 0; r < 2; ++r) {
+        for (unsigned bits = mask[r]; bits; bits &= bits - 1) {
+            int i = softrast_lowest_bit(bits);
+            float fx = x + i + 0.5f;
+            float fy = y + r + 0.5f;
+            V4f src;
+            switch (t->mode) {
+            case SHADER_TEXT:
+                src = softrast_shade_text(t, m, fx, fy, d[r][i], d[r][i | 1] - d[r][i & ~1], d[1][i] - d[0][i]);
+                break;
+            case SHADER_RAINBOW:
+                src = softrast_shade_rainbow(sr, m, fx, fy);
+                break;
+            default:
+                src = v4f(softrast_plane(t->planes[0], fx, fy)*m->tint.x,
+                          softrast_plane(t->planes[1], fx, fy)*m->tint.y,
+                          softrast_plane(t->planes[2], fx, fy)*m->tint.z,
+                          softrast_plane(t->planes[3], fx, fy)*m->tint.w);
+                break;
+            }
+            softrast_blend(sr, x + i, y + r, src);
+        }
+    }
+}
+
+// Bit i of the result is set when pixel center (x + i, y) is inside of the triangle
+static unsigned softrast_coverage4(const Softrast_Triangle *t, const float row[3], float x)
+{
+#if defined(__SSE2__)
+    __m128 xs = _mm_add_ps(_mm_set1_ps(x), _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f));
+    __m128 zero = _mm_setzero_ps();
+    __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+    for (int e = 0; e < 3; ++e) {
+        __m128 w = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(t->a[e]), xs), _mm_set1_ps(row[e]));
+        __m128 on_edge = _mm_and_ps(_mm_cmpeq_ps(w, zero), _mm_castsi128_ps(_mm_set1_epi32(t->top_left[e] ? -1 : 0)));
+        inside = _mm_and_ps(inside, _mm_or_ps(_mm_cmpgt_ps(w, zero), on_edge));
+    }
+    return (unsigned) _mm_movemask_ps(inside);
+#elif defined(__ARM_NEON)
+    static const float offsets[4] = {0.0f, 1.0f, 2.0f, 3.0f};
+    float32x4_t xs = vaddq_f32(vdupq_n_f32(x), vld1q_f32(offsets));
+    float32x4_t zero = vdupq_n_f32(0.0f);
+    uint32x4_t inside = vdupq_n_u32(~0u);
+    for (int e = 0; e < 3; ++e) {
+        float32x4_t w = vaddq_f32(vmulq_f32(vdupq_n_f32(t->a[e]), xs), vdupq_n_f32(row[e]));
+        uint32x4_t on_edge = vandq_u32(vceqq_f32(w, zero), vdupq_n_u32(t->top_left[e] ? ~0u : 0u));
+        inside = vandq_u32(inside, vorrq_u32(vcgtq_f32(w, zero), on_edge));
+    }
+    return (vgetq_lane_u32(inside, 0) & 1) | (vgetq_lane_u32(inside, 1) & 2) |
+           (vgetq_lane_u32(inside, 2) & 4) | (vgetq_lane_u32(inside, 3) & 8);
+#else
+    unsigned mask = 0;
+    for (int i = 0; i < 4; ++i) {
+        bool inside = true;
+        for (int e = 0; e < 3; ++e) {
+            float w = t->a[e]*(x + (float) i) + row[e];
+            inside = inside && (w > 0.0f || (w == 0.0f && t->top_left[e]));
+        }
+        if (inside) mask |= 1u << i;
+    }
+    return mask;
+#endif
+}
+
+static void softrast_fill_rect(const Softrast *sr, const Softrast_Triangle *t, int x0, int y0, int x1, int y1)
+{
+    if (!t->opaque) {
+        V4f src = v4f(t->planes[0][0], t->planes[1][0], t->planes[2][0], t->planes[3][0]);
+        for (int y = y0; y < y1; ++y) {
+            for (int x = x0; x < x1; ++x) softrast_blend(sr, x, y, src);
+        }
+        return;
+    }
+    // A local copy, t->pixel could alias the rows as far as the compiler knows
+    uint32_t pixel = t->pixel;
+    for (int y = y0; y < y1; ++y) {
+        uint32_t *row = (uint32_t *) (sr->pixels + ((size_t) y*sr->width + x0)*4);
+        for (int x = x0; x < x1; ++x) *row++ = pixel;
+    }
+}
+
+// Walks the triangle in 4x2 blocks aligned to the 2x2 quads, clipped to the given rectangle
+static void softrast_rasterize_triangle(const Softrast *sr, const Softrast_Triangle *t, int x0, int y0, int x1, int y1)
+{
+    if (t->x0 > x0) x0 = t->x0;
+    if (t->y0 > y0) y0 = t->y0;
+    if (t->x1 < x1) x1 = t->x1;
+    if (t->y1 < y1) y1 = t->y1;
+    if (t->rect) {
+        softrast_fill_rect(sr, t, x0, y0, x1, y1);
+        return;
+    }
+
+    for (int y = y0 & ~1; y < y1; y += 2) {
+        float rows[2][3];
+        for (int e = 0; e < 3; ++e) {
+            rows[0][e] = t->b[e]*(y + 0.5f) + t->c[e];
+            rows[1][e] = t->b[e]*(y + 1.5f) + t->c[e];
+        }
+        for (int x = x0 & ~1; x < x1; x += 4) {
+            unsigned columns = 0xF;
+            if (x < x0) columns &= ~((1u << (x0 - x)) - 1);
+            if (x + 4 > x1) columns &= (1u << (x1 - x)) - 1;
+            unsigned mask[2] = {
+                y >= y0    ? softrast_coverage4(t, rows[0], x + 0.5f) & columns : 0,
+                y + 1 < y1 ? softrast_coverage4(t, rows[1], x + 0.5f) & columns : 0,
+            };
+            if (mask[0] | mask[1]) softrast_shade_block(sr, t, x, y, mask);
+        }
+    }
+}
+
+// Triangles of a tile are rasterized in submission order, so blending stays correct
+static void softrast_rasterize_tile(const Softrast *sr, int tile)
+{
+    const Softrast_Bin *bin = &sr->bins[tile];
+    if (bin->count == 0) return;
+    int x0 = (tile % sr->tiles_x)*SOFTRAST_TILE_SIZE;
+    int y0 = (tile / sr->tiles_x)*SOFTRAST_TILE_SIZE;
+    int x1 = x0 + SOFTRAST_TILE_SIZE < sr->width  ? x0 + SOFTRAST_TILE_SIZE : sr->width;
+    int y1 = y0 + SOFTRAST_TILE_SIZE < sr->height ? y0 + SOFTRAST_TILE_SIZE : sr->height;
+    for (size_t i = 0; i < bin->count; ++i) {
+        softrast_rasterize_triangle(sr, &sr->triangles[bin->items[i]], x0, y0, x1, y1);
+    }
+}
+
+static void softrast_rasterize_tiles(Softrast *sr)
+{
+    int tiles_count = sr->tiles_x*sr->tiles_y;
+    for (;;) {
+        int tile = atomic_fetch_add(&sr->next_tile, 1);
+        if (tile >= tiles_count) break;
+        softrast_rasterize_tile(sr, tile);
+    }
+}
+
+static void *softrast_worker(void *arg)
+{
+    Softrast *sr = arg;
+    size_t generation = 0;
+    for (;;) {
+        pthread_mutex_lock(&sr->mutex);
+        while (sr->generation == generation && !sr->quit) {
+            pthread_cond_wait(&sr->work_cond, &sr->mutex);
+        }
+        if (sr->quit) {
+            pthread_mutex_unlock(&sr->mutex);
+            return NULL;
+        }
+        generation = sr->generation;
+        pthread_mutex_unlock(&sr->mutex);
+
+        softrast_rasterize_tiles(sr);
+
+        pthread_mutex_lock(&sr->mutex);
+        sr->workers_busy -= 1;
+        if (sr->workers_busy == 0) pthread_cond_signal(&sr->done_cond);
+        pthread_mutex_unlock(&sr->mutex);
+    }
+}
+
+static void softrast_bin_push(Softrast_Bin *bin, uint32_t triangle)
+{
+    if (bin->count >= bin->capacity) {
+        bin->capacity = bin->capacity == 0 ? 256 : bin->capacity*2;
+        bin->items = realloc(bin->items, sizeof(*bin->items)*bin->capacity);
+        if (bin->items == NULL) {
+            fprintf(stderr, "ERROR: Could not grow software rasterizer bin to %zu triangles\n", bin->capacity);
+            exit(1);
+        }
+    }
+    bin->items[bin->count++] = triangle;
+}
+
+void softrast_draw(Softrast *sr, const Renderer *r)
+{
+    int tiles_count = sr->tiles_x*sr->tiles_y;
+    for (int i = 0; i < tiles_count; ++i) {
+        sr->bins[i].count = 0;
+    }
+
+    // Rects apply the tint of their material during the setup
+    sr->materials = r->materials;
+    sr->triangles_count = 0;
+    for (size_t i = 0; i + 3 <= r->vertices_count;) {
+        Softrast_Triangle *t = &sr->triangles[sr->triangles_count];
+        const Vertex *v = &r->vertices[i];
+        bool visible;
+        if (i + 6 <= r->vertices_count && softrast_setup_rect(sr, t, v)) {
+            visible = t->x0 < t->x1 && t->y0 < t->y1;
+            i += 6;
+        } else {
+            visible = softrast_setup_triangle(sr, t, v);
+            i += 3;
+        }
+        if (!visible) continue;
+        int tx0 = t->x0/SOFTRAST_TILE_SIZE;
+        int ty0 = t->y0/SOFTRAST_TILE_SIZE;
+        int tx1 = (t->x1 - 1)/SOFTRAST_TILE_SIZE;
+        int ty1 = (t->y1 - 1)/SOFTRAST_TILE_SIZE;
+        for (int ty = ty0; ty <= ty1; ++ty) {
+            for (int tx = tx0; tx <= tx1; ++tx) {
+                softrast_bin_push(&sr->bins[ty*sr->tiles_x + tx], (uint32_t) sr->triangles_count);
+            }
+        }
+        sr->triangles_count += 1;
+    }
+    if (sr->triangles_count == 0) return;
+
+    sr->cells = r->rainbow_cells;
+    sr->time = (float) r->time;
+    sr->light = v2f(sinf(sr->time), cosf(sr->time*0.5f));
+    sr->resolution = r->resolution;
+
+    atomic_store(&sr->next_tile, 0);
+    if (sr->threads_count > 0) {
+        pthread_mutex_lock(&sr->mutex);
+        sr->generation += 1;
+        sr->workers_busy = sr->threads_count;
+        pthread_cond_broadcast(&sr->work_cond);
+        pthread_mutex_unlock(&sr->mutex);
+    }
+
+    softrast_rasterize_tiles(sr);
+
+    if (sr->threads_count > 0) {
+        pthread_mutex_lock(&sr->mutex);
+        while (sr->workers_busy > 0) {
+            pthread_cond_wait(&sr->done_cond, &sr->mutex);
+        }
+        pthread_mutex_unlock(&sr->mutex);
+    }
+}
+
+void softrast_read_rgb(const Softrast *sr, unsigned char *pixels)
+{
+    for (int y = 0; y < sr->height; ++y) {
+        const unsigned char *src = sr->pixels + (size_t) (sr->height - 1 - y)*sr->width*4;
+        unsigned char *dst = pixels + (size_t) y*sr->width*3;
+        for (int x = 0; x < sr->width; ++x) {
+            memcpy(dst + x*3, src + x*4, 3);
+        }
+    }
+}
+
+Errno softrast_save_ppm(const Softrast *sr, const char *file_path)
+{
+    Errno result = 0;
+    FILE *f = NULL;
+    size_t size = (size_t) sr->width * sr->height * 3;
+    unsigned char *pixels = malloc(size);
+    if (!pixels) return_defer(ENOMEM);
+
+    softrast_read_rgb(sr, pixels);
+
+    f = fopen(file_path, "wb");
+    if (!f) return_defer(errno);
+    fprintf(f, "P6\n%d %d\n255\n", sr->width, sr->height);
+    if (fwrite(pixels, size, 1, f) != 1) return_defer(errno);
+
+defer:
+    if (f) fclose(f);
+    free(pixels);
+    return result;
+}
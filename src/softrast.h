@@ -0,0 +1,93 @@
+#ifndef SOFTRAST_H_
+#define SOFTRAST_H_
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "common.h"
+#include "renderer.h"
+#include "glyph.h"
+
+// CPU backend of the renderer for machines without a GPU. renderer_flush hands the same
+// Vertex batches it would upload to OpenGL to softrast_draw, which sets up the triangles,
+// bins them into SOFTRAST_TILE_SIZE screen tiles and rasterizes the tiles in parallel.
+// Coverage is tested for 4 pixels at once with SSE2 or NEON (scalar fallback otherwise),
+// shading implements color.frag, text.frag and rainbow.frag natively. Solid axis aligned
+// rects (the two triangles of renderer_rect with the color shader) skip the edge functions
+// and are filled row by row, which covers the same pixels.
+
+#define SOFTRAST_TILE_SIZE 64
+
+typedef struct {
+    // Edge functions a*x + b*y + c, positive inside of the triangle
+    float a[3];
+    float b[3];
+    float c[3];
+    bool top_left[3]; // Pixel centers exactly on the edge belong to this triangle
+    // Plane equations f = p[0] + p[1]*x + p[2]*y of color.rgba and uv.xy
+    float planes[6][3];
+    int x0, y0, x1, y1; // Covered pixels, end exclusive
+    // Every pixel of x0..x1, y0..y1 is covered and the edges are unused. The planes are
+    // constant and hold the color with the tint of the material already applied.
+    bool rect;
+    bool opaque;    // Rect that replaces the pixels with pixel instead of blending
+    uint32_t pixel; // RGBA8 in memory order
+    GLuint mode;
+    GLuint material;
+} Softrast_Triangle;
+
+typedef struct {
+    uint32_t *items; // Indices into Softrast.triangles in submission order
+    size_t count;
+    size_t capacity;
+} Softrast_Bin;
+
+struct Softrast {
+    int width;
+    int height;
+    unsigned char *pixels; // RGBA8, bottom row first like OpenGL
+    // Pixels outside are neither drawn nor cleared (glScissor), the whole framebuffer by default
+    int clip_x0, clip_y0, clip_x1, clip_y1;
+    const Free_Glyph_Atlas *atlas; // Sampled by the text shading path
+
+    int tiles_x;
+    int tiles_y;
+    Softrast_Bin *bins;
+
+    // The batch that is currently rasterized
+    Softrast_Triangle *triangles;
+    size_t triangles_count;
+    const Material *materials;
+    const V2f *cells;
+    float time;
+    V2f light; // sin(time) and cos(time/2) of the rainbow shader, once per batch
+    V2f resolution;
+
+    // Worker threads, the calling thread rasterizes tiles as well
+    pthread_t *threads;
+    size_t threads_count;
+    pthread_mutex_t mutex;
+    pthread_cond_t work_cond;
+    pthread_cond_t done_cond;
+    size_t generation;
+    size_t workers_busy;
+    bool quit;
+    atomic_int next_tile;
+};
+
+// threads is the total amount of rasterizing threads, 0 uses one per online CPU
+bool softrast_init(Softrast *sr, int width, int height, size_t threads);
+void softrast_destroy(Softrast *sr);
+void softrast_clear(Softrast *sr, V4f color);
+// Clamped to the framebuffer, end exclusive
+void softrast_set_clip(Softrast *sr, int x0, int y0, int x1, int y1);
+// Rasterizes the pending vertices of r, returns once the whole batch is in sr->pixels
+void softrast_draw(Softrast *sr, const Renderer *r);
+// Same layout as framebuffer_read_rgb: top-down RGB rows, width*height*3 bytes
+void softrast_read_rgb(const Softrast *sr, unsigned char *pixels);
+Errno softrast_save_ppm(const Softrast *sr, const char *file_path);
+
+#endif  // SOFTRAST_H_
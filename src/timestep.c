@@ -0,0 +1,41 @@
+#include <assert.h>
+#include <math.h>
+
+#include "timestep.h"
+
+void timestep_init(Timestep *ts, double hz)
+{
+    assert(hz > 0.0);
+    *ts = (Timestep) {
+        .step = 1.0/hz,
+    };
+}
+
+size_t timestep_advance(Timestep *ts, double now)
+{
+    if (!ts->started) {
+        ts->started = true;
+        ts->last_time = now;
+        return 0;
+    }
+    double elapsed = now - ts->last_time;
+    ts->last_time = now;
+    if (elapsed > 0.0) ts->accumulator += elapsed;
+
+    size_t steps = 0;
+    while (ts->accumulator >= ts->step && steps < TIMESTEP_MAX_STEPS) {
+        ts->accumulator -= ts->step;
+        steps += 1;
+    }
+    if (ts->accumulator >= ts->step) {
+        ts->dropped += (size_t) (ts->accumulator/ts->step);
+        ts->accumulator = fmod(ts->accumulator, ts->step);
+    }
+    ts->steps += steps;
+    return steps;
+}
+
+float timestep_alpha(const Timestep *ts)
+{
+    return (float) (ts->accumulator/ts->step);
+}
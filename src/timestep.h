@@ -0,0 +1,33 @@
+#ifndef TIMESTEP_H_
+#define TIMESTEP_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+
+// Fixed timestep accumulator. The simulation advances in steps of exactly 1/hz seconds no
+// matter how often frames are rendered, and the frame interpolates between the last two
+// steps with timestep_alpha(). The steps only depend on the frame times passed in, so a
+// replay or the virtual clock of the headless renderer simulates exactly the same states.
+
+#define TIMESTEP_DEFAULT_HZ 60.0
+// A longer stall (breakpoint, window drag) drops the remaining time instead of trying to
+// catch up with more and more steps per frame
+#define TIMESTEP_MAX_STEPS 8
+
+typedef struct {
+    double step;        // Seconds per simulation step
+    double accumulator; // Time not simulated yet, less than step after timestep_advance
+    double last_time;
+    bool started;
+    size_t steps;       // Steps taken so far
+    size_t dropped;     // Steps skipped because of TIMESTEP_MAX_STEPS
+} Timestep;
+
+void timestep_init(Timestep *ts, double hz);
+// Adds the time since the previous call and returns the amount of steps to simulate. The
+// first call only starts the clock.
+size_t timestep_advance(Timestep *ts, double now);
+// Position of the frame between the last step and the next one, in [0, 1)
+float timestep_alpha(const Timestep *ts);
+
+#endif  // TIMESTEP_H_
@@ -0,0 +1,185 @@
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+
+#include "renderer.h"
+#include "trace.h"
+
+atomic_bool trace_enabled = false;
+
+#ifdef TRACE_DISABLE
+
+bool trace_init(const char *json_file_path, const char *csv_file_path)
+{
+    (void) json_file_path;
+    (void) csv_file_path;
+    fprintf(stderr, "ERROR: tracing was compiled out with TRACE_DISABLE\n");
+    return false;
+}
+
+void trace_shutdown(void) {}
+void trace_event(const char *name, char phase) { (void) name; (void) phase; }
+void trace_flush(void) {}
+void trace_frame(const Renderer_Stats *stats) { (void) stats; }
+
+#else
+
+#include <stdatomic.h>
+#include <time.h>
+
+// Single producer (the owning thread), single consumer (trace_flush) ring buffer
+typedef struct {
+    Trace_Event events[TRACE_BUFFER_CAP];
+    atomic_size_t head;
+    atomic_size_t tail;
+    atomic_size_t dropped;
+} Trace_Buffer;
+
+static Trace_Buffer trace_buffers[TRACE_THREADS_CAP];
+static atomic_size_t trace_buffers_count = 0;
+static _Thread_local Trace_Buffer *trace_thread_buffer = NULL;
+static _Thread_local bool trace_thread_registered = false;
+
+static FILE *trace_json = NULL;
+static FILE *trace_csv = NULL;
+static bool trace_json_first = true;
+static uint64_t trace_start_ns = 0;
+static uint64_t trace_last_frame_ns = 0;
+static size_t trace_frames = 0;
+
+static uint64_t trace_now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000ull + (uint64_t) ts.tv_nsec;
+}
+
+bool trace_init(const char *json_file_path, const char *csv_file_path)
+{
+    if (json_file_path) {
+        trace_json = fopen(json_file_path, "w");
+        if (!trace_json) {
+            fprintf(stderr, "ERROR: Could not open %s\n", json_file_path);
+            return false;
+        }
+        fprintf(trace_json, "{\"displayTimeUnit\": \"ns\", \"traceEvents\": [\n");
+    }
+
+    if (csv_file_path) {
+        trace_csv = fopen(csv_file_path, "w");
+        if (!trace_csv) {
+            fprintf(stderr, "ERROR: Could not open %s\n", csv_file_path);
+            if (trace_json) {
+                // No event was written yet, the file is left as an empty but valid trace
+                fprintf(trace_json, "]}\n");
+                fclose(trace_json);
+                trace_json = NULL;
+            }
+            return false;
+        }
+        fprintf(trace_csv, "frame,frame_time_ms");
+        for (Renderer_Stat s = 0; s < COUNT_RENDERER_STATS; ++s) {
+            fprintf(trace_csv, ",%s", renderer_stat_name(s));
+        }
+        fprintf(trace_csv, "\n");
+    }
+
+    trace_start_ns = trace_now_ns();
+    trace_last_frame_ns = trace_start_ns;
+    // Only the JSON file drains the events, the CSV rows come from trace_frame
+    // Released after the files are set up, the threads that see it enabled see them too
+    atomic_store_explicit(&trace_enabled, trace_json != NULL, memory_order_release);
+    return true;
+}
+
+void trace_shutdown(void)
+{
+    if (atomic_exchange(&trace_enabled, false)) trace_flush();
+
+    if (trace_json) {
+        fprintf(trace_json, "\n]}\n");
+        fclose(trace_json);
+        trace_json = NULL;
+    }
+    if (trace_csv) {
+        fclose(trace_csv);
+        trace_csv = NULL;
+    }
+
+    size_t count = atomic_load(&trace_buffers_count);
+    if (count > TRACE_THREADS_CAP) count = TRACE_THREADS_CAP;
+    for (size_t i = 0; i < count; ++i) {
+        size_t dropped = atomic_load(&trace_buffers[i].dropped);
+        if (dropped > 0) {
+            fprintf(stderr, "WARNING: trace: thread %zu dropped %zu events, flush more often\n", i, dropped);
+        }
+    }
+}
+
+static Trace_Buffer *trace_get_thread_buffer(void)
+{
+    if (!trace_thread_registered) {
+        trace_thread_registered = true;
+        size_t index = atomic_fetch_add(&trace_buffers_count, 1);
+        if (index < TRACE_THREADS_CAP) trace_thread_buffer = &trace_buffers[index];
+    }
+    return trace_thread_buffer;
+}
+
+void trace_event(const char *name, char phase)
+{
+    Trace_Buffer *buffer = trace_get_thread_buffer();
+    if (!buffer) return;
+
+    size_t head = atomic_load_explicit(&buffer->head, memory_order_relaxed);
+    size_t tail = atomic_load_explicit(&buffer->tail, memory_order_acquire);
+    if (head - tail >= TRACE_BUFFER_CAP) {
+        atomic_fetch_add_explicit(&buffer->dropped, 1, memory_order_relaxed);
+        return;
+    }
+
+    Trace_Event *event = &buffer->events[head & (TRACE_BUFFER_CAP - 1)];
+    event->name = name;
+    event->timestamp_ns = trace_now_ns();
+    event->phase = phase;
+    atomic_store_explicit(&buffer->head, head + 1, memory_order_release);
+}
+
+void trace_flush(void)
+{
+    if (!trace_json) return;
+
+    size_t count = atomic_load(&trace_buffers_count);
+    if (count > TRACE_THREADS_CAP) count = TRACE_THREADS_CAP;
+    for (size_t tid = 0; tid < count; ++tid) {
+        Trace_Buffer *buffer = &trace_buffers[tid];
+        size_t tail = atomic_load_explicit(&buffer->tail, memory_order_relaxed);
+        size_t head = atomic_load_explicit(&buffer->head, memory_order_acquire);
+        for (; tail != head; ++tail) {
+            const Trace_Event *event = &buffer->events[tail & (TRACE_BUFFER_CAP - 1)];
+            uint64_t ns = event->timestamp_ns - trace_start_ns;
+            fprintf(trace_json, "%s{\"name\": \"%s\", \"ph\": \"%c\", \"ts\": %llu.%03llu, \"pid\": 1, \"tid\": %zu}",
+                    trace_json_first ? "" : ",\n",
+                    event->name, event->phase,
+                    (unsigned long long) (ns / 1000), (unsigned long long) (ns % 1000),
+                    tid);
+            trace_json_first = false;
+        }
+        atomic_store_explicit(&buffer->tail, tail, memory_order_release);
+    }
+}
+
+void trace_frame(const Renderer_Stats *stats)
+{
+    uint64_t now = trace_now_ns();
+    if (trace_csv) {
+        fprintf(trace_csv, "%zu,%.6f", trace_frames, (double) (now - trace_last_frame_ns) * 1e-6);
+        for (Renderer_Stat s = 0; s < COUNT_RENDERER_STATS; ++s) {
+            fprintf(trace_csv, ",%zu", stats->values[s]);
+        }
+        fprintf(trace_csv, "\n");
+    }
+    trace_frames += 1;
+    trace_last_frame_ns = now;
+}
+
+#endif // TRACE_DISABLE
@@ -0,0 +1,53 @@
+#ifndef TRACE_H_
+#define TRACE_H_
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// See renderer.h
+typedef struct Renderer_Stats Renderer_Stats;
+
+// Low overhead event recorder for offline profiling. Every thread writes begin/end events
+// with nanosecond timestamps into its own lock-free ring buffer. trace_flush() drains them
+// into a Chrome trace_event JSON file (open it in Perfetto or chrome://tracing), and
+// trace_frame() appends one row of frame statistics to a CSV file.
+//
+// Building with TRACE_DISABLE compiles the recorder out entirely.
+
+#define TRACE_BUFFER_CAP  4096 // Events per thread between two flushes, has to be a power of two
+#define TRACE_THREADS_CAP 16
+
+typedef struct {
+    const char *name; // Has to outlive the recorder, e.g. a string literal
+    uint64_t timestamp_ns;
+    char phase;       // 'B'egin or 'E'nd
+} Trace_Event;
+
+// Set by trace_init and trace_shutdown, read by every thread that records events
+extern atomic_bool trace_enabled;
+
+#ifdef TRACE_DISABLE
+
+#define TRACE_BEGIN(name) ((void) 0)
+#define TRACE_END(name)   ((void) 0)
+
+#else
+
+#define TRACE_BEGIN(name) do { if (atomic_load_explicit(&trace_enabled, memory_order_acquire)) trace_event(name, 'B'); } while (0)
+#define TRACE_END(name)   do { if (atomic_load_explicit(&trace_enabled, memory_order_acquire)) trace_event(name, 'E'); } while (0)
+
+#endif // TRACE_DISABLE
+
+// Either path may be NULL. Fails when the recorder was compiled out.
+bool trace_init(const char *json_file_path, const char *csv_file_path);
+void trace_shutdown(void);
+void trace_event(const char *name, char phase);
+// Has to be called from one thread at a time, usually once per frame by the main thread
+void trace_flush(void);
+// Writes one CSV row with the renderer stats of a finished frame (Renderer.last_frame), the
+// frame time is measured between two calls
+void trace_frame(const Renderer_Stats *stats);
+
+#endif  // TRACE_H_